@@ -50,9 +50,21 @@ typedef struct
 } GPS_OUTPUT_T;
 
 
+  /*  Handle for one open GPS file.  Any number of these may be open at once.  */
+
+  typedef struct CHARTS_GPS CHARTS_GPS_T;
+
+
   FILE *open_gps_file (char *path);
   int32_t gps_read_record (FILE *fp, GPS_OUTPUT_T *gps);
   void gps_dump_record (GPS_OUTPUT_T gps);
+  CHARTS_GPS_T *charts_gps_open (char *path);
+  void charts_gps_close (CHARTS_GPS_T *nav);
+  FILE *charts_gps_fp (CHARTS_GPS_T *nav);
+  CHARTS_IO_STATS_T *charts_gps_stats (CHARTS_GPS_T *nav);
+  int64_t charts_gps_get_start_timestamp (CHARTS_GPS_T *nav);
+  int64_t charts_gps_get_end_timestamp (CHARTS_GPS_T *nav);
+  int32_t charts_gps_read_record (CHARTS_GPS_T *nav, GPS_OUTPUT_T *gps);
 
 
 #ifdef  __cplusplus
@@ -48,6 +48,11 @@ extern "C" {
 #define    HOF_NEXT_RECORD           (-1)
 
 
+/*  Records per write for the buffered appender (charts_hof_append).  */
+
+#define    CHARTS_HOF_APPEND_BLOCK   1024
+
+
 /*  DEFINES FOR BITS IN STATUS BYTE IN OUTPUTS (below)...  */
 
 #define    AU_STATUS_DELETED_BIT   0x01        /* B0  */
@@ -388,12 +393,119 @@ typedef struct
 }  HYDRO_OUTPUT_T;                        /* Whole output file definition... */
 
 
+/*  Field mask bits for charts_hof_load_columns.  */
+
+#define    HOF_COLUMN_TIMESTAMP              0x00000001
+#define    HOF_COLUMN_LATITUDE               0x00000002
+#define    HOF_COLUMN_LONGITUDE              0x00000004
+#define    HOF_COLUMN_SEC_LATITUDE           0x00000008
+#define    HOF_COLUMN_SEC_LONGITUDE          0x00000010
+#define    HOF_COLUMN_CORRECT_DEPTH          0x00000020
+#define    HOF_COLUMN_CORRECT_SEC_DEPTH      0x00000040
+#define    HOF_COLUMN_ABDC                   0x00000080
+#define    HOF_COLUMN_SEC_ABDC               0x00000100
+#define    HOF_COLUMN_STATUS                 0x00000200
+#define    HOF_COLUMN_SUSPECT_STATUS         0x00000400
+#define    HOF_COLUMN_CLASSIFICATION_STATUS  0x00000800
+#define    HOF_COLUMN_DATA_TYPE              0x00001000
+#define    HOF_COLUMN_NADIR_ANGLE            0x00002000
+#define    HOF_COLUMN_SCANNER_AZIMUTH        0x00004000
+#define    HOF_COLUMN_ALTITUDE               0x00008000
+
+
+/*  Structure of arrays version of a range of HOF records.  Only the arrays selected in "mask" are allocated, the
+    rest are NULL.  Values are in native byte order.  */
+
+typedef struct
+{
+  uint32_t       mask;
+  int32_t        count;
+
+  int64_t        *timestamp;
+  double         *latitude;
+  double         *longitude;
+  double         *sec_latitude;
+  double         *sec_longitude;
+  float          *correct_depth;
+  float          *correct_sec_depth;
+  int16_t        *abdc;
+  int16_t        *sec_abdc;
+  char           *status;
+  char           *suspect_status;
+  uint8_t        *classification_status;
+  char           *data_type;
+  float          *nadir_angle;
+  float          *scanner_azimuth;
+  float          *altitude;
+} HOF_COLUMNS_T;
+
+
+/*  Handle for one open HOF file.  Unlike the FILE based calls, any number of these may be open at once (one per
+    thread, for instance).  */
+
+typedef struct CHARTS_HOF CHARTS_HOF_T;
+
+
+/*  Memory mapped, read-only access to the records of a HOF file (see hof_io.c).  A file of the other endianness is
+    swapped in full by charts_hof_map_open, so after that nothing writes to the map and any number of threads may
+    call charts_hof_map_span, charts_hof_map_record, and charts_hof_load_columns on the same map at once.  Just don't
+    close it while they're at it.  */
+
+typedef struct CHARTS_HOF_MAP CHARTS_HOF_MAP_T;
+
+
+/*  Buffered writer for rewriting or extending a HOF file (see charts_hof_append_open in hof_io.c).  */
+
+typedef struct CHARTS_HOF_APPEND CHARTS_HOF_APPEND_T;
+
+
+/*  In place editor for the status fields of a HOF file (see charts_hof_edit_open in hof_io.c).  */
+
+typedef struct CHARTS_EDIT CHARTS_HOF_EDIT_T;
+
+
+/*  Keys and layout of the ASCII header (see charts_header_read and charts_header_write in charts_header.c).  */
+
+extern CHARTS_HEADER_TABLE_T charts_hof_header_table;
+
+
 FILE *open_hof_file (char *path);
 int32_t hof_read_header (FILE *fp, HOF_HEADER_T *head);
 int32_t hof_read_record (FILE *fp, int32_t num, HYDRO_OUTPUT_T *record);
+int32_t hof_read_records (FILE *fp, int32_t first, int32_t count, HYDRO_OUTPUT_T *buffer);
 int32_t hof_write_header (FILE *fp, HOF_HEADER_T head);
 int32_t hof_write_record (FILE *fp, int32_t num, HYDRO_OUTPUT_T *record);
+CHARTS_HOF_T *charts_hof_open (char *path);
+void charts_hof_close (CHARTS_HOF_T *hof);
+FILE *charts_hof_fp (CHARTS_HOF_T *hof);
+HOF_HEADER_T *charts_hof_header (CHARTS_HOF_T *hof);
+int32_t charts_hof_num_records (CHARTS_HOF_T *hof);
+CHARTS_IO_STATS_T *charts_hof_stats (CHARTS_HOF_T *hof);
+int32_t charts_hof_read_record (CHARTS_HOF_T *hof, int32_t num, HYDRO_OUTPUT_T *record);
+int32_t charts_hof_read_records (CHARTS_HOF_T *hof, int32_t first, int32_t count, HYDRO_OUTPUT_T *buffer);
+int32_t charts_hof_write_header (CHARTS_HOF_T *hof, HOF_HEADER_T *head);
+int32_t charts_hof_write_record (CHARTS_HOF_T *hof, int32_t num, HYDRO_OUTPUT_T *record);
+CHARTS_HOF_APPEND_T *charts_hof_append_open (CHARTS_HOF_T *hof, int32_t first);
+int32_t charts_hof_append (CHARTS_HOF_APPEND_T *app, const HYDRO_OUTPUT_T *records, int32_t count);
+int32_t charts_hof_append_flush (CHARTS_HOF_APPEND_T *app);
+int32_t charts_hof_append_close (CHARTS_HOF_APPEND_T *app);
+CHARTS_HOF_EDIT_T *charts_hof_edit_open (char *path);
+int32_t charts_hof_edit_num_records (CHARTS_HOF_EDIT_T *edit);
+int32_t charts_hof_edit_get (CHARTS_HOF_EDIT_T *edit, int32_t num, char *status, char *suspect_status, uint8_t *classification_status);
+int32_t charts_hof_edit_set (CHARTS_HOF_EDIT_T *edit, int32_t num, uint32_t mask, char status, char suspect_status, uint8_t classification_status);
+int32_t charts_hof_edit_flush (CHARTS_HOF_EDIT_T *edit);
+int32_t charts_hof_edit_close (CHARTS_HOF_EDIT_T *edit);
+CHARTS_HOF_MAP_T *charts_hof_map_open (char *path);
+void charts_hof_map_close (CHARTS_HOF_MAP_T *map);
+HOF_HEADER_T *charts_hof_map_header (CHARTS_HOF_MAP_T *map);
+int32_t charts_hof_map_num_records (CHARTS_HOF_MAP_T *map);
+const HYDRO_OUTPUT_T *charts_hof_map_span (CHARTS_HOF_MAP_T *map, int32_t first, int32_t count);
+const HYDRO_OUTPUT_T *charts_hof_map_record (CHARTS_HOF_MAP_T *map, int32_t num);
+int32_t charts_hof_load_columns (CHARTS_HOF_MAP_T *map, uint32_t mask, int32_t first, int32_t count, HOF_COLUMNS_T *columns);
+void charts_hof_free_columns (HOF_COLUMNS_T *columns);
+void charts_swap_hof_records (HYDRO_OUTPUT_T *records, size_t count);
 void hof_get_uncertainty (HYDRO_OUTPUT_T *record, float *h_error, float *v_error, float in_depth, int32_t abdc);
+void hof_get_uncertainty_array (const float *nadir_angle, const float *altitude, const float *depth, const int16_t *abdc, const char *data_type, int32_t count, float *h_error, float *v_error);
 void hof_dump_record (HYDRO_OUTPUT_T *record);
 
 
@@ -122,13 +122,37 @@ typedef struct
 } IMAGE_HEADER_T;
 
 
+  /*  Handle for one open IMG file and its index.  Unlike the FILE based calls, any number of these may be open
+      at once.  */
+
+  typedef struct CHARTS_IMAGE CHARTS_IMAGE_T;
+
+
+  /*  Keys and layout of the ASCII header (see charts_header_read and charts_header_write in charts_header.c).  */
+
+  extern CHARTS_HEADER_TABLE_T charts_image_header_table;
+
+
   int32_t image_read_header (FILE *fp, IMAGE_HEADER_T *head);
   FILE *open_image_file (char *path);
   int32_t image_get_metadata (FILE *fp, int32_t rec_num, IMAGE_INDEX_T *image_index);
   int32_t image_find_record (FILE *fp, int64_t timestamp);
+  int32_t image_find_records (FILE *fp, int64_t *timestamps, int32_t count, int32_t *recnums);
   uint8_t *image_read_record (FILE *fp, int64_t timestamp, uint32_t *size, int64_t *image_time);
   uint8_t *image_read_record_recnum (FILE *fp, int32_t recnum, uint32_t *size, int64_t *image_time);
   int64_t dump_image (char *file, int64_t timestamp, char *path);
+  CHARTS_IMAGE_T *charts_image_open (char *path);
+  void charts_image_close (CHARTS_IMAGE_T *image);
+  FILE *charts_image_fp (CHARTS_IMAGE_T *image);
+  IMAGE_HEADER_T *charts_image_header (CHARTS_IMAGE_T *image);
+  CHARTS_IO_STATS_T *charts_image_stats (CHARTS_IMAGE_T *image);
+  int32_t charts_image_get_metadata (CHARTS_IMAGE_T *image, int32_t rec_num, IMAGE_INDEX_T *image_index);
+  int32_t charts_image_find_record (CHARTS_IMAGE_T *image, int64_t timestamp);
+  int32_t charts_image_find_records (CHARTS_IMAGE_T *image, int64_t *timestamps, int32_t count, int32_t *recnums);
+  uint8_t *charts_image_read_record (CHARTS_IMAGE_T *image, int64_t timestamp, uint32_t *size, int64_t *image_time);
+  uint8_t *charts_image_read_record_recnum (CHARTS_IMAGE_T *image, int32_t recnum, uint32_t *size, int64_t *image_time);
+  int32_t charts_image_map (CHARTS_IMAGE_T *image);
+  const uint8_t *charts_image_map_record (CHARTS_IMAGE_T *image, int32_t recnum, uint32_t *size, int64_t *image_time);
 
 
 #ifdef  __cplusplus
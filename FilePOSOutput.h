@@ -65,15 +65,73 @@ typedef struct
   */
 
 
+  /*  Handle for one open POS/SBET file.  It carries its own endianness, GPS week base, midnight flag and record
+      range so any number of these may be open at once.  */
+
+  typedef struct CHARTS_POS CHARTS_POS_T;
+
+
+  /*  Default number of records between samples in the charts_pos_use_index time index.  33 SBET records are a
+      little over one 4K page.  */
+
+#define CHARTS_POS_INDEX_STRIDE  32
+
+
+  /*  Number of records charts_pos_interp_batch reads at a time.  */
+
+#define CHARTS_POS_BATCH         4096
+
+
+  /*  Field mask bits for charts_pos_set_interp.  */
+
+#define POS_FIELD_LATITUDE          0x0001
+#define POS_FIELD_LONGITUDE         0x0002
+#define POS_FIELD_ALTITUDE          0x0004
+#define POS_FIELD_X_VELOCITY        0x0008
+#define POS_FIELD_Y_VELOCITY        0x0010
+#define POS_FIELD_Z_VELOCITY        0x0020
+#define POS_FIELD_ROLL              0x0040
+#define POS_FIELD_PITCH             0x0080
+#define POS_FIELD_PLATFORM_HEADING  0x0100
+#define POS_FIELD_WANDER_ANGLE      0x0200
+#define POS_FIELD_X_BODY_ACCEL      0x0400
+#define POS_FIELD_Y_BODY_ACCEL      0x0800
+#define POS_FIELD_Z_BODY_ACCEL      0x1000
+#define POS_FIELD_X_BODY_ANG_RATE   0x2000
+#define POS_FIELD_Y_BODY_ANG_RATE   0x4000
+#define POS_FIELD_Z_BODY_ANG_RATE   0x8000
+
+#define POS_FIELD_POSITION          (POS_FIELD_LATITUDE | POS_FIELD_LONGITUDE | POS_FIELD_ALTITUDE)
+#define POS_FIELD_ATTITUDE          (POS_FIELD_ROLL | POS_FIELD_PITCH | POS_FIELD_PLATFORM_HEADING | POS_FIELD_WANDER_ANGLE)
+#define POS_FIELD_ALL               0xffff
+
+
   uint8_t get_pos_file (char *hof_tof_file, char *pos_file);
   FILE *open_pos_file (char *path);
   int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp);
+  int32_t pos_use_index (FILE *fp, int32_t stride);
+  int32_t pos_set_interp (FILE *fp, int32_t mode, uint32_t mask);
+  int32_t pos_interp_batch (FILE *fp, const int64_t *timestamps, size_t n, POS_OUTPUT_T *out);
   int64_t pos_get_start_timestamp ();
   int64_t pos_get_end_timestamp ();
   int64_t pos_get_timestamp (POS_OUTPUT_T pos);
   int32_t pos_read_record (FILE *fp, POS_OUTPUT_T *pos);
   int32_t pos_read_record_num (FILE *fp, POS_OUTPUT_T *pos, int32_t recnum);
   void pos_dump_record (POS_OUTPUT_T pos);
+  CHARTS_POS_T *charts_pos_open (char *path);
+  void charts_pos_close (CHARTS_POS_T *nav);
+  FILE *charts_pos_fp (CHARTS_POS_T *nav);
+  CHARTS_IO_STATS_T *charts_pos_stats (CHARTS_POS_T *nav);
+  int64_t charts_pos_find_record (CHARTS_POS_T *nav, POS_OUTPUT_T *pos, int64_t timestamp);
+  int32_t charts_pos_use_index (CHARTS_POS_T *nav, int32_t stride);
+  int32_t charts_pos_set_interp (CHARTS_POS_T *nav, int32_t mode, uint32_t mask);
+  int32_t charts_pos_interp_batch (CHARTS_POS_T *nav, const int64_t *timestamps, size_t n, POS_OUTPUT_T *out);
+  int64_t charts_pos_get_start_timestamp (CHARTS_POS_T *nav);
+  int64_t charts_pos_get_end_timestamp (CHARTS_POS_T *nav);
+  int64_t charts_pos_get_timestamp (CHARTS_POS_T *nav, POS_OUTPUT_T pos);
+  int32_t charts_pos_read_record (CHARTS_POS_T *nav, POS_OUTPUT_T *pos);
+  int32_t charts_pos_read_record_num (CHARTS_POS_T *nav, POS_OUTPUT_T *pos, int32_t recnum);
+  void charts_swap_pos_records (POS_OUTPUT_T *records, size_t count);
 
 
 #ifdef  __cplusplus
@@ -45,14 +45,49 @@ typedef struct
 } RMS_OUTPUT_T;
 
 
+  /*  Handle for one open RMS (smrmsg) file.  It carries its own endianness, GPS week base, midnight flag and
+      record range so any number of these may be open at once.  */
+
+  typedef struct CHARTS_RMS CHARTS_RMS_T;
+
+
+  /*  Field mask bits for charts_rms_set_interp.  */
+
+#define RMS_FIELD_NORTH_POS         0x0001
+#define RMS_FIELD_SOUTH_POS         0x0002
+#define RMS_FIELD_DOWN_POS          0x0004
+#define RMS_FIELD_NORTH_VEL         0x0008
+#define RMS_FIELD_SOUTH_VEL         0x0010
+#define RMS_FIELD_DOWN_VEL          0x0020
+#define RMS_FIELD_ROLL              0x0040
+#define RMS_FIELD_PITCH             0x0080
+#define RMS_FIELD_HEADING           0x0100
+
+#define RMS_FIELD_POSITION          (RMS_FIELD_NORTH_POS | RMS_FIELD_SOUTH_POS | RMS_FIELD_DOWN_POS)
+#define RMS_FIELD_ATTITUDE          (RMS_FIELD_ROLL | RMS_FIELD_PITCH | RMS_FIELD_HEADING)
+#define RMS_FIELD_ALL               0x01ff
+
+
   uint8_t get_rms_file (char *hof_tof_file, char *rms_file);
   FILE *open_rms_file (char *path);
+  int32_t rms_set_interp (FILE *fp, int32_t mode, uint32_t mask);
   int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp);
   int64_t rms_get_start_timestamp ();
   int64_t rms_get_end_timestamp ();
   int32_t rms_read_record (FILE *fp, RMS_OUTPUT_T *rms);
   int32_t rms_read_record_num (FILE *fp, RMS_OUTPUT_T *rms, int32_t recnum);
   void rms_dump_record (RMS_OUTPUT_T rms);
+  CHARTS_RMS_T *charts_rms_open (char *path);
+  void charts_rms_close (CHARTS_RMS_T *nav);
+  FILE *charts_rms_fp (CHARTS_RMS_T *nav);
+  CHARTS_IO_STATS_T *charts_rms_stats (CHARTS_RMS_T *nav);
+  int32_t charts_rms_set_interp (CHARTS_RMS_T *nav, int32_t mode, uint32_t mask);
+  int64_t charts_rms_find_record (CHARTS_RMS_T *nav, RMS_OUTPUT_T *rms, int64_t timestamp);
+  int64_t charts_rms_get_start_timestamp (CHARTS_RMS_T *nav);
+  int64_t charts_rms_get_end_timestamp (CHARTS_RMS_T *nav);
+  int32_t charts_rms_read_record (CHARTS_RMS_T *nav, RMS_OUTPUT_T *rms);
+  int32_t charts_rms_read_record_num (CHARTS_RMS_T *nav, RMS_OUTPUT_T *rms, int32_t recnum);
+  void charts_swap_rms_records (RMS_OUTPUT_T *records, size_t count);
 
 
 #ifdef  __cplusplus
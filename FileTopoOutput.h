@@ -69,6 +69,11 @@ Binary             8k -Binary - date, start timestamp, stop timestamp, planning
 #define  TOF_NEXT_RECORD               (-1)
 
 
+/*  Records per write for the buffered appender (charts_tof_append).  */
+
+#define  CHARTS_TOF_APPEND_BLOCK       1024
+
+
 typedef struct
 {
   int64_t        start_time;       /* time in microseconds from 01/01/1970 */
@@ -239,11 +244,54 @@ typedef struct
 } TOPO_OUTPUT_T;
 
 
+  /*  Handle for one open TOF file.  Unlike the FILE based calls, any number of these may be open at once (one
+      per thread, for instance).  */
+
+  typedef struct CHARTS_TOF CHARTS_TOF_T;
+
+
+  /*  Buffered writer for rewriting or extending a TOF file (see charts_tof_append_open in tof_io.c).  */
+
+  typedef struct CHARTS_TOF_APPEND CHARTS_TOF_APPEND_T;
+
+
+  /*  In place editor for the classification_status field of a TOF file (see charts_tof_edit_open in tof_io.c).  */
+
+  typedef struct CHARTS_EDIT CHARTS_TOF_EDIT_T;
+
+
+  /*  Keys and layout of the ASCII header (see charts_header_read and charts_header_write in charts_header.c).  */
+
+  extern CHARTS_HEADER_TABLE_T charts_tof_header_table;
+
+
   FILE *open_tof_file (char *path);
   int32_t tof_read_header (FILE *fp, TOF_HEADER_T *head);
   int32_t tof_read_record (FILE *fp, int32_t num, TOPO_OUTPUT_T *record);
+  int32_t tof_read_records (FILE *fp, int32_t first, int32_t count, TOPO_OUTPUT_T *buffer);
   int32_t tof_write_header (FILE *fp, TOF_HEADER_T head);
   int32_t tof_write_record (FILE *fp, int32_t num, TOPO_OUTPUT_T *record);
+  CHARTS_TOF_T *charts_tof_open (char *path);
+  void charts_tof_close (CHARTS_TOF_T *tof);
+  FILE *charts_tof_fp (CHARTS_TOF_T *tof);
+  TOF_HEADER_T *charts_tof_header (CHARTS_TOF_T *tof);
+  int32_t charts_tof_num_records (CHARTS_TOF_T *tof);
+  CHARTS_IO_STATS_T *charts_tof_stats (CHARTS_TOF_T *tof);
+  int32_t charts_tof_read_record (CHARTS_TOF_T *tof, int32_t num, TOPO_OUTPUT_T *record);
+  int32_t charts_tof_read_records (CHARTS_TOF_T *tof, int32_t first, int32_t count, TOPO_OUTPUT_T *buffer);
+  int32_t charts_tof_write_header (CHARTS_TOF_T *tof, TOF_HEADER_T *head);
+  int32_t charts_tof_write_record (CHARTS_TOF_T *tof, int32_t num, TOPO_OUTPUT_T *record);
+  CHARTS_TOF_APPEND_T *charts_tof_append_open (CHARTS_TOF_T *tof, int32_t first);
+  int32_t charts_tof_append (CHARTS_TOF_APPEND_T *app, const TOPO_OUTPUT_T *records, int32_t count);
+  int32_t charts_tof_append_flush (CHARTS_TOF_APPEND_T *app);
+  int32_t charts_tof_append_close (CHARTS_TOF_APPEND_T *app);
+  CHARTS_TOF_EDIT_T *charts_tof_edit_open (char *path);
+  int32_t charts_tof_edit_num_records (CHARTS_TOF_EDIT_T *edit);
+  int32_t charts_tof_edit_get (CHARTS_TOF_EDIT_T *edit, int32_t num, uint8_t *classification_status);
+  int32_t charts_tof_edit_set (CHARTS_TOF_EDIT_T *edit, int32_t num, uint8_t classification_status);
+  int32_t charts_tof_edit_flush (CHARTS_TOF_EDIT_T *edit);
+  int32_t charts_tof_edit_close (CHARTS_TOF_EDIT_T *edit);
+  void charts_swap_tof_records (TOPO_OUTPUT_T *records, size_t count);
   void tof_dump_record (TOPO_OUTPUT_T *record);
 
 
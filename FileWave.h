@@ -23,6 +23,11 @@ extern "C" {
 #define    WAVE_NEXT_RECORD           (-1)
 
 
+/*  Number of records charts_wave_view reads at a time.  */
+
+#define    CHARTS_WAVE_BLOCK          256
+
+
 typedef struct
 {
   char           file_type[128];
@@ -80,10 +85,29 @@ typedef struct
 } WAVE_DATA_T;
 
 
+  /*  Handle for one open INH file.  The handle owns the waveform buffers that charts_wave_read_record fills.  */
+
+  typedef struct CHARTS_WAVE CHARTS_WAVE_T;
+
+
+  /*  Keys and layout of the ASCII header (see charts_header_read and charts_header_write in charts_header.c).  */
+
+  extern CHARTS_HEADER_TABLE_T charts_wave_header_table;
+
+
   int32_t wave_read_header (FILE *fp, WAVE_HEADER_T *head);
   FILE *open_wave_file (char *path);
   int32_t wave_read_record (FILE *fp, int32_t num, WAVE_DATA_T *record);
   void wave_dump_record (WAVE_DATA_T record);
+  CHARTS_WAVE_T *charts_wave_open (char *path);
+  void charts_wave_close (CHARTS_WAVE_T *wave);
+  FILE *charts_wave_fp (CHARTS_WAVE_T *wave);
+  WAVE_HEADER_T *charts_wave_header (CHARTS_WAVE_T *wave);
+  CHARTS_IO_STATS_T *charts_wave_stats (CHARTS_WAVE_T *wave);
+  int32_t charts_wave_read_record (CHARTS_WAVE_T *wave, int32_t num, WAVE_DATA_T *record);
+  int32_t charts_wave_view (CHARTS_WAVE_T *wave, int32_t num, WAVE_DATA_T *view);
+  int32_t charts_wave_read_block (CHARTS_WAVE_T *wave, int32_t first, int32_t count, WAVE_DATA_T *views);
+  void charts_wave_dump_record (CHARTS_WAVE_T *wave, WAVE_DATA_T record);
 
 
 #ifdef  __cplusplus
@@ -0,0 +1,660 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include <getopt.h>
+#include <sys/time.h>
+
+#include "FileHydroOutput.h"
+#include "FileTopoOutput.h"
+#include "FileWave.h"
+#include "FileImage.h"
+#include "FilePOSOutput.h"
+#include "FileRMSOutput.h"
+#include "FileGPSOutput.h"
+
+/*  benchmark_charts_files
+
+    Times the open, sequential read, random read, find record, and write paths of each of the readers against the
+    files written by generate_charts_files.  Each result is written to stdout as one JSON object per line:
+
+      {"file": "line_le.hof", "reader": "hof", "op": "seq_read", "count": 100000, "bytes": 22400000,
+       "seconds": 0.051234, "per_second": 1951828.9, "mb_per_second": 417.0}
+
+    "count" is the number of opens, records, or lookups.  Run it twice to get warm cache numbers.  With -S the
+    I/O counters of the handle used for the reads are written (see charts_io_stats_json) before it is closed.  */
+
+
+#define BLOCK           4096
+
+
+static int32_t l_repeat = 20;
+static int32_t l_random = 20000;
+static char    *l_dir;
+static volatile double l_sink;      /*  Keeps the compiler from throwing away reads we don't look at.  */
+
+
+static double now ()
+{
+  struct timeval   tv;
+
+
+  gettimeofday (&tv, NULL);
+
+  return ((double) tv.tv_sec + (double) tv.tv_usec / 1000000.0);
+}
+
+
+static void report (char *file, char *reader, char *op, int64_t count, int64_t bytes, double seconds)
+{
+  if (seconds <= 0.0) seconds = 1.0e-9;
+
+  printf ("{\"file\": \"%s\", \"reader\": \"%s\", \"op\": \"%s\", \"count\": %"PRId64", \"bytes\": %"PRId64", "
+          "\"seconds\": %.6f, \"per_second\": %.1f, \"mb_per_second\": %.1f}\n", file, reader, op, count, bytes,
+          seconds, (double) count / seconds, (double) bytes / seconds / 1048576.0);
+
+  fflush (stdout);
+}
+
+
+static void stats (char *file, CHARTS_IO_STATS_T *io)
+{
+  if (charts_io_stats_on)
+    {
+      charts_io_stats_json (stdout, file, io);
+      fflush (stdout);
+    }
+}
+
+
+static char *path_of (char *name)
+{
+  static char      path[1024];
+
+
+  sprintf (path, "%s/%s", l_dir, name);
+
+  return (path);
+}
+
+
+/*  Deterministic record numbers for the random reads, "first" through "first" + "count" - 1.  */
+
+static int32_t *random_nums (int32_t first, int32_t count)
+{
+  int32_t          *nums, i;
+  uint32_t         seed = 12345;
+
+
+  nums = (int32_t *) malloc (l_random * sizeof (int32_t));
+
+  for (i = 0 ; i < l_random ; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      nums[i] = first + (int32_t) ((seed >> 8) % (uint32_t) count);
+    }
+
+  return (nums);
+}
+
+
+/*  Copies the header block of "src" to a scratch file for the write tests.  */
+
+static char *scratch (char *src, int32_t head_size)
+{
+  static char      path[1024];
+  FILE             *in, *out;
+  uint8_t          *head;
+
+
+  sprintf (path, "%s/bench_scratch%s", l_dir, strrchr (src, '.'));
+
+  head = (uint8_t *) calloc (1, head_size);
+
+  if ((in = fopen64 (src, "rb")) == NULL || (out = fopen64 (path, "wb")) == NULL)
+    {
+      perror (path);
+      exit (-1);
+    }
+
+  fread (head, head_size, 1, in);
+  fwrite (head, head_size, 1, out);
+
+  fclose (in);
+  fclose (out);
+  free (head);
+
+  return (path);
+}
+
+
+static void bench_hof (char *name)
+{
+  CHARTS_HOF_T         *hof;
+  CHARTS_HOF_MAP_T     *map;
+  CHARTS_HOF_APPEND_T  *app;
+  HYDRO_OUTPUT_T       *records, record;
+  const HYDRO_OUTPUT_T *span;
+  char                 *path, *out;
+  int32_t              i, n, count, *nums;
+  double               start;
+
+
+  path = path_of (name);
+
+  start = now ();
+  for (i = 0 ; i < l_repeat ; i++)
+    {
+      if ((hof = charts_hof_open (path)) == NULL) return;
+      charts_hof_close (hof);
+    }
+  report (name, "hof", "open", l_repeat, 0, now () - start);
+
+
+  hof = charts_hof_open (path);
+  count = charts_hof_num_records (hof);
+  records = (HYDRO_OUTPUT_T *) malloc ((size_t) count * sizeof (HYDRO_OUTPUT_T));
+
+  start = now ();
+  for (i = 1 ; i <= count ; i += n)
+    {
+      n = count - i + 1 < BLOCK ? count - i + 1 : BLOCK;
+      charts_hof_read_records (hof, i, n, &records[i - 1]);
+    }
+  report (name, "hof", "seq_read", count, (int64_t) count * sizeof (HYDRO_OUTPUT_T), now () - start);
+
+
+  nums = random_nums (1, count);
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++)
+    {
+      charts_hof_read_record (hof, nums[i], &record);
+      l_sink += record.latitude;
+    }
+  report (name, "hof", "random_read", l_random, (int64_t) l_random * sizeof (HYDRO_OUTPUT_T), now () - start);
+
+  stats (name, charts_hof_stats (hof));
+
+  charts_hof_close (hof);
+
+
+  start = now ();
+  if ((map = charts_hof_map_open (path)) != NULL)
+    {
+      for (i = 1 ; i <= count ; i += n)
+        {
+          n = count - i + 1 < BLOCK ? count - i + 1 : BLOCK;
+          span = charts_hof_map_span (map, i, n);
+          l_sink += span[n - 1].latitude;
+        }
+      charts_hof_map_close (map);
+      report (name, "hof", "map_seq_read", count, (int64_t) count * sizeof (HYDRO_OUTPUT_T), now () - start);
+    }
+
+
+  /*  One record per call, then the same thing through the appender.  */
+
+  out = scratch (path, HOF_HEAD_SIZE);
+
+  hof = charts_hof_open (out);
+  start = now ();
+  for (i = 0 ; i < count ; i++) charts_hof_write_record (hof, HOF_NEXT_RECORD, &records[i]);
+  charts_hof_close (hof);
+  report (name, "hof", "write", count, (int64_t) count * sizeof (HYDRO_OUTPUT_T), now () - start);
+
+  out = scratch (path, HOF_HEAD_SIZE);
+
+  hof = charts_hof_open (out);
+  start = now ();
+  app = charts_hof_append_open (hof, 1);
+  charts_hof_append (app, records, count);
+  charts_hof_append_close (app);
+  charts_hof_close (hof);
+  report (name, "hof", "append", count, (int64_t) count * sizeof (HYDRO_OUTPUT_T), now () - start);
+
+  remove (out);
+
+  free (nums);
+  free (records);
+}
+
+
+static void bench_tof (char *name)
+{
+  CHARTS_TOF_T         *tof;
+  CHARTS_TOF_APPEND_T  *app;
+  TOPO_OUTPUT_T        *records, record;
+  char                 *path, *out;
+  int32_t              i, n, count, *nums;
+  double               start;
+
+
+  path = path_of (name);
+
+  start = now ();
+  for (i = 0 ; i < l_repeat ; i++)
+    {
+      if ((tof = charts_tof_open (path)) == NULL) return;
+      charts_tof_close (tof);
+    }
+  report (name, "tof", "open", l_repeat, 0, now () - start);
+
+
+  tof = charts_tof_open (path);
+  count = charts_tof_num_records (tof);
+  records = (TOPO_OUTPUT_T *) malloc ((size_t) count * sizeof (TOPO_OUTPUT_T));
+
+  start = now ();
+  for (i = 1 ; i <= count ; i += n)
+    {
+      n = count - i + 1 < BLOCK ? count - i + 1 : BLOCK;
+      charts_tof_read_records (tof, i, n, &records[i - 1]);
+    }
+  report (name, "tof", "seq_read", count, (int64_t) count * sizeof (TOPO_OUTPUT_T), now () - start);
+
+
+  nums = random_nums (1, count);
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++)
+    {
+      charts_tof_read_record (tof, nums[i], &record);
+      l_sink += record.latitude_last;
+    }
+  report (name, "tof", "random_read", l_random, (int64_t) l_random * sizeof (TOPO_OUTPUT_T), now () - start);
+
+  stats (name, charts_tof_stats (tof));
+
+  charts_tof_close (tof);
+
+
+  out = scratch (path, TOF_HEAD_SIZE);
+
+  tof = charts_tof_open (out);
+  start = now ();
+  for (i = 0 ; i < count ; i++) charts_tof_write_record (tof, TOF_NEXT_RECORD, &records[i]);
+  charts_tof_close (tof);
+  report (name, "tof", "write", count, (int64_t) count * sizeof (TOPO_OUTPUT_T), now () - start);
+
+  out = scratch (path, TOF_HEAD_SIZE);
+
+  tof = charts_tof_open (out);
+  start = now ();
+  app = charts_tof_append_open (tof, 1);
+  charts_tof_append (app, records, count);
+  charts_tof_append_close (app);
+  charts_tof_close (tof);
+  report (name, "tof", "append", count, (int64_t) count * sizeof (TOPO_OUTPUT_T), now () - start);
+
+  remove (out);
+
+  free (nums);
+  free (records);
+}
+
+
+static void bench_wave (char *name)
+{
+  CHARTS_WAVE_T        *wave;
+  WAVE_DATA_T          record;
+  char                 *path;
+  int32_t              i, count, size, *nums;
+  double               start;
+
+
+  path = path_of (name);
+
+  start = now ();
+  for (i = 0 ; i < l_repeat ; i++)
+    {
+      if ((wave = charts_wave_open (path)) == NULL) return;
+      charts_wave_close (wave);
+    }
+  report (name, "inh", "open", l_repeat, 0, now () - start);
+
+
+  wave = charts_wave_open (path);
+  count = charts_wave_header (wave)->number_shots;
+  size = charts_wave_header (wave)->record_size;
+
+  start = now ();
+  for (i = 1 ; i <= count ; i++)
+    {
+      if (!charts_wave_view (wave, i, &record)) break;
+      l_sink += record.pmt[0];
+    }
+  report (name, "inh", "seq_read", count, (int64_t) count * size, now () - start);
+
+
+  nums = random_nums (1, count);
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++)
+    {
+      charts_wave_read_record (wave, nums[i], &record);
+      l_sink += record.pmt[0];
+    }
+  report (name, "inh", "random_read", l_random, (int64_t) l_random * size, now () - start);
+
+  stats (name, charts_wave_stats (wave));
+
+  charts_wave_close (wave);
+
+  free (nums);
+}
+
+
+static void bench_image (char *name)
+{
+  CHARTS_IMAGE_T       *image;
+  IMAGE_INDEX_T        first, last;
+  uint8_t              *data;
+  const uint8_t        *view;
+  char                 *path;
+  uint32_t             size;
+  int32_t              i, count, *nums;
+  int64_t              bytes, image_time, range;
+  double               start;
+
+
+  path = path_of (name);
+
+  start = now ();
+  for (i = 0 ; i < l_repeat ; i++)
+    {
+      if ((image = charts_image_open (path)) == NULL) return;
+      charts_image_close (image);
+    }
+  report (name, "img", "open", l_repeat, 0, now () - start);
+
+
+  image = charts_image_open (path);
+  count = charts_image_header (image)->text.number_images;
+
+  start = now ();
+  for (i = 1, bytes = 0 ; i <= count ; i++)
+    {
+      if ((data = charts_image_read_record_recnum (image, i, &size, &image_time)) == NULL) continue;
+      l_sink += data[size - 1];
+      bytes += size;
+      free (data);
+    }
+  report (name, "img", "seq_read", count, bytes, now () - start);
+
+  start = now ();
+  for (i = 1, bytes = 0 ; i <= count ; i++)
+    {
+      if ((view = charts_image_map_record (image, i, &size, &image_time)) == NULL) continue;
+      l_sink += view[size - 1];
+      bytes += size;
+    }
+  report (name, "img", "map_seq_read", count, bytes, now () - start);
+
+
+  nums = random_nums (1, count);
+
+  start = now ();
+  for (i = 0, bytes = 0 ; i < l_random ; i++)
+    {
+      if ((data = charts_image_read_record_recnum (image, nums[i], &size, &image_time)) == NULL) continue;
+      l_sink += data[size - 1];
+      bytes += size;
+      free (data);
+    }
+  report (name, "img", "random_read", l_random, bytes, now () - start);
+
+
+  charts_image_get_metadata (image, 1, &first);
+  charts_image_get_metadata (image, count, &last);
+  range = last.timestamp - first.timestamp + 1;
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++) l_sink += charts_image_find_record (image, first.timestamp + (int64_t) nums[i] * range / count);
+  report (name, "img", "find_record", l_random, 0, now () - start);
+
+  stats (name, charts_image_stats (image));
+
+  charts_image_close (image);
+
+  free (nums);
+}
+
+
+static void bench_pos (char *name)
+{
+  CHARTS_POS_T         *nav;
+  POS_OUTPUT_T         pos, *out;
+  int64_t              *times, first, range;
+  char                 *path;
+  int32_t              i, count, *nums;
+  double               start;
+
+
+  path = path_of (name);
+
+  start = now ();
+  for (i = 0 ; i < l_repeat ; i++)
+    {
+      if ((nav = charts_pos_open (path)) == NULL) return;
+      charts_pos_close (nav);
+    }
+  report (name, "pos", "open", l_repeat, 0, now () - start);
+
+
+  nav = charts_pos_open (path);
+
+  start = now ();
+  for (count = 0 ; !charts_pos_read_record (nav, &pos) ; count++) l_sink += pos.latitude;
+  report (name, "pos", "seq_read", count, (int64_t) count * sizeof (POS_OUTPUT_T), now () - start);
+
+
+  nums = random_nums (0, count);
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++)
+    {
+      charts_pos_read_record_num (nav, &pos, nums[i]);
+      l_sink += pos.latitude;
+    }
+  report (name, "pos", "random_read", l_random, (int64_t) l_random * sizeof (POS_OUTPUT_T), now () - start);
+
+
+  /*  Lookups spread over the whole file, in random order and then sorted for the batch interpolator.  */
+
+  first = charts_pos_get_start_timestamp (nav);
+  range = charts_pos_get_end_timestamp (nav) - first;
+
+  times = (int64_t *) malloc (l_random * sizeof (int64_t));
+  out = (POS_OUTPUT_T *) malloc (l_random * sizeof (POS_OUTPUT_T));
+
+  for (i = 0 ; i < l_random ; i++) times[i] = first + (int64_t) nums[i] * range / count;
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++)
+    {
+      charts_pos_find_record (nav, &pos, times[i]);
+      l_sink += pos.latitude;
+    }
+  report (name, "pos", "find_record", l_random, 0, now () - start);
+
+  for (i = 0 ; i < l_random ; i++) times[i] = first + (int64_t) i * range / l_random;
+
+  start = now ();
+  charts_pos_interp_batch (nav, times, l_random, out);
+  report (name, "pos", "interp_batch", l_random, 0, now () - start);
+
+  stats (name, charts_pos_stats (nav));
+
+  charts_pos_close (nav);
+
+  free (times);
+  free (out);
+  free (nums);
+}
+
+
+static void bench_rms (char *name)
+{
+  CHARTS_RMS_T         *nav;
+  RMS_OUTPUT_T         rms;
+  int64_t              first, range;
+  char                 *path;
+  int32_t              i, count, *nums;
+  double               start;
+
+
+  path = path_of (name);
+
+  start = now ();
+  for (i = 0 ; i < l_repeat ; i++)
+    {
+      if ((nav = charts_rms_open (path)) == NULL) return;
+      charts_rms_close (nav);
+    }
+  report (name, "rms", "open", l_repeat, 0, now () - start);
+
+
+  nav = charts_rms_open (path);
+
+  start = now ();
+  for (count = 0 ; !charts_rms_read_record (nav, &rms) ; count++) l_sink += rms.roll_rms;
+  report (name, "rms", "seq_read", count, (int64_t) count * sizeof (RMS_OUTPUT_T), now () - start);
+
+
+  nums = random_nums (0, count);
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++)
+    {
+      charts_rms_read_record_num (nav, &rms, nums[i]);
+      l_sink += rms.roll_rms;
+    }
+  report (name, "rms", "random_read", l_random, (int64_t) l_random * sizeof (RMS_OUTPUT_T), now () - start);
+
+
+  first = charts_rms_get_start_timestamp (nav);
+  range = charts_rms_get_end_timestamp (nav) - first;
+
+  start = now ();
+  for (i = 0 ; i < l_random ; i++)
+    {
+      charts_rms_find_record (nav, &rms, first + (int64_t) nums[i] * range / count);
+      l_sink += rms.roll_rms;
+    }
+  report (name, "rms", "find_record", l_random, 0, now () - start);
+
+  stats (name, charts_rms_stats (nav));
+
+  charts_rms_close (nav);
+
+  free (nums);
+}
+
+
+static void bench_gps (char *name)
+{
+  CHARTS_GPS_T         *nav;
+  GPS_OUTPUT_T         gps;
+  char                 *path;
+  int32_t              i, count;
+  double               start;
+
+
+  path = path_of (name);
+
+  start = now ();
+  for (i = 0 ; i < l_repeat ; i++)
+    {
+      if ((nav = charts_gps_open (path)) == NULL) return;
+      charts_gps_close (nav);
+    }
+  report (name, "gps", "open", l_repeat, 0, now () - start);
+
+
+  nav = charts_gps_open (path);
+
+  start = now ();
+  for (count = 0 ; !charts_gps_read_record (nav, &gps) ; count++) l_sink += gps.gps_time;
+  report (name, "gps", "seq_read", count, (int64_t) count * sizeof (GPS_OUTPUT_T), now () - start);
+
+  stats (name, charts_gps_stats (nav));
+
+  charts_gps_close (nav);
+}
+
+
+static void usage ()
+{
+  fprintf (stderr, "\n\nUsage: benchmark_charts_files [-r OPENS] [-k LOOKUPS] [-S] DIRECTORY\n\n");
+  fprintf (stderr, "  DIRECTORY holds the output of generate_charts_files\n");
+  fprintf (stderr, "  -r  Number of times to open each file (default 20)\n");
+  fprintf (stderr, "  -k  Number of random reads and lookups per file (default 20000)\n");
+  fprintf (stderr, "  -S  Dump the I/O counters of each reader\n\n");
+  exit (-1);
+}
+
+
+int32_t main (int32_t argc, char *argv[])
+{
+  int32_t             c;
+
+
+  while ((c = getopt (argc, argv, "r:k:S")) != -1)
+    {
+      switch (c)
+        {
+        case 'r':
+          l_repeat = atoi (optarg);
+          break;
+
+        case 'k':
+          l_random = atoi (optarg);
+          break;
+
+        case 'S':
+          charts_io_stats_enable (1);
+          break;
+
+        default:
+          usage ();
+        }
+    }
+
+  if (optind >= argc || l_repeat < 1 || l_random < 1) usage ();
+
+  l_dir = argv[optind];
+
+
+  bench_hof ("line_le.hof");
+  bench_hof ("line_be.hof");
+  bench_tof ("line_le.tof");
+  bench_tof ("line_be.tof");
+  bench_wave ("line.inh");
+  bench_image ("line_le.img");
+  bench_image ("line_be.img");
+  bench_pos ("sbet_260103_0001.out");
+  bench_rms ("smrmsg_260103_0001.out");
+  bench_gps ("gps_260103_0001.out");
+
+  return (0);
+}
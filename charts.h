@@ -36,6 +36,7 @@ extern "C" {
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <time.h>
 #include <string.h>
@@ -56,14 +57,137 @@ extern "C" {
 #undef CHARTS_DEBUG
 
 
+/*  A run of "count" contiguous "size" byte (2, 4 or 8) fields starting "offset" bytes into a record.  Tables of these
+    describe which parts of a record charts_swap_records has to swap.  */
+
+typedef struct
+{
+  uint16_t      offset;
+  uint16_t      size;
+  uint16_t      count;
+} CHARTS_SWAP_RUN_T;
+
+
+/*  One "Key: value" entry of an ASCII file header.  "offset" is where the value lives in the header structure
+    and, for CHARTS_HEADER_STRING, "size" is the size of the char array.  A table of these (CHARTS_HEADER_TABLE_T)
+    drives both reading (charts_header_read) and writing (charts_header_write) the header text.  */
+
+#define CHARTS_HEADER_STRING     0
+#define CHARTS_HEADER_INT8       1
+#define CHARTS_HEADER_INT16      2
+#define CHARTS_HEADER_INT32      3
+#define CHARTS_HEADER_INT64      4
+#define CHARTS_HEADER_FLOAT      5
+#define CHARTS_HEADER_DOUBLE     6
+#define CHARTS_HEADER_ENDIAN     7        /*  uint8_t, 1 for "Little", 0 for "Big"  */
+
+#define CHARTS_HEADER_MAX_SLOTS  256
+
+#define CHARTS_HEADER_FIELD(key, type, st, member) {key, type, offsetof (st, member), sizeof (((st *) 0)->member)}
+
+typedef struct
+{
+  const char    *key;
+  uint8_t       type;
+  uint32_t      offset;
+  uint32_t      size;
+} CHARTS_HEADER_FIELD_T;
+
+
+/*  "slots" is a collision free hash of the keys, built the first time the table is used.  */
+
+typedef struct
+{
+  const CHARTS_HEADER_FIELD_T *fields;
+  int32_t       num_fields;
+  volatile int32_t ready;
+  uint32_t      seed;
+  uint32_t      mask;
+  int16_t       slots[CHARTS_HEADER_MAX_SLOTS];
+} CHARTS_HEADER_TABLE_T;
+
+#define CHARTS_HEADER_TABLE(fields) {fields, sizeof (fields) / sizeof (CHARTS_HEADER_FIELD_T), 0, 0, 0, {0}}
+
+
+/*  Interpolation modes for charts_pos_set_interp and charts_rms_set_interp.  */
+
+#define CHARTS_INTERP_LINEAR       0
+#define CHARTS_INTERP_HERMITE      1
+
+#define CHARTS_INTERP_MAX_FIELDS   16
+
+
+/*  Cubic coefficients, in s = (t - t1) / h, for one segment (the stretch between two records) of a record made of
+    doubles with the time first (POS_OUTPUT_T, RMS_OUTPUT_T).  Only the fields being interpolated are kept, packed
+    into the first "count" slots.  The other slots are zero so charts_interp_eval can always do all
+    CHARTS_INTERP_MAX_FIELDS of them in one fixed length loop that the compiler turns into SIMD code.  */
+
+typedef struct
+{
+  double        t1;
+  double        h;
+  int32_t       count;
+  int32_t       field[CHARTS_INTERP_MAX_FIELDS];     /*  Index in the record (the time is 0).  */
+  uint8_t       wrap[CHARTS_INTERP_MAX_FIELDS];      /*  How to put an angle back in range, 0 if not.  */
+  double        a[CHARTS_INTERP_MAX_FIELDS];
+  double        b[CHARTS_INTERP_MAX_FIELDS];
+  double        c[CHARTS_INTERP_MAX_FIELDS];
+  double        d[CHARTS_INTERP_MAX_FIELDS];
+} CHARTS_INTERP_SEGMENT_T;
+
+
+/*  I/O counters kept by each reader handle (see charts_hof_stats and friends).  Nothing is counted until
+    charts_io_stats_enable is called.  The time spent opening a file (header parsing, index loading, probing the
+    first and last records) goes in header_seconds.  Record I/O goes through charts_io_seek, charts_io_read, and
+    charts_io_write which add to the counts and io_seconds.  "swaps" is the number of records byte swapped.  */
+
+typedef struct
+{
+  int64_t       seeks;
+  int64_t       reads;
+  int64_t       writes;
+  int64_t       bytes_read;
+  int64_t       bytes_written;
+  int64_t       swaps;
+  int64_t       cache_hits;
+  int64_t       cache_misses;
+  double        header_seconds;
+  double        io_seconds;
+} CHARTS_IO_STATS_T;
+
+extern int32_t charts_io_stats_on;
+
+#define CHARTS_IO_COUNT(stats, field, n)  do {if (charts_io_stats_on) (stats)->field += (n);} while (0)
+
+
   void charts_cvtime (int64_t micro_sec, int32_t *year, int32_t *jday, int32_t *hour, int32_t *minute, float *second);
+  void charts_cvtime_batch (const int64_t *micro_sec, int32_t count, int32_t *year, int32_t *jday, int32_t *hour, int32_t *minute, float *second);
+  int64_t charts_utc_time (int32_t year, int32_t month, int32_t mday);
   void charts_jday2mday (int32_t year, int32_t jday, int32_t *mon, int32_t *mday);
   void charts_swap_int32_t (int32_t *word);
   void charts_swap_float (float *word);
   void charts_swap_double (double *word);
   void charts_swap_int64_t (int64_t *word);
   void charts_swap_int16_t (int16_t *word);
+  void charts_swap_array_16 (void *data, size_t count);
+  void charts_swap_array_32 (void *data, size_t count);
+  void charts_swap_array_64 (void *data, size_t count);
+  void charts_swap_records (void *records, size_t count, size_t size, const CHARTS_SWAP_RUN_T *runs, int32_t num_runs);
   void lidar_get_string (char *in, char *out);
+  const CHARTS_HEADER_FIELD_T *charts_header_lookup (CHARTS_HEADER_TABLE_T *table, const char *key, int32_t length);
+  const CHARTS_HEADER_FIELD_T *charts_header_parse_line (CHARTS_HEADER_TABLE_T *table, char *line, void *base);
+  int32_t charts_header_read (FILE *fp, CHARTS_HEADER_TABLE_T *table, void *base, int32_t *header_size);
+  void charts_header_write (FILE *fp, CHARTS_HEADER_TABLE_T *table, void *base);
+  int32_t charts_header_patch (char *block, int32_t size, const char *key, const char *value);
+  void charts_io_stats_enable (int32_t on);
+  double charts_io_stats_clock ();
+  int32_t charts_io_seek (CHARTS_IO_STATS_T *stats, FILE *fp, int64_t offset, int32_t whence);
+  size_t charts_io_read (CHARTS_IO_STATS_T *stats, void *ptr, size_t size, size_t count, FILE *fp);
+  size_t charts_io_write (CHARTS_IO_STATS_T *stats, const void *ptr, size_t size, size_t count, FILE *fp);
+  void charts_io_stats_json (FILE *fp, const char *name, const CHARTS_IO_STATS_T *stats);
+  void charts_interp_linear (const double *prev, const double *next, double t, uint32_t mask, uint32_t angles, int32_t num_fields, double *out);
+  void charts_interp_segment (CHARTS_INTERP_SEGMENT_T *seg, const double *before, const double *prev, const double *next, const double *after, uint32_t mask, uint32_t angles, int32_t num_fields);
+  void charts_interp_eval (const CHARTS_INTERP_SEGMENT_T *seg, double t, double *out);
 
 
 #ifdef  __cplusplus
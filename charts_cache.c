@@ -0,0 +1,464 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include <pthread.h>
+
+#include "charts_cache.h"
+
+
+/*  Each entry is a single allocation with the image bytes following the (padded) entry so charts_cache_release
+    can get back to the entry from the data pointer.  "image" is set to NULL when the owning handle is dropped
+    while the entry is still referenced so it can never be matched again.  */
+
+typedef struct CACHE_ENTRY
+{
+  CHARTS_IMAGE_T       *image;
+  int32_t              recnum;
+  uint32_t             size;
+  int64_t              image_time;
+  int32_t              refs;
+  struct CACHE_ENTRY   *prev;           /*  LRU list, most recently used first.  */
+  struct CACHE_ENTRY   *next;
+  struct CACHE_ENTRY   *chain;          /*  Hash bucket chain.  */
+} CACHE_ENTRY_T;
+
+#define CACHE_HEAD    ((sizeof (CACHE_ENTRY_T) + 15) & ~((size_t) 15))
+#define CACHE_DATA(e) ((uint8_t *) (e) + CACHE_HEAD)
+
+
+struct CHARTS_CACHE
+{
+  int64_t          max_bytes;
+  int64_t          bytes;
+  int32_t          read_ahead;
+  int32_t          count;
+  CACHE_ENTRY_T    **buckets;
+  uint32_t         mask;
+  CACHE_ENTRY_T    *head;
+  CACHE_ENTRY_T    *tail;
+  CHARTS_IMAGE_T   *last_image;         /*  Last request, used to tell which way we're moving.  */
+  int32_t          last_recnum;
+  int64_t          hits;
+  int64_t          misses;
+  pthread_mutex_t  mutex;
+};
+
+
+static uint32_t cache_hash (CHARTS_CACHE_T *cache, CHARTS_IMAGE_T *image, int32_t recnum)
+{
+  uint32_t         h;
+
+
+  h = (uint32_t) ((uintptr_t) image >> 4) * 0x9e3779b1u;
+  h ^= (uint32_t) recnum * 0x85ebca6bu;
+  h ^= h >> 15;
+
+  return (h & cache->mask);
+}
+
+
+static CACHE_ENTRY_T *cache_lookup (CHARTS_CACHE_T *cache, CHARTS_IMAGE_T *image, int32_t recnum)
+{
+  CACHE_ENTRY_T    *e;
+
+
+  for (e = cache->buckets[cache_hash (cache, image, recnum)] ; e ; e = e->chain)
+    {
+      if (e->image == image && e->recnum == recnum) return (e);
+    }
+
+  return (NULL);
+}
+
+
+static void cache_unlink (CHARTS_CACHE_T *cache, CACHE_ENTRY_T *e)
+{
+  if (e->prev) e->prev->next = e->next;
+  else cache->head = e->next;
+
+  if (e->next) e->next->prev = e->prev;
+  else cache->tail = e->prev;
+}
+
+
+static void cache_push_front (CHARTS_CACHE_T *cache, CACHE_ENTRY_T *e)
+{
+  e->prev = NULL;
+  e->next = cache->head;
+
+  if (cache->head) cache->head->prev = e;
+  else cache->tail = e;
+
+  cache->head = e;
+}
+
+
+/*  Takes "e" out of the hash and LRU list and frees it.  Orphaned entries (image == NULL) aren't in the hash.  */
+
+static void cache_remove (CHARTS_CACHE_T *cache, CACHE_ENTRY_T *e)
+{
+  CACHE_ENTRY_T    **p;
+
+
+  if (e->image != NULL)
+    {
+      for (p = &cache->buckets[cache_hash (cache, e->image, e->recnum)] ; *p != e ; p = &(*p)->chain);
+      *p = e->chain;
+    }
+
+  cache_unlink (cache, e);
+
+  cache->bytes -= e->size;
+  cache->count--;
+
+  free (e);
+}
+
+
+/*  Throws out unreferenced entries from the cold end until we're back under budget.  Referenced entries stay
+    put so the cache can run over budget while callers are holding on to more than it allows.  */
+
+static void cache_evict (CHARTS_CACHE_T *cache)
+{
+  CACHE_ENTRY_T    *e, *prev;
+
+
+  for (e = cache->tail ; e && cache->bytes > cache->max_bytes ; e = prev)
+    {
+      prev = e->prev;
+
+      if (!e->refs) cache_remove (cache, e);
+    }
+}
+
+
+static void cache_grow (CHARTS_CACHE_T *cache)
+{
+  CACHE_ENTRY_T    **buckets, **old, *e, *chain;
+  uint32_t         old_size, i, h;
+
+
+  old_size = cache->mask + 1;
+
+  if ((buckets = (CACHE_ENTRY_T **) calloc (old_size * 2, sizeof (CACHE_ENTRY_T *))) == NULL) return;
+
+  old = cache->buckets;
+  cache->buckets = buckets;
+  cache->mask = old_size * 2 - 1;
+
+  for (i = 0 ; i < old_size ; i++)
+    {
+      for (e = old[i] ; e ; e = chain)
+        {
+          chain = e->chain;
+          h = cache_hash (cache, e->image, e->recnum);
+          e->chain = buckets[h];
+          buckets[h] = e;
+        }
+    }
+
+  free (old);
+}
+
+
+/*  Reads record "recnum" of "image" into a new entry at the front of the LRU list.  "*pos" is where the file
+    pointer is (-1 if unknown) so runs of neighbors are read without seeking.  */
+
+static CACHE_ENTRY_T *cache_load (CHARTS_CACHE_T *cache, CHARTS_IMAGE_T *image, int32_t recnum, int64_t *pos)
+{
+  IMAGE_INDEX_T    index;
+  CACHE_ENTRY_T    *e;
+  FILE             *fp;
+  uint32_t         h;
+
+
+  if (charts_image_get_metadata (image, recnum, &index) || !index.image_size) return (NULL);
+
+  if ((e = (CACHE_ENTRY_T *) malloc (CACHE_HEAD + index.image_size)) == NULL)
+    {
+      perror ("Allocating cached image");
+      return (NULL);
+    }
+
+  fp = charts_image_fp (image);
+
+  if (*pos != index.byte_offset) charts_io_seek (charts_image_stats (image), fp, index.byte_offset, SEEK_SET);
+
+  if (charts_io_read (charts_image_stats (image), CACHE_DATA (e), index.image_size, 1, fp) != 1)
+    {
+      *pos = -1;
+      free (e);
+      return (NULL);
+    }
+
+  *pos = index.byte_offset + index.image_size;
+
+
+  e->image = image;
+  e->recnum = recnum;
+  e->size = index.image_size;
+  e->image_time = index.timestamp;
+  e->refs = 0;
+
+  h = cache_hash (cache, image, recnum);
+  e->chain = cache->buckets[h];
+  cache->buckets[h] = e;
+
+  cache_push_front (cache, e);
+
+  cache->bytes += e->size;
+  if (++cache->count > (int32_t) (cache->mask + 1) * 2) cache_grow (cache);
+
+  return (e);
+}
+
+
+/*  Opens a cache that holds at most "max_bytes" of unreferenced images.  On a miss the next "read_ahead" images
+    in the direction of travel are read as well (0 to turn that off).  Returns NULL on failure.  */
+
+CHARTS_CACHE_T *charts_cache_open (int64_t max_bytes, int32_t read_ahead)
+{
+  CHARTS_CACHE_T   *cache;
+
+
+  if ((cache = (CHARTS_CACHE_T *) calloc (1, sizeof (CHARTS_CACHE_T))) == NULL)
+    {
+      perror ("Allocating image cache");
+      return (NULL);
+    }
+
+  cache->mask = 255;
+
+  if ((cache->buckets = (CACHE_ENTRY_T **) calloc (cache->mask + 1, sizeof (CACHE_ENTRY_T *))) == NULL)
+    {
+      perror ("Allocating image cache");
+      free (cache);
+      return (NULL);
+    }
+
+  cache->max_bytes = max_bytes;
+  cache->read_ahead = read_ahead < 0 ? 0 : read_ahead;
+
+  pthread_mutex_init (&cache->mutex, NULL);
+
+  return (cache);
+}
+
+
+/*  Frees everything, referenced or not.  Don't use any buffer from the cache after this.  */
+
+void charts_cache_close (CHARTS_CACHE_T *cache)
+{
+  CACHE_ENTRY_T    *e, *next;
+
+
+  if (cache == NULL) return;
+
+  for (e = cache->head ; e ; e = next)
+    {
+      next = e->next;
+      free (e);
+    }
+
+  pthread_mutex_destroy (&cache->mutex);
+
+  free (cache->buckets);
+  free (cache);
+}
+
+
+/*  Returns the image for record "recnum" (numbered from 1) of "image", reading it if it isn't cached.  The
+    buffer belongs to the cache; hand it back with charts_cache_release when you're done with it.  The cache
+    reads through the handle's FILE so don't read from "image" in another thread while the cache is using it.
+    Returns NULL if the record doesn't exist, is empty, or couldn't be read.  */
+
+const uint8_t *charts_cache_get (CHARTS_CACHE_T *cache, CHARTS_IMAGE_T *image, int32_t recnum, uint32_t *size,
+                                 int64_t *image_time)
+{
+  CACHE_ENTRY_T    *e;
+  int32_t          lo, hi, k, count;
+  int64_t          pos;
+
+
+  pthread_mutex_lock (&cache->mutex);
+
+  if ((e = cache_lookup (cache, image, recnum)) != NULL)
+    {
+      cache->hits++;
+      CHARTS_IO_COUNT (charts_image_stats (image), cache_hits, 1);
+
+      cache_unlink (cache, e);
+      cache_push_front (cache, e);
+    }
+  else
+    {
+      cache->misses++;
+      CHARTS_IO_COUNT (charts_image_stats (image), cache_misses, 1);
+
+
+      /*  Work out which way we're going.  Stepping back one from the last request reads ahead backwards,
+          anything else reads ahead forwards.  */
+
+      count = charts_image_header (image)->text.number_images;
+      lo = hi = recnum;
+
+      if (recnum >= 1 && recnum <= count && cache->read_ahead)
+        {
+          if (image == cache->last_image && recnum == cache->last_recnum - 1)
+            {
+              lo = recnum - cache->read_ahead;
+              if (lo < 1) lo = 1;
+            }
+          else
+            {
+              hi = recnum + cache->read_ahead;
+              if (hi > count) hi = count;
+            }
+        }
+
+
+      /*  Always read in file order.  Neighbors that are already here are left alone.  */
+
+      pos = -1;
+      for (k = lo ; k <= hi ; k++)
+        {
+          if (k == recnum)
+            {
+              e = cache_load (cache, image, k, &pos);
+            }
+          else if (cache_lookup (cache, image, k) == NULL)
+            {
+              cache_load (cache, image, k, &pos);
+            }
+        }
+
+
+      /*  The one that was asked for goes to the front, ahead of the read-ahead.  */
+
+      if (e != NULL)
+        {
+          cache_unlink (cache, e);
+          cache_push_front (cache, e);
+        }
+    }
+
+  cache->last_image = image;
+  cache->last_recnum = recnum;
+
+  if (e == NULL)
+    {
+      pthread_mutex_unlock (&cache->mutex);
+      return (NULL);
+    }
+
+  e->refs++;
+
+  cache_evict (cache);
+
+  *size = e->size;
+  *image_time = e->image_time;
+
+  pthread_mutex_unlock (&cache->mutex);
+
+  return (CACHE_DATA (e));
+}
+
+
+/*  Gives back a buffer from charts_cache_get.  */
+
+void charts_cache_release (CHARTS_CACHE_T *cache, const uint8_t *data)
+{
+  CACHE_ENTRY_T    *e;
+
+
+  if (data == NULL) return;
+
+  e = (CACHE_ENTRY_T *) (data - CACHE_HEAD);
+
+  pthread_mutex_lock (&cache->mutex);
+
+  if (e->refs > 0 && !--e->refs)
+    {
+      /*  Orphans go as soon as nobody wants them.  */
+
+      if (e->image == NULL)
+        {
+          cache_remove (cache, e);
+        }
+      else
+        {
+          cache_evict (cache);
+        }
+    }
+
+  pthread_mutex_unlock (&cache->mutex);
+}
+
+
+/*  Removes every entry for "image".  Call this before charts_image_close or a later handle that happens to get
+    the same address would find the old images.  Buffers that are still referenced stay valid until they're
+    released.  */
+
+void charts_cache_drop (CHARTS_CACHE_T *cache, CHARTS_IMAGE_T *image)
+{
+  CACHE_ENTRY_T    *e, *next, **p;
+
+
+  pthread_mutex_lock (&cache->mutex);
+
+  for (e = cache->head ; e ; e = next)
+    {
+      next = e->next;
+
+      if (e->image != image) continue;
+
+      if (!e->refs)
+        {
+          cache_remove (cache, e);
+        }
+      else
+        {
+          for (p = &cache->buckets[cache_hash (cache, e->image, e->recnum)] ; *p != e ; p = &(*p)->chain);
+          *p = e->chain;
+          e->image = NULL;
+        }
+    }
+
+  if (cache->last_image == image) cache->last_image = NULL;
+
+  pthread_mutex_unlock (&cache->mutex);
+}
+
+
+/*  Bytes currently held and the hit/miss counts since the cache was opened.  Any pointer may be NULL.  */
+
+void charts_cache_stats (CHARTS_CACHE_T *cache, int64_t *bytes, int64_t *hits, int64_t *misses)
+{
+  pthread_mutex_lock (&cache->mutex);
+
+  if (bytes) *bytes = cache->bytes;
+  if (hits) *hits = cache->hits;
+  if (misses) *misses = cache->misses;
+
+  pthread_mutex_unlock (&cache->mutex);
+}
@@ -0,0 +1,68 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_cache.h   Header
+ *
+ * Purpose:        Byte budgeted LRU cache of IMG file images keyed by
+ *                 (image handle, record number).  Buffers handed out by
+ *                 charts_cache_get are reference counted and are never
+ *                 evicted while referenced, so viewers can hold on to the
+ *                 image they're drawing while scrubbing through a line.  On
+ *                 a miss the cache can also read the next few images in the
+ *                 direction of travel (they're contiguous in the file so
+ *                 it costs one seek).
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_CACHE_H__
+#define __CHARTS_CACHE_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "FileImage.h"
+
+
+  typedef struct CHARTS_CACHE CHARTS_CACHE_T;
+
+
+  CHARTS_CACHE_T *charts_cache_open (int64_t max_bytes, int32_t read_ahead);
+  void charts_cache_close (CHARTS_CACHE_T *cache);
+  const uint8_t *charts_cache_get (CHARTS_CACHE_T *cache, CHARTS_IMAGE_T *image, int32_t recnum, uint32_t *size,
+                                   int64_t *image_time);
+  void charts_cache_release (CHARTS_CACHE_T *cache, const uint8_t *data);
+  void charts_cache_drop (CHARTS_CACHE_T *cache, CHARTS_IMAGE_T *image);
+  void charts_cache_stats (CHARTS_CACHE_T *cache, int64_t *bytes, int64_t *hits, int64_t *misses);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,688 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include <sys/stat.h>
+
+#ifdef NVWIN3X
+  #include <io.h>
+  #define strcasecmp _stricmp
+#else
+  #include <dirent.h>
+#endif
+
+#include "charts_catalog.h"
+#include "FileHydroOutput.h"
+#include "FileTopoOutput.h"
+#include "FileImage.h"
+#include "FileWave.h"
+
+
+#ifdef NVWIN3X
+    static char separator = '\\';
+#else
+    static char separator = '/';
+#endif
+
+
+/*  The cache file is a CATALOG_HEADER_T followed by "count" CATALOG_RECORD_T and then "string_bytes" of NUL
+    terminated paths (CATALOG_RECORD_T.path is the offset of the entry's path in there).  Everything is in native
+    byte order, a cache from the other endianness is just ignored and rebuilt.  */
+
+#define CATALOG_MAGIC      "CHARTS CATALOG  "
+#define CATALOG_VERSION    1
+
+typedef struct
+{
+  char             magic[16];
+  int32_t          version;
+  int32_t          byte_order;
+  int32_t          count;
+  int32_t          fill;
+  int64_t          string_bytes;
+} CATALOG_HEADER_T;
+
+
+typedef struct
+{
+  int64_t          path;
+  int64_t          size;
+  int64_t          mtime;
+  int64_t          start_timestamp;
+  int64_t          end_timestamp;
+  double           line_min_lat;
+  double           line_max_lat;
+  double           line_min_lon;
+  double           line_max_lon;
+  int32_t          type;
+  int32_t          number_shots;
+  int16_t          coded_fl_number;
+  int8_t           ab_system_type;
+  int8_t           ab_system_number;
+  uint8_t          has_bounds;
+  uint8_t          fill[3];
+  char             flightline_number[64];
+} CATALOG_RECORD_T;
+
+
+struct CHARTS_CATALOG
+{
+  char                     path[1024];
+  int32_t                  count;
+  int32_t                  size;
+  CHARTS_CATALOG_ENTRY_T   *entries;
+  int32_t                  old_count;      /*  Entries that were there (sorted by path) when the scan started.  */
+  uint8_t                  *seen;
+  int32_t                  reread;
+};
+
+
+static int catalog_compare (const void *a, const void *b)
+{
+  return (strcmp (((const CHARTS_CATALOG_ENTRY_T *) a)->path, ((const CHARTS_CATALOG_ENTRY_T *) b)->path));
+}
+
+
+static void catalog_free_entries (CHARTS_CATALOG_T *catalog)
+{
+  int32_t                  i;
+
+
+  for (i = 0 ; i < catalog->count ; i++) free (catalog->entries[i].path);
+  free (catalog->entries);
+
+  catalog->entries = NULL;
+  catalog->count = catalog->size = 0;
+}
+
+
+/*  Loads the cache file.  Anything wrong with it just leaves the catalog empty.  */
+
+static void catalog_load (CHARTS_CATALOG_T *catalog)
+{
+  FILE                     *fp;
+  CATALOG_HEADER_T         head;
+  CATALOG_RECORD_T         *records = NULL;
+  CHARTS_CATALOG_ENTRY_T   *entry;
+  char                     *strings = NULL;
+  int32_t                  i;
+
+
+  if ((fp = fopen64 (catalog->path, "rb")) == NULL) return;
+
+  if (fread (&head, sizeof (CATALOG_HEADER_T), 1, fp) != 1 || memcmp (head.magic, CATALOG_MAGIC, 16) ||
+      head.version != CATALOG_VERSION || head.byte_order != 0x01020304 || head.count <= 0 || head.string_bytes <= 0 ||
+      (records = (CATALOG_RECORD_T *) malloc (head.count * sizeof (CATALOG_RECORD_T))) == NULL ||
+      (strings = (char *) malloc (head.string_bytes)) == NULL ||
+      (catalog->entries = (CHARTS_CATALOG_ENTRY_T *) calloc (head.count, sizeof (CHARTS_CATALOG_ENTRY_T))) == NULL ||
+      fread (records, sizeof (CATALOG_RECORD_T), head.count, fp) != (size_t) head.count ||
+      fread (strings, 1, head.string_bytes, fp) != (size_t) head.string_bytes || strings[head.string_bytes - 1])
+    {
+      free (catalog->entries);
+      catalog->entries = NULL;
+      free (strings);
+      free (records);
+      fclose (fp);
+      return;
+    }
+
+  fclose (fp);
+
+
+  catalog->size = head.count;
+
+  for (i = 0 ; i < head.count ; i++)
+    {
+      if (records[i].path < 0 || records[i].path >= head.string_bytes) break;
+
+      entry = &catalog->entries[catalog->count];
+
+      if ((entry->path = strdup (&strings[records[i].path])) == NULL) break;
+
+      entry->size = records[i].size;
+      entry->mtime = records[i].mtime;
+      entry->type = records[i].type;
+      entry->start_timestamp = records[i].start_timestamp;
+      entry->end_timestamp = records[i].end_timestamp;
+      entry->has_bounds = records[i].has_bounds;
+      entry->line_min_lat = records[i].line_min_lat;
+      entry->line_max_lat = records[i].line_max_lat;
+      entry->line_min_lon = records[i].line_min_lon;
+      entry->line_max_lon = records[i].line_max_lon;
+      entry->number_shots = records[i].number_shots;
+      entry->coded_fl_number = records[i].coded_fl_number;
+      entry->ab_system_type = records[i].ab_system_type;
+      entry->ab_system_number = records[i].ab_system_number;
+      memcpy (entry->flightline_number, records[i].flightline_number, sizeof (entry->flightline_number));
+      entry->flightline_number[sizeof (entry->flightline_number) - 1] = 0;
+
+      catalog->count++;
+    }
+
+  free (strings);
+  free (records);
+}
+
+
+/*  Opens the catalog kept in "cache_path" (an empty one if the file doesn't exist yet or can't be used).  Returns
+    NULL on failure.  */
+
+CHARTS_CATALOG_T *charts_catalog_open (char *cache_path)
+{
+  CHARTS_CATALOG_T         *catalog;
+
+
+  if ((catalog = (CHARTS_CATALOG_T *) calloc (1, sizeof (CHARTS_CATALOG_T))) == NULL)
+    {
+      perror ("Allocating catalog");
+      return (NULL);
+    }
+
+  strncpy (catalog->path, cache_path, sizeof (catalog->path) - 1);
+
+  catalog_load (catalog);
+
+  qsort (catalog->entries, catalog->count, sizeof (CHARTS_CATALOG_ENTRY_T), catalog_compare);
+
+  return (catalog);
+}
+
+
+void charts_catalog_close (CHARTS_CATALOG_T *catalog)
+{
+  if (catalog == NULL) return;
+
+  catalog_free_entries (catalog);
+  free (catalog);
+}
+
+
+int32_t charts_catalog_count (CHARTS_CATALOG_T *catalog)
+{
+  return (catalog->count);
+}
+
+
+const CHARTS_CATALOG_ENTRY_T *charts_catalog_entry (CHARTS_CATALOG_T *catalog, int32_t index)
+{
+  if (index < 0 || index >= catalog->count) return (NULL);
+
+  return (&catalog->entries[index]);
+}
+
+
+/*  File type from the extension, or -1 if it isn't one of ours.  */
+
+static int32_t catalog_type (char *path)
+{
+  char                     *ext;
+
+
+  if ((ext = strrchr (path, '.')) == NULL) return (-1);
+
+  if (!strcasecmp (ext, ".hof")) return (CHARTS_CATALOG_HOF);
+  if (!strcasecmp (ext, ".tof")) return (CHARTS_CATALOG_TOF);
+  if (!strcasecmp (ext, ".img")) return (CHARTS_CATALOG_IMG);
+  if (!strcasecmp (ext, ".inh")) return (CHARTS_CATALOG_INH);
+
+  return (-1);
+}
+
+
+/*  Reads the header of "entry->path" into "entry".  This reads the ASCII header directly (charts_header_read)
+    instead of using the *_read_header calls so we don't disturb the FILE based readers' state.  */
+
+static int32_t catalog_read_header (CHARTS_CATALOG_ENTRY_T *entry)
+{
+  FILE                     *fp;
+  char                     varin[1024];
+  HOF_TEXT_T               hof;
+  TOF_TEXT_T               tof;
+  IMAGE_TEXT_T             image;
+  IMAGE_INFO_T             info;
+  WAVE_HEADER_T            wave;
+
+
+  char *ngets (char *s, int32_t size, FILE *stream);
+
+
+  if ((fp = fopen64 (entry->path, "rb")) == NULL)
+    {
+      perror (entry->path);
+      return (-1);
+    }
+
+  entry->has_bounds = 0;
+  entry->line_min_lat = entry->line_max_lat = entry->line_min_lon = entry->line_max_lon = 0.0;
+  entry->number_shots = 0;
+  entry->coded_fl_number = 0;
+  entry->ab_system_type = entry->ab_system_number = 0;
+  entry->flightline_number[0] = 0;
+
+  switch (entry->type)
+    {
+    case CHARTS_CATALOG_HOF:
+      memset (&hof, 0, sizeof (HOF_TEXT_T));
+      charts_header_read (fp, &charts_hof_header_table, &hof, &hof.header_size);
+
+      entry->start_timestamp = hof.start_timestamp;
+      entry->end_timestamp = hof.end_timestamp;
+      entry->has_bounds = 1;
+      entry->line_min_lat = hof.line_min_lat;
+      entry->line_max_lat = hof.line_max_lat;
+      entry->line_min_lon = hof.line_min_lon;
+      entry->line_max_lon = hof.line_max_lon;
+      entry->number_shots = hof.number_shots;
+      entry->coded_fl_number = hof.coded_fl_number;
+      entry->ab_system_type = hof.ab_system_type;
+      entry->ab_system_number = hof.ab_system_number;
+      strcpy (entry->flightline_number, hof.flightline_number);
+      break;
+
+    case CHARTS_CATALOG_TOF:
+      memset (&tof, 0, sizeof (TOF_TEXT_T));
+      charts_header_read (fp, &charts_tof_header_table, &tof, &tof.header_size);
+
+      entry->start_timestamp = tof.start_timestamp;
+      entry->end_timestamp = tof.end_timestamp;
+      entry->has_bounds = 1;
+      entry->line_min_lat = tof.line_min_lat;
+      entry->line_max_lat = tof.line_max_lat;
+      entry->line_min_lon = tof.line_min_lon;
+      entry->line_max_lon = tof.line_max_lon;
+      entry->number_shots = tof.number_shots;
+      entry->coded_fl_number = tof.coded_fl_number;
+      entry->ab_system_type = tof.ab_system_type;
+      entry->ab_system_number = tof.ab_system_number;
+      strcpy (entry->flightline_number, tof.flightline_number);
+      break;
+
+
+      /*  Same old/new format check as image_read_header.  */
+
+    case CHARTS_CATALOG_IMG:
+      if (ngets (varin, sizeof (varin), fp) != NULL && !strncmp (varin, "File", 4))
+        {
+          fseeko64 (fp, 0LL, SEEK_SET);
+
+          memset (&image, 0, sizeof (IMAGE_TEXT_T));
+          charts_header_read (fp, &charts_image_header_table, &image, &image.header_size);
+
+          entry->start_timestamp = image.start_timestamp;
+          entry->end_timestamp = image.end_timestamp;
+          entry->number_shots = image.number_images;
+          entry->coded_fl_number = image.coded_fl_number;
+          strcpy (entry->flightline_number, image.flightline_number);
+        }
+      else
+        {
+          memset (&info, 0, sizeof (IMAGE_INFO_T));
+          fseeko64 (fp, (int64_t) IMAGE_HEAD_SIZE, SEEK_SET);
+          fread (&info, sizeof (IMAGE_INFO_T), 1, fp);
+
+          entry->start_timestamp = info.start_timestamp;
+          entry->end_timestamp = info.end_timestamp;
+          entry->number_shots = info.number_images;
+        }
+      break;
+
+    case CHARTS_CATALOG_INH:
+      memset (&wave, 0, sizeof (WAVE_HEADER_T));
+      charts_header_read (fp, &charts_wave_header_table, &wave, &wave.header_size);
+
+      entry->start_timestamp = wave.start_timestamp;
+      entry->end_timestamp = wave.end_timestamp;
+      entry->number_shots = wave.number_shots;
+      entry->coded_fl_number = wave.coded_fl_number;
+      entry->ab_system_type = wave.ab_system_type;
+      entry->ab_system_number = wave.ab_system_number;
+      strcpy (entry->flightline_number, wave.flightline_number);
+      break;
+    }
+
+  fclose (fp);
+
+  return (0);
+}
+
+
+/*  Adds or refreshes the entry for one data file.  */
+
+static void catalog_file (CHARTS_CATALOG_T *catalog, char *path, int32_t type, int64_t size, int64_t mtime)
+{
+  CHARTS_CATALOG_ENTRY_T   key, *entry, *new_entries;
+
+
+  key.path = path;
+
+  entry = (CHARTS_CATALOG_ENTRY_T *) bsearch (&key, catalog->entries, catalog->old_count, sizeof (CHARTS_CATALOG_ENTRY_T),
+                                              catalog_compare);
+
+  if (entry != NULL)
+    {
+      catalog->seen[entry - catalog->entries] = 1;
+
+      if (entry->size == size && entry->mtime == mtime && entry->type == type) return;
+    }
+  else
+    {
+      if (catalog->count == catalog->size)
+        {
+          if ((new_entries = (CHARTS_CATALOG_ENTRY_T *) realloc (catalog->entries, (catalog->size * 2 + 64) *
+                                                                 sizeof (CHARTS_CATALOG_ENTRY_T))) == NULL)
+            {
+              perror ("Allocating catalog entries");
+              return;
+            }
+
+          catalog->entries = new_entries;
+          catalog->size = catalog->size * 2 + 64;
+        }
+
+      entry = &catalog->entries[catalog->count];
+      memset (entry, 0, sizeof (CHARTS_CATALOG_ENTRY_T));
+
+      if ((entry->path = strdup (path)) == NULL) return;
+
+      catalog->count++;
+    }
+
+
+  entry->size = size;
+  entry->mtime = mtime;
+  entry->type = type;
+
+  catalog_read_header (entry);
+
+  catalog->reread++;
+}
+
+
+static void catalog_walk (CHARTS_CATALOG_T *catalog, char *dir)
+{
+  char                     path[1024];
+  int32_t                  type;
+
+#ifdef NVWIN3X
+  struct _finddata_t       find;
+  struct _stati64          st;
+  intptr_t                 handle;
+
+
+  sprintf (path, "%s%c*", dir, separator);
+
+  if ((handle = _findfirst (path, &find)) == -1) return;
+
+  do
+    {
+      if (!strcmp (find.name, ".") || !strcmp (find.name, "..")) continue;
+
+      snprintf (path, sizeof (path), "%s%c%s", dir, separator, find.name);
+
+      if (_stati64 (path, &st)) continue;
+
+      if (st.st_mode & _S_IFDIR)
+        {
+          catalog_walk (catalog, path);
+        }
+      else if ((type = catalog_type (path)) >= 0)
+        {
+          catalog_file (catalog, path, type, st.st_size, st.st_mtime);
+        }
+    } while (!_findnext (handle, &find));
+
+  _findclose (handle);
+#else
+  DIR                      *dp;
+  struct dirent            *de;
+  struct stat64            st;
+
+
+  if ((dp = opendir (dir)) == NULL) return;
+
+  while ((de = readdir (dp)) != NULL)
+    {
+      if (!strcmp (de->d_name, ".") || !strcmp (de->d_name, "..")) continue;
+
+      snprintf (path, sizeof (path), "%s%c%s", dir, separator, de->d_name);
+
+      if (stat64 (path, &st)) continue;
+
+      if (S_ISDIR (st.st_mode))
+        {
+          catalog_walk (catalog, path);
+        }
+      else if (S_ISREG (st.st_mode) && (type = catalog_type (path)) >= 0)
+        {
+          catalog_file (catalog, path, type, st.st_size, st.st_mtime);
+        }
+    }
+
+  closedir (dp);
+#endif
+}
+
+
+/*  Walks the directory tree under "root" and brings the catalog up to date: new files are added, files whose size
+    or modification time changed have their headers read again, and entries for files under "root" that are gone
+    are dropped.  Entries outside of "root" are left alone so one catalog can cover several trees.  Returns the
+    number of headers read, or -1 if "root" can't be read.  Call charts_catalog_save to update the cache file.  */
+
+int32_t charts_catalog_scan (CHARTS_CATALOG_T *catalog, char *root)
+{
+  char                     dir[1024];
+  int32_t                  i, j, length;
+#ifdef NVWIN3X
+  struct _stati64          st;
+#else
+  struct stat64            st;
+#endif
+
+
+  strncpy (dir, root, sizeof (dir) - 1);
+  dir[sizeof (dir) - 1] = 0;
+
+  length = strlen (dir);
+  while (length > 1 && dir[length - 1] == separator) dir[--length] = 0;
+
+#ifdef NVWIN3X
+  if (_stati64 (dir, &st) || !(st.st_mode & _S_IFDIR))
+#else
+  if (stat64 (dir, &st) || !S_ISDIR (st.st_mode))
+#endif
+    {
+      perror (root);
+      return (-1);
+    }
+
+
+  catalog->old_count = catalog->count;
+  catalog->reread = 0;
+
+  if ((catalog->seen = (uint8_t *) calloc (MAX (catalog->count, 1), 1)) == NULL)
+    {
+      perror ("Allocating catalog scan");
+      return (-1);
+    }
+
+  catalog_walk (catalog, dir);
+
+
+  /*  Drop the entries under "root" that we didn't find.  */
+
+  for (i = j = 0 ; i < catalog->count ; i++)
+    {
+      if (i < catalog->old_count && !catalog->seen[i] && !strncmp (catalog->entries[i].path, dir, length) &&
+          catalog->entries[i].path[length] == separator)
+        {
+          free (catalog->entries[i].path);
+          catalog->reread++;
+          continue;
+        }
+
+      catalog->entries[j++] = catalog->entries[i];
+    }
+
+  catalog->count = j;
+
+  free (catalog->seen);
+  catalog->seen = NULL;
+  catalog->old_count = 0;
+
+  qsort (catalog->entries, catalog->count, sizeof (CHARTS_CATALOG_ENTRY_T), catalog_compare);
+
+  return (catalog->reread);
+}
+
+
+/*  Writes the cache file (to a temporary file that is then renamed over the old one).  Returns 0 on success or -1
+    on failure.  */
+
+int32_t charts_catalog_save (CHARTS_CATALOG_T *catalog)
+{
+  FILE                     *fp;
+  char                     tmp_file[1040];
+  CATALOG_HEADER_T         head;
+  CATALOG_RECORD_T         record;
+  CHARTS_CATALOG_ENTRY_T   *entry;
+  int32_t                  i, status = 0;
+  int64_t                  offset = 0;
+
+
+  sprintf (tmp_file, "%s.tmp", catalog->path);
+
+  if ((fp = fopen64 (tmp_file, "wb")) == NULL)
+    {
+      perror (tmp_file);
+      return (-1);
+    }
+
+
+  memset (&head, 0, sizeof (CATALOG_HEADER_T));
+  memcpy (head.magic, CATALOG_MAGIC, 16);
+  head.version = CATALOG_VERSION;
+  head.byte_order = 0x01020304;
+  head.count = catalog->count;
+
+  for (i = 0 ; i < catalog->count ; i++) head.string_bytes += strlen (catalog->entries[i].path) + 1;
+
+  if (fwrite (&head, sizeof (CATALOG_HEADER_T), 1, fp) != 1) status = -1;
+
+
+  for (i = 0 ; i < catalog->count && !status ; i++)
+    {
+      entry = &catalog->entries[i];
+
+      memset (&record, 0, sizeof (CATALOG_RECORD_T));
+      record.path = offset;
+      record.size = entry->size;
+      record.mtime = entry->mtime;
+      record.type = entry->type;
+      record.start_timestamp = entry->start_timestamp;
+      record.end_timestamp = entry->end_timestamp;
+      record.has_bounds = entry->has_bounds;
+      record.line_min_lat = entry->line_min_lat;
+      record.line_max_lat = entry->line_max_lat;
+      record.line_min_lon = entry->line_min_lon;
+      record.line_max_lon = entry->line_max_lon;
+      record.number_shots = entry->number_shots;
+      record.coded_fl_number = entry->coded_fl_number;
+      record.ab_system_type = entry->ab_system_type;
+      record.ab_system_number = entry->ab_system_number;
+      memcpy (record.flightline_number, entry->flightline_number, sizeof (record.flightline_number));
+
+      offset += strlen (entry->path) + 1;
+
+      if (fwrite (&record, sizeof (CATALOG_RECORD_T), 1, fp) != 1) status = -1;
+    }
+
+  for (i = 0 ; i < catalog->count && !status ; i++)
+    {
+      if (fwrite (catalog->entries[i].path, strlen (catalog->entries[i].path) + 1, 1, fp) != 1) status = -1;
+    }
+
+
+  if (fclose (fp)) status = -1;
+
+  if (status)
+    {
+      perror (tmp_file);
+      remove (tmp_file);
+      return (-1);
+    }
+
+
+#ifdef NVWIN3X
+  remove (catalog->path);
+#endif
+
+  if (rename (tmp_file, catalog->path))
+    {
+      perror (catalog->path);
+      remove (tmp_file);
+      return (-1);
+    }
+
+  return (0);
+}
+
+
+/*  Returns the number of catalog entries (indices into the catalog, for charts_catalog_entry) whose time span
+    overlaps "start_timestamp" to "end_timestamp" and whose line bounds overlap the area, in "indices" (allocated
+    here, free it when you're done).  Pass 0 for both timestamps to skip the time test and a "min_lat" greater than
+    "max_lat" to skip the area test.  Entries without bounds (IMG and INH) never match an area test.  Returns -1 on
+    failure.  */
+
+int32_t charts_catalog_query (CHARTS_CATALOG_T *catalog, int64_t start_timestamp, int64_t end_timestamp, double min_lat,
+                              double min_lon, double max_lat, double max_lon, int32_t **indices)
+{
+  CHARTS_CATALOG_ENTRY_T   *entry;
+  int32_t                  i, count = 0;
+
+
+  *indices = NULL;
+
+  if (!catalog->count) return (0);
+
+  if ((*indices = (int32_t *) malloc (catalog->count * sizeof (int32_t))) == NULL)
+    {
+      perror ("Allocating catalog query");
+      return (-1);
+    }
+
+
+  for (i = 0 ; i < catalog->count ; i++)
+    {
+      entry = &catalog->entries[i];
+
+      if ((start_timestamp || end_timestamp) &&
+          (entry->start_timestamp > end_timestamp || entry->end_timestamp < start_timestamp)) continue;
+
+      if (min_lat <= max_lat &&
+          (!entry->has_bounds || entry->line_min_lat > max_lat || entry->line_max_lat < min_lat ||
+           entry->line_min_lon > max_lon || entry->line_max_lon < min_lon)) continue;
+
+      (*indices)[count++] = i;
+    }
+
+  return (count);
+}
@@ -0,0 +1,95 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_catalog.h   Header
+ *
+ * Purpose:        Survey wide catalog of HOF, TOF, IMG and INH headers.
+ *                 charts_catalog_scan walks a directory tree and keeps the
+ *                 interesting header fields of every data file in a
+ *                 compact binary cache file, keyed by path, size and
+ *                 modification time, so that only new or changed files
+ *                 have their headers read again.  charts_catalog_query
+ *                 finds the lines that overlap a time span and/or area
+ *                 without opening the data files.
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_CATALOG_H__
+#define __CHARTS_CATALOG_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "charts.h"
+
+
+#define         CHARTS_CATALOG_HOF      0
+#define         CHARTS_CATALOG_TOF      1
+#define         CHARTS_CATALOG_IMG      2
+#define         CHARTS_CATALOG_INH      3
+
+
+  typedef struct
+  {
+    char        *path;
+    int64_t     size;
+    int64_t     mtime;
+    int32_t     type;               /*  CHARTS_CATALOG_HOF, etc.  */
+    int64_t     start_timestamp;    /*  time in microseconds from 01/01/1970  */
+    int64_t     end_timestamp;
+    uint8_t     has_bounds;         /*  Only HOF and TOF headers carry the line's bounds.  */
+    double      line_min_lat;
+    double      line_max_lat;
+    double      line_min_lon;
+    double      line_max_lon;
+    int32_t     number_shots;       /*  number_images for IMG files  */
+    int16_t     coded_fl_number;
+    int8_t      ab_system_type;
+    int8_t      ab_system_number;
+    char        flightline_number[64];
+  } CHARTS_CATALOG_ENTRY_T;
+
+
+  typedef struct CHARTS_CATALOG CHARTS_CATALOG_T;
+
+
+  CHARTS_CATALOG_T *charts_catalog_open (char *cache_path);
+  int32_t charts_catalog_scan (CHARTS_CATALOG_T *catalog, char *root);
+  int32_t charts_catalog_save (CHARTS_CATALOG_T *catalog);
+  void charts_catalog_close (CHARTS_CATALOG_T *catalog);
+  int32_t charts_catalog_count (CHARTS_CATALOG_T *catalog);
+  const CHARTS_CATALOG_ENTRY_T *charts_catalog_entry (CHARTS_CATALOG_T *catalog, int32_t index);
+  int32_t charts_catalog_query (CHARTS_CATALOG_T *catalog, int64_t start_timestamp, int64_t end_timestamp, double min_lat, double min_lon, double max_lat, double max_lon, int32_t **indices);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -23,50 +23,135 @@
 
 #include "charts.h"
 
+/*  Days from 01/01/1970 to "year" (e.g. 2026), "month" (1-12), "mday" in the proleptic Gregorian calendar.  This and
+    charts_civil_from_days are Howard Hinnant's days_from_civil/civil_from_days (public domain).  */
+
+static int64_t charts_days_from_civil (int64_t year, int32_t month, int32_t mday)
+{
+    int64_t              era, yoe, doy, doe;
+
+
+    year -= month <= 2;
+    era = (year >= 0 ? year : year - 399) / 400;
+    yoe = year - era * 400;
+    doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + mday - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return (era * 146097 + doe - 719468);
+}
+
+
+static void charts_civil_from_days (int64_t days, int64_t *year, int32_t *month, int32_t *mday)
+{
+    int64_t              era, doe, yoe, doy, mp;
+
+
+    days += 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+
+    *mday = (int32_t) (doy - (153 * mp + 2) / 5 + 1);
+    *month = (int32_t) (mp < 10 ? mp + 3 : mp - 9);
+    *year = yoe + era * 400 + (*month <= 2);
+}
+
+
+/*  Seconds from 01/01/1970 00:00:00 UTC to midnight UTC on "year" (e.g. 2026), "month" (1-12), "mday".  This is what
+    the POS/RMS/GPS readers used to get from mktime with TZ set to GMT.  */
+
+int64_t charts_utc_time (int32_t year, int32_t month, int32_t mday)
+{
+    return (charts_days_from_civil (year, month, mday) * 86400);
+}
+
+
+/*  Converts microseconds from 01/01/1970 UTC to year (since 1900), day of year (1-366), hour, minute, and second.
+    This is plain arithmetic so it doesn't touch TZ or take the localtime lock and is safe to call from threads.  */
+
 void charts_cvtime (int64_t micro_sec, int32_t *year, int32_t *jday, 
                     int32_t *hour, int32_t *minute, float *second)
 {
-    static int32_t       tz_set = 0;
-    struct tm            time_struct, *time_ptr = &time_struct;
-    time_t               tv_sec;
-    int32_t              msec;
+    int64_t              tv_sec, days, secs, l_year;
+    int32_t              msec, month, mday;
 
 
-    if (!tz_set)
+    tv_sec = micro_sec / 1000000;
+    msec = micro_sec % 1000000;
+
+    if (msec < 0)
     {
-#ifdef NVWIN3X
-  #if defined (__MINGW64__) || defined (__MINGW32__)
-        putenv("TZ=GMT");
-        tzset();
-  #else
-        _putenv("TZ=GMT");
-        _tzset();
-  #endif
-#else
-        putenv("TZ=GMT");
-        tzset();
-#endif
-        tz_set = 1;
+        tv_sec--;
+        msec += 1000000;
     }
-    
 
-    tv_sec = micro_sec / 1000000;
-    time_ptr = localtime (&tv_sec);
+    days = tv_sec / 86400;
+    secs = tv_sec % 86400;
 
-    msec = micro_sec % 1000000;
+    if (secs < 0)
+    {
+        days--;
+        secs += 86400;
+    }
+
+    charts_civil_from_days (days, &l_year, &month, &mday);
 
-    *year = (short) time_ptr->tm_year;
-    *jday = (short) time_ptr->tm_yday + 1;
-    *hour = (short) time_ptr->tm_hour;
-    *minute = (short) time_ptr->tm_min;
-    *second = (float) time_ptr->tm_sec + (float) ((double) msec / 1000000.);
+    *year = (int32_t) (l_year - 1900);
+    *jday = (int32_t) (days - charts_days_from_civil (l_year, 1, 1)) + 1;
+    *hour = (int32_t) (secs / 3600);
+    *minute = (int32_t) ((secs % 3600) / 60);
+    *second = (float) (secs % 60) + (float) ((double) msec / 1000000.);
+}
+
+
+/*  charts_cvtime for "count" timestamps.  Consecutive timestamps on the same day (nearly always the case for
+    records from one file) only pay for the time of day.  */
+
+void charts_cvtime_batch (const int64_t *micro_sec, int32_t count, int32_t *year, int32_t *jday, 
+                          int32_t *hour, int32_t *minute, float *second)
+{
+    int32_t              i, msec;
+    int64_t              tv_sec, secs, day_start = 0, day_end = 0;
+
+
+    for (i = 0 ; i < count ; i++)
+    {
+        tv_sec = micro_sec[i] / 1000000;
+        msec = micro_sec[i] % 1000000;
+
+        if (msec < 0)
+        {
+            tv_sec--;
+            msec += 1000000;
+        }
+
+        if (!i || tv_sec < day_start || tv_sec >= day_end)
+        {
+            charts_cvtime (micro_sec[i], &year[i], &jday[i], &hour[i], &minute[i], &second[i]);
+
+            day_start = tv_sec - (tv_sec % 86400 + 86400) % 86400;
+            day_end = day_start + 86400;
+        }
+        else
+        {
+            secs = tv_sec - day_start;
+
+            year[i] = year[i - 1];
+            jday[i] = jday[i - 1];
+            hour[i] = (int32_t) (secs / 3600);
+            minute[i] = (int32_t) ((secs % 3600) / 60);
+            second[i] = (float) (secs % 60) + (float) ((double) msec / 1000000.);
+        }
+    }
 }
 
 
 
 void charts_jday2mday (int32_t year, int32_t jday, int32_t *mon, int32_t *mday)
 {
-  static int32_t              months[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  int32_t                     months[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
   int32_t                     l_year;
 
   l_year = year;
@@ -76,14 +161,7 @@ void charts_jday2mday (int32_t year, int32_t jday, int32_t *mon, int32_t *mday)
 
   /*  If the year is evenly divisible by 4 but not by 100, or it's evenly divisible by 400, this is a leap year.  */
 
-  if ((!(l_year % 4) && (l_year % 100)) || !(l_year % 400))
-    {
-      months[1] = 29;
-    }
-  else
-    {
-      months[1] = 28;
-    }
+  if ((!(l_year % 4) && (l_year % 100)) || !(l_year % 400)) months[1] = 29;
 
 
     *mday = jday;
@@ -0,0 +1,322 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#ifndef NVWIN3X
+  #include <fcntl.h>
+  #include <sys/mman.h>
+#endif
+
+#include "charts_edit.h"
+
+
+/*  "dirty" has a bit per "page_size" bytes of the file.  "first_dirty" and "last_dirty" bracket the pages that are
+    set (first_dirty > last_dirty when there aren't any).  */
+
+struct CHARTS_EDIT
+{
+  int64_t          head_size;
+  int32_t          record_size;
+  int32_t          num_records;
+  int64_t          map_size;
+  uint8_t          *map;
+  int64_t          page_size;
+  uint8_t          *dirty;
+  int64_t          first_dirty;
+  int64_t          last_dirty;
+  int32_t          num_dirty;
+#ifdef NVWIN3X
+  FILE             *fp;
+#endif
+};
+
+
+/*  Opens "path" for editing.  The records ("record_size" bytes each) start "head_size" bytes into the file.
+    Returns NULL on failure.  */
+
+CHARTS_EDIT_T *charts_edit_open (char *path, int64_t head_size, int32_t record_size)
+{
+  CHARTS_EDIT_T       *edit;
+  FILE                *fp;
+  int64_t             file_size;
+#ifndef NVWIN3X
+  int32_t             fd;
+#endif
+
+
+  if ((edit = (CHARTS_EDIT_T *) calloc (1, sizeof (CHARTS_EDIT_T))) == NULL)
+    {
+      perror ("Allocating edit map");
+      return (NULL);
+    }
+
+  edit->head_size = head_size;
+  edit->record_size = record_size;
+
+
+  if ((fp = fopen64 (path, "r+b")) == NULL)
+    {
+      perror (path);
+      free (edit);
+      return (NULL);
+    }
+
+  fseeko64 (fp, 0LL, SEEK_END);
+  file_size = ftello64 (fp);
+
+  if (file_size <= head_size)
+    {
+      fprintf (stderr, "%s has no records to edit\n", path);
+      fflush (stderr);
+      fclose (fp);
+      free (edit);
+      return (NULL);
+    }
+
+  edit->num_records = (int32_t) ((file_size - head_size) / (int64_t) record_size);
+  edit->map_size = head_size + (int64_t) edit->num_records * (int64_t) record_size;
+
+
+#ifdef NVWIN3X
+
+  edit->page_size = 4096;
+
+  if ((edit->map = (uint8_t *) malloc (edit->map_size)) == NULL)
+    {
+      perror ("Allocating edit map");
+      fclose (fp);
+      free (edit);
+      return (NULL);
+    }
+
+  fseeko64 (fp, 0LL, SEEK_SET);
+  if (!fread (edit->map, edit->map_size, 1, fp))
+    {
+      perror (path);
+      fclose (fp);
+      free (edit->map);
+      free (edit);
+      return (NULL);
+    }
+
+  edit->fp = fp;
+
+#else
+
+  fclose (fp);
+
+  edit->page_size = sysconf (_SC_PAGESIZE);
+
+
+  if ((fd = open (path, O_RDWR)) < 0)
+    {
+      perror (path);
+      free (edit);
+      return (NULL);
+    }
+
+  edit->map = (uint8_t *) mmap (NULL, edit->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  close (fd);
+
+  if (edit->map == (uint8_t *) MAP_FAILED)
+    {
+      perror (path);
+      free (edit);
+      return (NULL);
+    }
+
+#endif
+
+
+  if ((edit->dirty = (uint8_t *) calloc ((edit->map_size / edit->page_size) / 8 + 1, sizeof (uint8_t))) == NULL)
+    {
+      perror ("Allocating edit map");
+      charts_edit_close (edit);
+      return (NULL);
+    }
+
+  edit->first_dirty = edit->map_size;
+  edit->last_dirty = -1;
+
+  return (edit);
+}
+
+
+/*  Flushes any changes and closes the file.  Returns the charts_edit_flush status.  */
+
+int32_t charts_edit_close (CHARTS_EDIT_T *edit)
+{
+  int32_t             status = 0;
+
+
+  if (edit == NULL) return (0);
+
+  if (edit->dirty != NULL) status = charts_edit_flush (edit);
+
+  if (edit->map != NULL)
+    {
+#ifdef NVWIN3X
+      free (edit->map);
+#else
+      munmap (edit->map, edit->map_size);
+#endif
+    }
+
+#ifdef NVWIN3X
+  if (edit->fp != NULL) fclose (edit->fp);
+#endif
+
+  free (edit->dirty);
+  free (edit);
+
+  return (status);
+}
+
+
+int32_t charts_edit_num_records (CHARTS_EDIT_T *edit)
+{
+  return (edit->num_records);
+}
+
+
+/*  Gets the byte "offset" bytes into record "num" (counting from 1).  Returns 0 on success or -1 if "num" or
+    "offset" is out of range.  */
+
+int32_t charts_edit_get (CHARTS_EDIT_T *edit, int32_t num, int32_t offset, uint8_t *value)
+{
+  if (num < 1 || num > edit->num_records || offset < 0 || offset >= edit->record_size) return (-1);
+
+  *value = edit->map[edit->head_size + (int64_t) (num - 1) * edit->record_size + offset];
+
+  return (0);
+}
+
+
+/*  Sets the byte "offset" bytes into record "num" (counting from 1) and marks its page dirty if the value changed.
+    Returns 0 on success or -1 if "num" or "offset" is out of range.  */
+
+int32_t charts_edit_put (CHARTS_EDIT_T *edit, int32_t num, int32_t offset, uint8_t value)
+{
+  int64_t             pos, page;
+
+
+  if (num < 1 || num > edit->num_records || offset < 0 || offset >= edit->record_size) return (-1);
+
+  pos = edit->head_size + (int64_t) (num - 1) * edit->record_size + offset;
+
+  if (edit->map[pos] == value) return (0);
+
+  edit->map[pos] = value;
+
+
+  page = pos / edit->page_size;
+
+  if (!(edit->dirty[page / 8] & (1 << (page % 8))))
+    {
+      edit->dirty[page / 8] |= (1 << (page % 8));
+      edit->num_dirty++;
+
+      edit->first_dirty = MIN (edit->first_dirty, page);
+      edit->last_dirty = MAX (edit->last_dirty, page);
+    }
+
+  return (0);
+}
+
+
+/*  Number of pages changed since the last flush.  */
+
+int32_t charts_edit_dirty_pages (CHARTS_EDIT_T *edit)
+{
+  return (edit->num_dirty);
+}
+
+
+/*  Writes the changed pages back to the file.  Returns 0 on success or -1 on failure.  */
+
+int32_t charts_edit_flush (CHARTS_EDIT_T *edit)
+{
+  int64_t             start, length;
+#ifdef NVWIN3X
+  int64_t             page, run;
+#endif
+
+
+  if (!edit->num_dirty) return (0);
+
+
+#ifdef NVWIN3X
+
+  /*  One write per run of dirty pages.  */
+
+  for (page = edit->first_dirty ; page <= edit->last_dirty ; page += run)
+    {
+      for (run = 0 ; page + run <= edit->last_dirty && (edit->dirty[(page + run) / 8] & (1 << ((page + run) % 8))) ; run++);
+
+      if (!run)
+        {
+          run = 1;
+          continue;
+        }
+
+      start = page * edit->page_size;
+      length = MIN (run * edit->page_size, edit->map_size - start);
+
+      if (fseeko64 (edit->fp, start, SEEK_SET) || fwrite (edit->map + start, length, 1, edit->fp) != 1)
+        {
+          perror ("Writing edits");
+          return (-1);
+        }
+    }
+
+  if (fflush (edit->fp))
+    {
+      perror ("Writing edits");
+      return (-1);
+    }
+
+#else
+
+  /*  The kernel only writes the pages that were actually modified, so one msync over the whole dirty span is all
+      we need.  */
+
+  start = edit->first_dirty * edit->page_size;
+  length = MIN ((edit->last_dirty - edit->first_dirty + 1) * edit->page_size, edit->map_size - start);
+
+  if (msync (edit->map + start, length, MS_SYNC))
+    {
+      perror ("Writing edits");
+      return (-1);
+    }
+
+#endif
+
+
+  memset (edit->dirty + edit->first_dirty / 8, 0, edit->last_dirty / 8 - edit->first_dirty / 8 + 1);
+
+  edit->first_dirty = edit->map_size;
+  edit->last_dirty = -1;
+  edit->num_dirty = 0;
+
+  return (0);
+}
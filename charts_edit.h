@@ -0,0 +1,69 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_edit.h   Header
+ *
+ * Purpose:        In place editing of single byte record fields (status
+ *                 flags and the like) in fixed record size files.  The file
+ *                 is mapped read/write and only the pages holding changed
+ *                 bytes are marked dirty.  charts_edit_flush writes them
+ *                 back with a single msync (or, on Windows where the file is
+ *                 read into memory, one write per run of dirty pages).
+ *                 Single byte fields don't need byte swapping so this works
+ *                 on files of either endianness.  See charts_hof_edit_open
+ *                 and charts_tof_edit_open for the typed versions.
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_EDIT_H__
+#define __CHARTS_EDIT_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "charts.h"
+
+
+  typedef struct CHARTS_EDIT CHARTS_EDIT_T;
+
+
+  CHARTS_EDIT_T *charts_edit_open (char *path, int64_t head_size, int32_t record_size);
+  int32_t charts_edit_close (CHARTS_EDIT_T *edit);
+  int32_t charts_edit_num_records (CHARTS_EDIT_T *edit);
+  int32_t charts_edit_get (CHARTS_EDIT_T *edit, int32_t num, int32_t offset, uint8_t *value);
+  int32_t charts_edit_put (CHARTS_EDIT_T *edit, int32_t num, int32_t offset, uint8_t value);
+  int32_t charts_edit_dirty_pages (CHARTS_EDIT_T *edit);
+  int32_t charts_edit_flush (CHARTS_EDIT_T *edit);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,629 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include "charts_georef.h"
+#include "charts_pool.h"
+#include "FileHydroOutput.h"
+#include "FileTopoOutput.h"
+#include "FilePOSOutput.h"
+
+#ifndef NV_RAD_TO_DEG
+  #define       NV_RAD_TO_DEG   57.2957795147195L
+#endif
+
+
+/*  Each thread opens its own handles to the line and the SBET(s) the first time it gets a chunk and keeps its own
+    buffers, so the only thing the threads share is the output (and every chunk has its own part of that).  */
+
+typedef struct
+{
+  void                 *line;
+  CHARTS_POS_T         *new_nav;
+  CHARTS_POS_T         *old_nav;
+  void                 *buffer;
+  int64_t              *timestamps;
+  POS_OUTPUT_T         *new_pos;
+  POS_OUTPUT_T         *old_pos;
+} GEOREF_THREAD_T;
+
+
+typedef struct
+{
+  char                 *path;
+  int32_t              type;
+  char                 *new_sbet;
+  char                 *old_sbet;             /*  NULL when we're only filling "nav".  */
+  int32_t              chunk_records;
+  int32_t              num_records;
+  int32_t              first_chunk;           /*  Chunk number of task 0 of the current run.  */
+  uint8_t              *records;              /*  Shifted records, "chunk_records" for each task of the run.  */
+  int32_t              *counts;               /*  Records done by each task of the run, -1 on failure.  */
+  int32_t              *shifted;              /*  Shots moved by each task of the run.  */
+  CHARTS_GEOREF_NAV_T  *nav;
+  GEOREF_THREAD_T      *threads;
+} GEOREF_JOB_T;
+
+
+static size_t georef_size (int32_t type)
+{
+  return ((type == CHARTS_SCAN_HOF) ? sizeof (HYDRO_OUTPUT_T) : sizeof (TOPO_OUTPUT_T));
+}
+
+
+static void *georef_open_line (int32_t type, char *path)
+{
+  if (type == CHARTS_SCAN_HOF) return ((void *) charts_hof_open (path));
+
+  return ((void *) charts_tof_open (path));
+}
+
+
+static void georef_close_line (int32_t type, void *line)
+{
+  if (line == NULL) return;
+
+  if (type == CHARTS_SCAN_HOF)
+    {
+      charts_hof_close ((CHARTS_HOF_T *) line);
+    }
+  else
+    {
+      charts_tof_close ((CHARTS_TOF_T *) line);
+    }
+}
+
+
+/*  charts_pos_interp_batch zero fills the shots it can't do.  */
+
+static uint8_t georef_valid (CHARTS_POS_T *nav, int64_t timestamp, POS_OUTPUT_T *pos)
+{
+  return (timestamp >= charts_pos_get_start_timestamp (nav) && timestamp <= charts_pos_get_end_timestamp (nav) &&
+          (pos->latitude != 0.0 || pos->longitude != 0.0));
+}
+
+
+static double georef_lon (double lon)
+{
+  if (lon > 180.0) lon -= 360.0;
+  if (lon < -180.0) lon += 360.0;
+
+  return (lon);
+}
+
+
+static void georef_move (double *lat, double *lon, double dlat, double dlon)
+{
+  if (*lat == 0.0 && *lon == 0.0) return;
+
+  *lat += dlat;
+  *lon = georef_lon (*lon + dlon);
+}
+
+
+static void georef_lift (float *elev, float dalt)
+{
+  if (*elev > -998.0) *elev += dalt;
+}
+
+
+/*  Moves a shot by the difference between where the new and the old SBET put the platform at the time of the shot.
+    Elevations (everything in a TOF, KGPS shots in a HOF) move with the platform altitude.  DGPS depths are measured
+    from the water surface so they stay put.  The lever arm effect of the attitude changes is not modeled.  */
+
+static void georef_shift_hof (HYDRO_OUTPUT_T *record, double dlat, double dlon, float dalt)
+{
+  georef_move (&record->latitude, &record->longitude, dlat, dlon);
+  georef_move (&record->sec_latitude, &record->sec_longitude, dlat, dlon);
+
+  georef_lift (&record->altitude, dalt);
+
+  if (record->data_type == 1)
+    {
+      georef_lift (&record->correct_depth, dalt);
+      georef_lift (&record->correct_sec_depth, dalt);
+      georef_lift (&record->kgps_elevation, dalt);
+      georef_lift (&record->kgps_res_elev, dalt);
+      georef_lift (&record->kgps_sec_elev, dalt);
+      georef_lift (&record->kgps_topo, dalt);
+    }
+}
+
+
+static void georef_shift_tof (TOPO_OUTPUT_T *record, double dlat, double dlon, float dalt)
+{
+  georef_move (&record->latitude_first, &record->longitude_first, dlat, dlon);
+  georef_move (&record->latitude_last, &record->longitude_last, dlat, dlon);
+
+  georef_lift (&record->elevation_first, dalt);
+  georef_lift (&record->elevation_last, dalt);
+  georef_lift (&record->result_elevation_first, dalt);
+  georef_lift (&record->result_elevation_last, dalt);
+  georef_lift (&record->altitude, dalt);
+}
+
+
+static int32_t georef_thread_open (GEOREF_JOB_T *job, GEOREF_THREAD_T *state)
+{
+  size_t               n = (size_t) job->chunk_records;
+
+
+  if (state->line == NULL && (state->line = georef_open_line (job->type, job->path)) == NULL) return (-1);
+
+  if (state->new_nav == NULL && (state->new_nav = charts_pos_open (job->new_sbet)) == NULL) return (-1);
+
+  if (job->old_sbet != NULL && state->old_nav == NULL && (state->old_nav = charts_pos_open (job->old_sbet)) == NULL)
+    return (-1);
+
+
+  if ((job->records == NULL && state->buffer == NULL && (state->buffer = malloc (n * georef_size (job->type))) == NULL) ||
+      (state->timestamps == NULL && (state->timestamps = (int64_t *) malloc (n * sizeof (int64_t))) == NULL) ||
+      (state->new_pos == NULL && (state->new_pos = (POS_OUTPUT_T *) malloc (n * sizeof (POS_OUTPUT_T))) == NULL) ||
+      (job->old_sbet != NULL && state->old_pos == NULL &&
+       (state->old_pos = (POS_OUTPUT_T *) malloc (n * sizeof (POS_OUTPUT_T))) == NULL))
+    {
+      perror ("Allocating georef buffers");
+      return (-1);
+    }
+
+  return (0);
+}
+
+
+static void georef_chunk (int32_t task, int32_t thread, void *user)
+{
+  GEOREF_JOB_T         *job = (GEOREF_JOB_T *) user;
+  GEOREF_THREAD_T      *state = &job->threads[thread];
+  CHARTS_GEOREF_NAV_T  *nav = job->nav;
+  POS_OUTPUT_T         *pos;
+  void                 *records;
+  int32_t              first, count, ret, i, j, n = 0;
+  double               heading;
+
+
+  job->counts[task] = -1;
+
+  first = (job->first_chunk + task) * job->chunk_records + 1;
+  count = MIN (job->chunk_records, job->num_records - first + 1);
+
+  if (georef_thread_open (job, state)) return;
+
+  records = job->records ? (void *) (job->records + (size_t) task * job->chunk_records * georef_size (job->type)) :
+    state->buffer;
+
+
+  if (job->type == CHARTS_SCAN_HOF)
+    {
+      ret = charts_hof_read_records ((CHARTS_HOF_T *) state->line, first, count, (HYDRO_OUTPUT_T *) records);
+      for (i = 0 ; i < ret ; i++) state->timestamps[i] = ((HYDRO_OUTPUT_T *) records)[i].timestamp;
+    }
+  else
+    {
+      ret = charts_tof_read_records ((CHARTS_TOF_T *) state->line, first, count, (TOPO_OUTPUT_T *) records);
+      for (i = 0 ; i < ret ; i++) state->timestamps[i] = ((TOPO_OUTPUT_T *) records)[i].timestamp;
+    }
+
+  if (ret != count) return;
+
+
+  /*  The shots are in time order so this is one sweep through the SBET per chunk.  */
+
+  if (charts_pos_interp_batch (state->new_nav, state->timestamps, ret, state->new_pos) < 0) return;
+
+
+  if (nav != NULL)
+    {
+      for (i = 0 ; i < ret ; i++)
+        {
+          j = first - 1 + i;
+          pos = &state->new_pos[i];
+
+          nav->timestamp[j] = state->timestamps[i];
+          nav->valid[j] = georef_valid (state->new_nav, state->timestamps[i], pos);
+
+          if (!nav->valid[j]) continue;
+
+          heading = fmod ((pos->platform_heading - pos->wander_angle) * NV_RAD_TO_DEG, 360.0);
+          if (heading < 0.0) heading += 360.0;
+
+          nav->latitude[j] = pos->latitude * NV_RAD_TO_DEG;
+          nav->longitude[j] = georef_lon (pos->longitude * NV_RAD_TO_DEG);
+          nav->altitude[j] = pos->altitude;
+          nav->roll[j] = (float) (pos->roll * NV_RAD_TO_DEG);
+          nav->pitch[j] = (float) (pos->pitch * NV_RAD_TO_DEG);
+          nav->heading[j] = (float) heading;
+          n++;
+        }
+    }
+  else
+    {
+      if (charts_pos_interp_batch (state->old_nav, state->timestamps, ret, state->old_pos) < 0) return;
+
+      for (i = 0 ; i < ret ; i++)
+        {
+          if (!georef_valid (state->new_nav, state->timestamps[i], &state->new_pos[i]) ||
+              !georef_valid (state->old_nav, state->timestamps[i], &state->old_pos[i])) continue;
+
+          if (job->type == CHARTS_SCAN_HOF)
+            {
+              georef_shift_hof (&((HYDRO_OUTPUT_T *) records)[i],
+                                (state->new_pos[i].latitude - state->old_pos[i].latitude) * NV_RAD_TO_DEG,
+                                georef_lon ((state->new_pos[i].longitude - state->old_pos[i].longitude) * NV_RAD_TO_DEG),
+                                (float) (state->new_pos[i].altitude - state->old_pos[i].altitude));
+            }
+          else
+            {
+              georef_shift_tof (&((TOPO_OUTPUT_T *) records)[i],
+                                (state->new_pos[i].latitude - state->old_pos[i].latitude) * NV_RAD_TO_DEG,
+                                georef_lon ((state->new_pos[i].longitude - state->old_pos[i].longitude) * NV_RAD_TO_DEG),
+                                (float) (state->new_pos[i].altitude - state->old_pos[i].altitude));
+            }
+          n++;
+        }
+    }
+
+
+  job->shifted[task] = n;
+  job->counts[task] = ret;
+}
+
+
+/*  Counts the shots in the line, makes sure the SBET(s) can be opened and starts the pool.  Returns NULL on
+    failure.  */
+
+static CHARTS_POOL_T *georef_start (GEOREF_JOB_T *job, int32_t chunk_records, int32_t num_threads)
+{
+  CHARTS_POOL_T        *pool;
+  CHARTS_POS_T         *nav;
+  void                 *line;
+
+
+  job->chunk_records = (chunk_records > 0) ? chunk_records : CHARTS_GEOREF_CHUNK;
+
+  if ((line = georef_open_line (job->type, job->path)) == NULL) return (NULL);
+
+  job->num_records = (job->type == CHARTS_SCAN_HOF) ? charts_hof_num_records ((CHARTS_HOF_T *) line) :
+    charts_tof_num_records ((CHARTS_TOF_T *) line);
+
+  georef_close_line (job->type, line);
+
+  if (job->num_records <= 0)
+    {
+      fprintf (stderr, "No shots in %s\n", job->path);
+      fflush (stderr);
+      return (NULL);
+    }
+
+
+  if ((nav = charts_pos_open (job->new_sbet)) == NULL)
+    {
+      fprintf (stderr, "Unable to open SBET file %s\n", job->new_sbet);
+      fflush (stderr);
+      return (NULL);
+    }
+  charts_pos_close (nav);
+
+  if (job->old_sbet != NULL)
+    {
+      if ((nav = charts_pos_open (job->old_sbet)) == NULL)
+        {
+          fprintf (stderr, "Unable to open SBET file %s\n", job->old_sbet);
+          fflush (stderr);
+          return (NULL);
+        }
+      charts_pos_close (nav);
+    }
+
+
+  if ((pool = charts_pool_open (num_threads)) == NULL) return (NULL);
+
+  if ((job->threads = (GEOREF_THREAD_T *) calloc (charts_pool_threads (pool), sizeof (GEOREF_THREAD_T))) == NULL)
+    {
+      perror ("Allocating georef threads");
+      charts_pool_close (pool);
+      return (NULL);
+    }
+
+  return (pool);
+}
+
+
+static void georef_finish (GEOREF_JOB_T *job, CHARTS_POOL_T *pool)
+{
+  GEOREF_THREAD_T      *state;
+  int32_t              i;
+
+
+  for (i = 0 ; i < charts_pool_threads (pool) ; i++)
+    {
+      state = &job->threads[i];
+
+      georef_close_line (job->type, state->line);
+      if (state->new_nav != NULL) charts_pos_close (state->new_nav);
+      if (state->old_nav != NULL) charts_pos_close (state->old_nav);
+
+      free (state->buffer);
+      free (state->timestamps);
+      free (state->new_pos);
+      free (state->old_pos);
+    }
+
+  free (job->threads);
+  free (job->records);
+  free (job->counts);
+  free (job->shifted);
+
+  charts_pool_close (pool);
+}
+
+
+/*  Interpolates the platform position and attitude for every shot of the HOF or TOF file "path" ("type"
+    CHARTS_SCAN_HOF or CHARTS_SCAN_TOF) from "sbet" (the one get_pos_file finds if NULL) using "num_threads"
+    threads (0 for one per CPU) and "chunk_records" shots per chunk (CHARTS_GEOREF_CHUNK if 0 or less).  Free the
+    arrays with charts_georef_free_nav.  Returns the number of shots covered by the SBET or -1 on failure.  */
+
+int32_t charts_georef_nav (char *path, int32_t type, char *sbet, int32_t chunk_records, int32_t num_threads,
+                           CHARTS_GEOREF_NAV_T *nav)
+{
+  GEOREF_JOB_T         job;
+  CHARTS_POOL_T        *pool;
+  char                 pos_file[512];
+  int32_t              i, num_chunks, ret = 0;
+  size_t               n;
+
+
+  memset (nav, 0, sizeof (CHARTS_GEOREF_NAV_T));
+  memset (&job, 0, sizeof (GEOREF_JOB_T));
+
+  if (sbet == NULL)
+    {
+      get_pos_file (path, pos_file);
+      sbet = pos_file;
+    }
+
+  job.path = path;
+  job.type = type;
+  job.new_sbet = sbet;
+  job.nav = nav;
+
+  if ((pool = georef_start (&job, chunk_records, num_threads)) == NULL) return (-1);
+
+
+  num_chunks = (job.num_records - 1) / job.chunk_records + 1;
+  n = (size_t) job.num_records;
+
+  nav->count = job.num_records;
+
+  if ((nav->timestamp = (int64_t *) malloc (n * sizeof (int64_t))) == NULL ||
+      (nav->latitude = (double *) calloc (n, sizeof (double))) == NULL ||
+      (nav->longitude = (double *) calloc (n, sizeof (double))) == NULL ||
+      (nav->altitude = (double *) calloc (n, sizeof (double))) == NULL ||
+      (nav->roll = (float *) calloc (n, sizeof (float))) == NULL ||
+      (nav->pitch = (float *) calloc (n, sizeof (float))) == NULL ||
+      (nav->heading = (float *) calloc (n, sizeof (float))) == NULL ||
+      (nav->valid = (uint8_t *) calloc (n, sizeof (uint8_t))) == NULL ||
+      (job.counts = (int32_t *) calloc (num_chunks, sizeof (int32_t))) == NULL ||
+      (job.shifted = (int32_t *) calloc (num_chunks, sizeof (int32_t))) == NULL)
+    {
+      perror ("Allocating georef nav");
+      georef_finish (&job, pool);
+      charts_georef_free_nav (nav);
+      return (-1);
+    }
+
+
+  charts_pool_run (pool, num_chunks, georef_chunk, &job);
+
+
+  for (i = 0 ; i < num_chunks ; i++)
+    {
+      if (job.counts[i] < 0)
+        {
+          ret = -1;
+          break;
+        }
+
+      ret += job.shifted[i];
+    }
+
+  georef_finish (&job, pool);
+
+  if (ret < 0) charts_georef_free_nav (nav);
+
+  return (ret);
+}
+
+
+void charts_georef_free_nav (CHARTS_GEOREF_NAV_T *nav)
+{
+  free (nav->timestamp);
+  free (nav->latitude);
+  free (nav->longitude);
+  free (nav->altitude);
+  free (nav->roll);
+  free (nav->pitch);
+  free (nav->heading);
+  free (nav->valid);
+
+  memset (nav, 0, sizeof (CHARTS_GEOREF_NAV_T));
+}
+
+
+/*  Starts "out_path" with a copy of the header of "path".  The header is copied as is (including its byte order) and
+    the shot count and times are fixed up when the records have been written.  */
+
+static int32_t georef_copy_header (char *path, char *out_path, int32_t size)
+{
+  FILE                 *in, *out;
+  uint8_t              *head;
+  int32_t              ret = -1;
+
+
+  if ((head = (uint8_t *) malloc (size)) == NULL)
+    {
+      perror ("Allocating header");
+      return (-1);
+    }
+
+  if ((in = fopen64 (path, "rb")) == NULL)
+    {
+      perror (path);
+      free (head);
+      return (-1);
+    }
+
+  if ((out = fopen64 (out_path, "wb")) == NULL)
+    {
+      perror (out_path);
+      fclose (in);
+      free (head);
+      return (-1);
+    }
+
+  if (fread (head, size, 1, in) == 1 && fwrite (head, size, 1, out) == 1) ret = 0;
+
+  if (fclose (out)) ret = -1;
+  fclose (in);
+  free (head);
+
+  if (ret) perror (out_path);
+
+  return (ret);
+}
+
+
+/*  Writes a copy of the HOF or TOF file "path" ("type" CHARTS_SCAN_HOF or CHARTS_SCAN_TOF) to "out_path" with every
+    shot moved by the difference between where "new_sbet" and "old_sbet" (the SBET the line was processed with, the
+    one get_pos_file finds if NULL) put the platform at the time of the shot (see georef_shift_hof).  Shots that
+    either SBET doesn't cover are copied as they are.  The chunks are done "num_threads" (0 for one per CPU) at a
+    time, twice over, and written out in order.  Returns the number of shots moved or -1 on failure.  */
+
+int32_t charts_georef_file (char *path, int32_t type, char *new_sbet, char *old_sbet, char *out_path,
+                            int32_t chunk_records, int32_t num_threads)
+{
+  GEOREF_JOB_T         job;
+  CHARTS_POOL_T        *pool;
+  CHARTS_HOF_T         *hof = NULL;
+  CHARTS_TOF_T         *tof = NULL;
+  CHARTS_HOF_APPEND_T  *hof_app = NULL;
+  CHARTS_TOF_APPEND_T  *tof_app = NULL;
+  char                 pos_file[512];
+  uint8_t              *records;
+  int32_t              i, first, num_chunks, tasks, status = 0, moved = 0;
+  size_t               size;
+
+
+  if (!strcmp (path, out_path))
+    {
+      fprintf (stderr, "The output file can't be the input file (%s)\n", path);
+      fflush (stderr);
+      return (-1);
+    }
+
+  memset (&job, 0, sizeof (GEOREF_JOB_T));
+
+  if (old_sbet == NULL)
+    {
+      get_pos_file (path, pos_file);
+      old_sbet = pos_file;
+    }
+
+  job.path = path;
+  job.type = type;
+  job.new_sbet = new_sbet;
+  job.old_sbet = old_sbet;
+
+  if ((pool = georef_start (&job, chunk_records, num_threads)) == NULL) return (-1);
+
+
+  num_chunks = (job.num_records - 1) / job.chunk_records + 1;
+  tasks = charts_pool_threads (pool) * 2;
+  size = georef_size (type);
+
+  if ((job.records = (uint8_t *) malloc ((size_t) tasks * job.chunk_records * size)) == NULL ||
+      (job.counts = (int32_t *) calloc (tasks, sizeof (int32_t))) == NULL ||
+      (job.shifted = (int32_t *) calloc (tasks, sizeof (int32_t))) == NULL)
+    {
+      perror ("Allocating georef buffers");
+      georef_finish (&job, pool);
+      return (-1);
+    }
+
+
+  if (georef_copy_header (path, out_path, (type == CHARTS_SCAN_HOF) ? HOF_HEAD_SIZE : TOF_HEAD_SIZE))
+    {
+      georef_finish (&job, pool);
+      return (-1);
+    }
+
+  if (type == CHARTS_SCAN_HOF)
+    {
+      if ((hof = charts_hof_open (out_path)) == NULL || (hof_app = charts_hof_append_open (hof, 1)) == NULL) status = -1;
+    }
+  else
+    {
+      if ((tof = charts_tof_open (out_path)) == NULL || (tof_app = charts_tof_append_open (tof, 1)) == NULL) status = -1;
+    }
+
+
+  /*  The threads work on the next "tasks" chunks while we're in charts_pool_run, then we write those out.  */
+
+  for (first = 0 ; !status && first < num_chunks ; first += tasks)
+    {
+      job.first_chunk = first;
+
+      charts_pool_run (pool, MIN (tasks, num_chunks - first), georef_chunk, &job);
+
+      for (i = 0 ; i < MIN (tasks, num_chunks - first) ; i++)
+        {
+          if (job.counts[i] < 0)
+            {
+              fprintf (stderr, "Error re-positioning shots %d through %d of %s\n", (first + i) * job.chunk_records + 1,
+                       MIN ((first + i + 1) * job.chunk_records, job.num_records), path);
+              fflush (stderr);
+              status = -1;
+              break;
+            }
+
+          records = job.records + (size_t) i * job.chunk_records * size;
+
+          if ((type == CHARTS_SCAN_HOF && charts_hof_append (hof_app, (HYDRO_OUTPUT_T *) records, job.counts[i])) ||
+              (type == CHARTS_SCAN_TOF && charts_tof_append (tof_app, (TOPO_OUTPUT_T *) records, job.counts[i])))
+            {
+              status = -1;
+              break;
+            }
+
+          moved += job.shifted[i];
+        }
+    }
+
+
+  if (hof_app != NULL && charts_hof_append_close (hof_app)) status = -1;
+  if (tof_app != NULL && charts_tof_append_close (tof_app)) status = -1;
+  if (hof != NULL) charts_hof_close (hof);
+  if (tof != NULL) charts_tof_close (tof);
+
+  georef_finish (&job, pool);
+
+  return (status ? -1 : moved);
+}
@@ -0,0 +1,84 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_georef.h   Header
+ *
+ * Purpose:          Re-positions HOF and TOF shots from a new SBET.  The
+ *                   line is cut into chunks of consecutive shots and each
+ *                   chunk is run on a charts_pool thread with its own file
+ *                   and SBET handles.  The SBET is interpolated for the
+ *                   whole chunk in one forward sweep (see
+ *                   charts_pos_interp_batch) instead of searching for
+ *                   every shot.
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_GEOREF_H__
+#define __CHARTS_GEOREF_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "charts.h"
+#include "charts_scan.h"
+
+
+  /*  Default number of shots per chunk.  */
+
+#define         CHARTS_GEOREF_CHUNK     16384
+
+
+  /*  Platform position and attitude for every shot of a line.  Latitude and longitude are in degrees, altitude
+      is in meters from the ellipsoid, roll, pitch, and heading are in degrees with heading being true heading
+      (platform_heading - wander_angle, 0 to 360).  "valid" is 0 for shots that aren't covered by the SBET.  */
+
+  typedef struct
+  {
+    int32_t     count;
+    int64_t     *timestamp;
+    double      *latitude;
+    double      *longitude;
+    double      *altitude;
+    float       *roll;
+    float       *pitch;
+    float       *heading;
+    uint8_t     *valid;
+  } CHARTS_GEOREF_NAV_T;
+
+
+  int32_t charts_georef_nav (char *path, int32_t type, char *sbet, int32_t chunk_records, int32_t num_threads, CHARTS_GEOREF_NAV_T *nav);
+  void charts_georef_free_nav (CHARTS_GEOREF_NAV_T *nav);
+  int32_t charts_georef_file (char *path, int32_t type, char *new_sbet, char *old_sbet, char *out_path, int32_t chunk_records, int32_t num_threads);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,344 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include <pthread.h>
+
+#include "charts.h"
+
+
+/*  Table driven parsing and writing of the "Key: value" text headers used by the HOF, TOF, image and waveform
+    files.  Each line is split once at the first colon and the key is looked up in a hash of the table's keys
+    (seeded so that none of the keys collide) instead of being strstr'ed against every key we know about.  */
+
+static pthread_mutex_t header_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+static uint32_t header_hash (uint32_t seed, const char *key, int32_t length)
+{
+  uint32_t          hash = 2166136261U ^ seed;
+  int32_t           i;
+
+
+  for (i = 0 ; i < length ; i++)
+    {
+      hash ^= (uint8_t) key[i];
+      hash *= 16777619U;
+    }
+
+  return (hash);
+}
+
+
+/*  Finds a seed (and the smallest power of 2 table size) that puts every key in its own slot.  */
+
+static void header_build (CHARTS_HEADER_TABLE_T *table)
+{
+  uint32_t          size, seed, slot;
+  int32_t           i;
+
+
+  pthread_mutex_lock (&header_mutex);
+
+  if (!table->ready)
+    {
+      for (size = 16 ; size < 2 * (uint32_t) table->num_fields ; size *= 2);
+
+      for ( ; size <= CHARTS_HEADER_MAX_SLOTS ; size *= 2)
+        {
+          for (seed = 0 ; seed < 10000 ; seed++)
+            {
+              for (i = 0 ; i < (int32_t) size ; i++) table->slots[i] = -1;
+
+              for (i = 0 ; i < table->num_fields ; i++)
+                {
+                  slot = header_hash (seed, table->fields[i].key, strlen (table->fields[i].key)) & (size - 1);
+                  if (table->slots[slot] >= 0) break;
+                  table->slots[slot] = i;
+                }
+
+              if (i == table->num_fields) break;
+            }
+
+          if (seed < 10000) break;
+        }
+
+
+      /*  Can't happen with tables the size of ours, but if it did every lookup would just miss.  */
+
+      if (size > CHARTS_HEADER_MAX_SLOTS)
+        {
+          fprintf (stderr, "Unable to hash header table starting with %s\n", table->fields[0].key);
+          fflush (stderr);
+          size = 1;
+          table->slots[0] = -1;
+        }
+
+      table->seed = seed;
+      table->mask = size - 1;
+
+      __sync_synchronize ();
+      table->ready = 1;
+    }
+
+  pthread_mutex_unlock (&header_mutex);
+}
+
+
+/*  Returns the field for the "length" character "key", or NULL if it isn't in the table.  */
+
+const CHARTS_HEADER_FIELD_T *charts_header_lookup (CHARTS_HEADER_TABLE_T *table, const char *key, int32_t length)
+{
+  const CHARTS_HEADER_FIELD_T *field;
+  int16_t           slot;
+
+
+  if (!table->ready) header_build (table);
+  __sync_synchronize ();
+
+  if ((slot = table->slots[header_hash (table->seed, key, length) & table->mask]) < 0) return (NULL);
+
+  field = &table->fields[slot];
+
+  if (strncmp (field->key, key, length) || field->key[length]) return (NULL);
+
+  return (field);
+}
+
+
+/*  Parses one header line and, if the key is in the table, stores the value in the structure at "base".  Leading
+    and trailing blanks are stripped from the key and from string values.  Numeric fields are left alone if the
+    value isn't a number.  Returns the matching field or NULL.  */
+
+const CHARTS_HEADER_FIELD_T *charts_header_parse_line (CHARTS_HEADER_TABLE_T *table, char *line, void *base)
+{
+  const CHARTS_HEADER_FIELD_T *field;
+  char              *colon, *key, *value, *end;
+  int32_t           length;
+  uint8_t           *dest;
+  int64_t           i64;
+  double            f64;
+
+
+  if ((colon = strchr (line, ':')) == NULL) return (NULL);
+
+
+  for (key = line ; *key == ' ' || *key == '\t' ; key++);
+  for (end = colon ; end > key && (end[-1] == ' ' || end[-1] == '\t') ; end--);
+
+  if ((field = charts_header_lookup (table, key, (int32_t) (end - key))) == NULL) return (NULL);
+
+
+  for (value = colon + 1 ; *value == ' ' || *value == '\t' ; value++);
+
+  dest = (uint8_t *) base + field->offset;
+
+  switch (field->type)
+    {
+    case CHARTS_HEADER_STRING:
+      for (end = value + strlen (value) ; end > value && end[-1] == ' ' ; end--);
+      length = MIN ((int32_t) (end - value), (int32_t) field->size - 1);
+      memcpy (dest, value, length);
+      dest[length] = 0;
+      break;
+
+    case CHARTS_HEADER_ENDIAN:
+      *dest = (strstr (value, "Little") != NULL);
+      break;
+
+    case CHARTS_HEADER_FLOAT:
+    case CHARTS_HEADER_DOUBLE:
+      f64 = strtod (value, &end);
+      if (end == value) break;
+
+      if (field->type == CHARTS_HEADER_FLOAT)
+        {
+          *(float *) dest = (float) f64;
+        }
+      else
+        {
+          *(double *) dest = f64;
+        }
+      break;
+
+    default:
+      i64 = strtoll (value, &end, 10);
+      if (end == value) break;
+
+      switch (field->type)
+        {
+        case CHARTS_HEADER_INT8:
+          *(int8_t *) dest = (int8_t) i64;
+          break;
+
+        case CHARTS_HEADER_INT16:
+          *(int16_t *) dest = (int16_t) i64;
+          break;
+
+        case CHARTS_HEADER_INT32:
+          *(int32_t *) dest = (int32_t) i64;
+          break;
+
+        case CHARTS_HEADER_INT64:
+          *(int64_t *) dest = i64;
+          break;
+        }
+      break;
+    }
+
+  return (field);
+}
+
+
+/*  Reads header lines from the current position of "fp" into the structure at "base" until the "EOF" line, the end
+    of the file, or (once it's been read) "*header_size" bytes.  Returns 1 if there was an endian entry, otherwise
+    0.  */
+
+int32_t charts_header_read (FILE *fp, CHARTS_HEADER_TABLE_T *table, void *base, int32_t *header_size)
+{
+  const CHARTS_HEADER_FIELD_T *field;
+  char              varin[1024];
+  int32_t           endian = 0;
+
+
+  char *ngets (char *s, int32_t size, FILE *stream);
+
+
+  while (ngets (varin, sizeof (varin), fp) != NULL)
+    {
+      if (!strcmp (varin, "EOF")) break;
+
+      if ((field = charts_header_parse_line (table, varin, base)) != NULL && field->type == CHARTS_HEADER_ENDIAN) endian = 1;
+
+      if (*header_size && ftello64 (fp) >= *header_size) break;
+    }
+
+  return (endian);
+}
+
+
+/*  Writes every field of the table as a "Key: value" line.  The caller writes the "EOF" line (if any) and pads the
+    text block.  */
+
+void charts_header_write (FILE *fp, CHARTS_HEADER_TABLE_T *table, void *base)
+{
+  const CHARTS_HEADER_FIELD_T *field;
+  uint8_t           *src;
+  int32_t           i;
+
+
+  for (i = 0 ; i < table->num_fields ; i++)
+    {
+      field = &table->fields[i];
+      src = (uint8_t *) base + field->offset;
+
+      switch (field->type)
+        {
+        case CHARTS_HEADER_STRING:
+          fprintf (fp, "%s: %.*s\n", field->key, (int) field->size, (char *) src);
+          break;
+
+        case CHARTS_HEADER_ENDIAN:
+          fprintf (fp, "%s: %s\n", field->key, *src ? "Little" : "Big");
+          break;
+
+        case CHARTS_HEADER_INT8:
+          fprintf (fp, "%s: %d\n", field->key, *(int8_t *) src);
+          break;
+
+        case CHARTS_HEADER_INT16:
+          fprintf (fp, "%s: %d\n", field->key, *(int16_t *) src);
+          break;
+
+        case CHARTS_HEADER_INT32:
+          fprintf (fp, "%s: %d\n", field->key, *(int32_t *) src);
+          break;
+
+        case CHARTS_HEADER_INT64:
+          fprintf (fp, "%s: %"PRId64"\n", field->key, *(int64_t *) src);
+          break;
+
+        case CHARTS_HEADER_FLOAT:
+          fprintf (fp, "%s: %.3f\n", field->key, *(float *) src);
+          break;
+
+        case CHARTS_HEADER_DOUBLE:
+          fprintf (fp, "%s: %.11f\n", field->key, *(double *) src);
+          break;
+        }
+    }
+}
+
+
+/*  Replaces the value of the "key" line in the ASCII header text "block" ("size" bytes, NUL padded) with "value",
+    moving the rest of the text up or down as needed.  Everything else, including keys we don't know about, is left
+    as it was.  Returns 0 on success or -1 if there's no "key" line before "EOF" or no room for the new value.  */
+
+int32_t charts_header_patch (char *block, int32_t size, const char *key, const char *value)
+{
+  char              *line, *end, *colon, *name;
+  int32_t           key_length, used, old_length, new_length;
+
+
+  key_length = strlen (key);
+
+  for (used = 0 ; used < size && block[used] ; used++);
+
+
+  for (line = block ; line < block + used ; line = end + 1)
+    {
+      if ((end = memchr (line, '\n', block + used - line)) == NULL) end = block + used;
+
+      if (end - line >= 3 && !strncmp (line, "EOF", 3) && (end - line == 3 || line[3] == '\r')) break;
+
+      if ((colon = memchr (line, ':', end - line)) == NULL) continue;
+
+      for (name = line ; name < colon && (*name == ' ' || *name == '\t') ; name++);
+
+      if (strncmp (name, key, key_length)) continue;
+
+      for (name += key_length ; name < colon && (*name == ' ' || *name == '\t') ; name++);
+
+      if (name != colon) continue;
+
+
+      /*  Replace everything after the colon (up to the \r or \n) with " value".  */
+
+      if (end > colon + 1 && end[-1] == '\r') end--;
+
+      old_length = end - (colon + 1);
+      new_length = strlen (value) + 1;
+
+      if (used - old_length + new_length >= size) return (-1);
+
+      memmove (colon + 1 + new_length, end, block + used - end);
+      colon[1] = ' ';
+      memcpy (colon + 2, value, new_length - 1);
+
+      used += new_length - old_length;
+      memset (block + used, 0, size - used);
+
+      return (0);
+    }
+
+  return (-1);
+}
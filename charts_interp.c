@@ -0,0 +1,193 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include "charts.h"
+
+#ifndef M_PI
+  #define M_PI          3.14159265358979323846
+#endif
+
+
+/*  Linear and cubic Hermite interpolation between two records made of doubles with the time first (POS_OUTPUT_T,
+    RMS_OUTPUT_T), used by pos_io.c and rms_io.c.  The Hermite tangents are central differences of the neighbouring
+    records, not the velocities and angular rates that POS_OUTPUT_T carries.  Those are in the wander and body
+    frames, not in the terms of the fields being interpolated (latitude and longitude in radians, heading and the
+    other attitude angles), so they can't be used as slopes as they are.  RMS records have no rates at all.  */
+
+
+/*  How an interpolated angle is put back in range (see interp_range).  */
+
+#define INTERP_NO_WRAP      0
+#define INTERP_SIGNED       1
+#define INTERP_UNSIGNED     2
+
+
+/*  Moves "angle" by whole turns so it is within PI of "ref".  */
+
+static double interp_near (double angle, double ref)
+{
+  while (angle - ref > M_PI) angle -= 2.0 * M_PI;
+  while (angle - ref < -M_PI) angle += 2.0 * M_PI;
+
+  return (angle);
+}
+
+
+/*  The records don't say whether their angles run from -PI to PI or 0 to 2PI so we go by the two values we're
+    interpolating between.  If neither one gives it away they're both in 0 to PI and there's nothing to fix.  */
+
+static uint8_t interp_convention (double y1, double y2)
+{
+  if (y1 < 0.0 || y2 < 0.0) return (INTERP_SIGNED);
+  if (y1 > M_PI || y2 > M_PI) return (INTERP_UNSIGNED);
+
+  return (INTERP_NO_WRAP);
+}
+
+
+static double interp_range (double angle, uint8_t convention)
+{
+  if (convention == INTERP_SIGNED)
+    {
+      if (angle > M_PI) angle -= 2.0 * M_PI;
+      if (angle <= -M_PI) angle += 2.0 * M_PI;
+    }
+  else if (convention == INTERP_UNSIGNED)
+    {
+      if (angle < 0.0) angle += 2.0 * M_PI;
+      if (angle >= 2.0 * M_PI) angle -= 2.0 * M_PI;
+    }
+
+  return (angle);
+}
+
+
+/*  Straight line interpolation between "prev" and "next" at time "t" of the fields in "mask" (bit n is field n + 1,
+    the time being field 0) of a record of "num_fields" doubles after the time.  The fields in "angles" go the short
+    way around.  Fields not in "mask" are left alone.  */
+
+void charts_interp_linear (const double *prev, const double *next, double t, uint32_t mask, uint32_t angles,
+                           int32_t num_fields, double *out)
+{
+  double           f, y2;
+  uint32_t         bit;
+  int32_t          i;
+
+
+  f = (t - prev[0]) / (next[0] - prev[0]);
+
+  out[0] = t;
+
+  for (i = 1, bit = 1 ; i <= num_fields ; i++, bit <<= 1)
+    {
+      if (!(mask & bit)) continue;
+
+      if (angles & bit)
+        {
+          y2 = interp_near (next[i], prev[i]);
+          out[i] = interp_range (prev[i] + (y2 - prev[i]) * f, interp_convention (prev[i], next[i]));
+        }
+      else
+        {
+          out[i] = prev[i] + (next[i] - prev[i]) * f;
+        }
+    }
+}
+
+
+/*  Sets up "seg" for cubic Hermite interpolation between "prev" and "next".  The tangents are central differences
+    using "before" (the record before "prev") and "after" (the record after "next").  Either one may be NULL (start or
+    end of the file) in which case that end gets the slope of the segment itself.  A neighbor more than four segments
+    away (a gap in the data) is treated the same way.  "mask", "angles" and "num_fields" are as in
+    charts_interp_linear.  */
+
+void charts_interp_segment (CHARTS_INTERP_SEGMENT_T *seg, const double *before, const double *prev, const double *next,
+                            const double *after, uint32_t mask, uint32_t angles, int32_t num_fields)
+{
+  double           h, y0, y1, y2, y3, m1, m2;
+  uint32_t         bit;
+  int32_t          i, k;
+
+
+  memset (seg, 0, sizeof (CHARTS_INTERP_SEGMENT_T));
+
+  h = next[0] - prev[0];
+
+  seg->t1 = prev[0];
+  seg->h = h;
+
+  if (before != NULL && (prev[0] - before[0] <= 0.0 || prev[0] - before[0] > 4.0 * h)) before = NULL;
+  if (after != NULL && (after[0] - next[0] <= 0.0 || after[0] - next[0] > 4.0 * h)) after = NULL;
+
+
+  for (i = 1, bit = 1 ; i <= num_fields && seg->count < CHARTS_INTERP_MAX_FIELDS ; i++, bit <<= 1)
+    {
+      if (!(mask & bit)) continue;
+
+      y1 = prev[i];
+      y2 = next[i];
+      y0 = before ? before[i] : y1;
+      y3 = after ? after[i] : y2;
+
+      k = seg->count++;
+      seg->field[k] = i;
+
+      if (angles & bit)
+        {
+          y2 = interp_near (y2, y1);
+          y0 = interp_near (y0, y1);
+          y3 = interp_near (y3, y2);
+          seg->wrap[k] = interp_convention (prev[i], next[i]);
+        }
+
+
+      /*  Tangents scaled to the segment (dy/ds).  */
+
+      m1 = before ? (y2 - y0) / (next[0] - before[0]) * h : y2 - y1;
+      m2 = after ? (y3 - y1) / (after[0] - prev[0]) * h : y2 - y1;
+
+      seg->a[k] = y1;
+      seg->b[k] = m1;
+      seg->c[k] = 3.0 * (y2 - y1) - 2.0 * m1 - m2;
+      seg->d[k] = 2.0 * (y1 - y2) + m1 + m2;
+    }
+}
+
+
+/*  Evaluates the segment set up by charts_interp_segment at time "t" into "out".  Fields that aren't being
+    interpolated are left alone.  */
+
+void charts_interp_eval (const CHARTS_INTERP_SEGMENT_T *seg, double t, double *out)
+{
+  double           y[CHARTS_INTERP_MAX_FIELDS], s;
+  int32_t          i;
+
+
+  s = (seg->h > 0.0) ? (t - seg->t1) / seg->h : 0.0;
+
+  for (i = 0 ; i < CHARTS_INTERP_MAX_FIELDS ; i++) y[i] = seg->a[i] + s * (seg->b[i] + s * (seg->c[i] + s * seg->d[i]));
+
+  out[0] = t;
+
+  for (i = 0 ; i < seg->count ; i++) out[seg->field[i]] = seg->wrap[i] ? interp_range (y[i], seg->wrap[i]) : y[i];
+}
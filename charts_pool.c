@@ -0,0 +1,290 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include <pthread.h>
+
+#include "charts_pool.h"
+
+
+/*  The part of the current job's tasks a thread still has to do, tasks "head" through "tail" - 1.  The owner takes
+    from the head (so it walks its share in order), thieves take from the tail.  "generation" is the job the tasks
+    belong to so a worker that is late leaving the last job can't take tasks from this one.  */
+
+typedef struct
+{
+  pthread_mutex_t  mutex;
+  uint32_t         generation;
+  int32_t          head;
+  int32_t          tail;
+} POOL_SHARE_T;
+
+
+struct CHARTS_POOL
+{
+  int32_t          num_threads;
+  pthread_t        *threads;
+  POOL_SHARE_T     *shares;
+
+  pthread_mutex_t  mutex;
+  pthread_cond_t   start;           /*  Signalled when a job is posted (or we're shutting down).  */
+  pthread_cond_t   done;            /*  Signalled when the last task of a job finishes.  */
+  uint32_t         generation;      /*  Bumped for every job so the workers can tell a new one from a spurious wakeup.  */
+  uint8_t          quit;
+  int32_t          remaining;       /*  Tasks of the current job not finished yet.  */
+  CHARTS_POOL_FUNC func;
+  void             *user;
+};
+
+
+typedef struct
+{
+  CHARTS_POOL_T    *pool;
+  int32_t          thread;
+} POOL_WORKER_T;
+
+
+/*  Gets the next task of job "generation" for "thread", from its own share if there's anything left there, otherwise
+    stolen from the end of another thread's share.  Returns -1 when there's nothing left anywhere.  */
+
+static int32_t pool_next_task (CHARTS_POOL_T *pool, int32_t thread, uint32_t generation)
+{
+  int32_t          i, victim, task = -1;
+  POOL_SHARE_T     *share;
+
+
+  share = &pool->shares[thread];
+
+  pthread_mutex_lock (&share->mutex);
+  if (share->generation == generation && share->head < share->tail) task = share->head++;
+  pthread_mutex_unlock (&share->mutex);
+
+  if (task >= 0) return (task);
+
+
+  for (i = 1 ; i < pool->num_threads ; i++)
+    {
+      victim = (thread + i) % pool->num_threads;
+      share = &pool->shares[victim];
+
+      pthread_mutex_lock (&share->mutex);
+      if (share->generation == generation && share->head < share->tail) task = --share->tail;
+      pthread_mutex_unlock (&share->mutex);
+
+      if (task >= 0) return (task);
+    }
+
+  return (-1);
+}
+
+
+static void *pool_worker (void *arg)
+{
+  POOL_WORKER_T    *worker = (POOL_WORKER_T *) arg;
+  CHARTS_POOL_T    *pool = worker->pool;
+  uint32_t         generation = 0;
+  int32_t          task, finished;
+  CHARTS_POOL_FUNC func;
+  void             *user;
+
+
+  while (1)
+    {
+      pthread_mutex_lock (&pool->mutex);
+      while (!pool->quit && pool->generation == generation) pthread_cond_wait (&pool->start, &pool->mutex);
+
+      if (pool->quit)
+        {
+          pthread_mutex_unlock (&pool->mutex);
+          break;
+        }
+
+      generation = pool->generation;
+      func = pool->func;
+      user = pool->user;
+      pthread_mutex_unlock (&pool->mutex);
+
+
+      finished = 0;
+      while ((task = pool_next_task (pool, worker->thread, generation)) >= 0)
+        {
+          (*func) (task, worker->thread, user);
+          finished++;
+        }
+
+
+      if (finished)
+        {
+          pthread_mutex_lock (&pool->mutex);
+          pool->remaining -= finished;
+          if (!pool->remaining) pthread_cond_signal (&pool->done);
+          pthread_mutex_unlock (&pool->mutex);
+        }
+    }
+
+  free (worker);
+
+  return (NULL);
+}
+
+
+/*  Starts "num_threads" worker threads (the number of online CPUs if "num_threads" is 0 or less).  Returns NULL on
+    failure.  */
+
+CHARTS_POOL_T *charts_pool_open (int32_t num_threads)
+{
+  CHARTS_POOL_T    *pool;
+  POOL_WORKER_T    *worker;
+  int32_t          i;
+
+
+  if (num_threads <= 0)
+    {
+#ifdef NVWIN3X
+      num_threads = getenv ("NUMBER_OF_PROCESSORS") ? atoi (getenv ("NUMBER_OF_PROCESSORS")) : 1;
+#else
+      num_threads = (int32_t) sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+      if (num_threads <= 0) num_threads = 1;
+    }
+
+
+  if ((pool = (CHARTS_POOL_T *) calloc (1, sizeof (CHARTS_POOL_T))) == NULL ||
+      (pool->threads = (pthread_t *) calloc (num_threads, sizeof (pthread_t))) == NULL ||
+      (pool->shares = (POOL_SHARE_T *) calloc (num_threads, sizeof (POOL_SHARE_T))) == NULL)
+    {
+      perror ("Allocating thread pool");
+      if (pool) free (pool->threads);
+      free (pool);
+      return (NULL);
+    }
+
+  pthread_mutex_init (&pool->mutex, NULL);
+  pthread_cond_init (&pool->start, NULL);
+  pthread_cond_init (&pool->done, NULL);
+
+  for (i = 0 ; i < num_threads ; i++) pthread_mutex_init (&pool->shares[i].mutex, NULL);
+
+
+  for (i = 0 ; i < num_threads ; i++)
+    {
+      if ((worker = (POOL_WORKER_T *) malloc (sizeof (POOL_WORKER_T))) == NULL) break;
+
+      worker->pool = pool;
+      worker->thread = i;
+
+      if (pthread_create (&pool->threads[i], NULL, pool_worker, worker))
+        {
+          free (worker);
+          break;
+        }
+
+      pool->num_threads++;
+    }
+
+
+  /*  Couldn't start any threads at all.  */
+
+  if (!pool->num_threads)
+    {
+      perror ("Starting thread pool");
+      charts_pool_close (pool);
+      return (NULL);
+    }
+
+  return (pool);
+}
+
+
+/*  Stops the threads and frees the pool.  Don't call this while charts_pool_run is running.  */
+
+void charts_pool_close (CHARTS_POOL_T *pool)
+{
+  int32_t          i;
+
+
+  if (pool == NULL) return;
+
+  pthread_mutex_lock (&pool->mutex);
+  pool->quit = 1;
+  pthread_cond_broadcast (&pool->start);
+  pthread_mutex_unlock (&pool->mutex);
+
+  for (i = 0 ; i < pool->num_threads ; i++) pthread_join (pool->threads[i], NULL);
+
+  for (i = 0 ; i < pool->num_threads ; i++) pthread_mutex_destroy (&pool->shares[i].mutex);
+
+  pthread_mutex_destroy (&pool->mutex);
+  pthread_cond_destroy (&pool->start);
+  pthread_cond_destroy (&pool->done);
+
+  free (pool->shares);
+  free (pool->threads);
+  free (pool);
+}
+
+
+int32_t charts_pool_threads (CHARTS_POOL_T *pool)
+{
+  return (pool->num_threads);
+}
+
+
+/*  Runs "func" for tasks 0 through "num_tasks" - 1 on the pool's threads and waits for all of them to finish.  Only
+    one charts_pool_run at a time per pool.  */
+
+void charts_pool_run (CHARTS_POOL_T *pool, int32_t num_tasks, CHARTS_POOL_FUNC func, void *user)
+{
+  int32_t          i;
+
+
+  if (num_tasks <= 0) return;
+
+
+  /*  The job is posted all at once under the pool mutex so no worker can see the new shares with the old "func",
+      "user", or "remaining".  */
+
+  pthread_mutex_lock (&pool->mutex);
+
+  pool->func = func;
+  pool->user = user;
+  pool->remaining = num_tasks;
+  pool->generation++;
+
+
+  /*  Deal the tasks out in contiguous shares (neighbouring tasks tend to touch neighbouring data).  */
+
+  for (i = 0 ; i < pool->num_threads ; i++)
+    {
+      pthread_mutex_lock (&pool->shares[i].mutex);
+      pool->shares[i].generation = pool->generation;
+      pool->shares[i].head = (int32_t) ((int64_t) num_tasks * i / pool->num_threads);
+      pool->shares[i].tail = (int32_t) ((int64_t) num_tasks * (i + 1) / pool->num_threads);
+      pthread_mutex_unlock (&pool->shares[i].mutex);
+    }
+
+  pthread_cond_broadcast (&pool->start);
+
+  while (pool->remaining) pthread_cond_wait (&pool->done, &pool->mutex);
+
+  pthread_mutex_unlock (&pool->mutex);
+}
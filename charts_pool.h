@@ -0,0 +1,68 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_pool.h   Header
+ *
+ * Purpose:        A small, reusable pthread work pool.  Each call to
+ *                 charts_pool_run hands out task numbers 0 through
+ *                 num_tasks - 1.  Every thread starts on its own
+ *                 contiguous share and steals from the far end of the
+ *                 other threads' shares when it runs out, so uneven tasks
+ *                 still keep all of the threads busy.
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_POOL_H__
+#define __CHARTS_POOL_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "charts.h"
+
+
+  /*  Called once per task.  "thread" is the number (0 to charts_pool_threads - 1) of the thread running it, which
+      is handy for indexing per thread state.  */
+
+  typedef void (*CHARTS_POOL_FUNC) (int32_t task, int32_t thread, void *user);
+
+  typedef struct CHARTS_POOL CHARTS_POOL_T;
+
+
+  CHARTS_POOL_T *charts_pool_open (int32_t num_threads);
+  void charts_pool_close (CHARTS_POOL_T *pool);
+  int32_t charts_pool_threads (CHARTS_POOL_T *pool);
+  void charts_pool_run (CHARTS_POOL_T *pool, int32_t num_tasks, CHARTS_POOL_FUNC func, void *user);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,265 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include "charts_scan.h"
+#include "charts_pool.h"
+#include "FileHydroOutput.h"
+#include "FileTopoOutput.h"
+
+
+/*  Each thread keeps its own handle to every file it has touched (opened the first time it gets a chunk from that
+    file) and its own read buffer, so the threads never share a FILE or any of the static state in the legacy
+    readers.  */
+
+typedef struct
+{
+  void                 **handles;
+  void                 *buffer;
+} SCAN_THREAD_T;
+
+
+typedef struct
+{
+  char                 **files;
+  int32_t              num_files;
+  int32_t              type;
+  int32_t              chunk_records;
+  CHARTS_SCAN_CHUNK_T  *chunks;
+  SCAN_THREAD_T        *threads;
+  CHARTS_SCAN_FUNC     func;
+  void                 *user;
+} SCAN_JOB_T;
+
+
+static void scan_close (int32_t type, void *handle)
+{
+  if (handle == NULL) return;
+
+  if (type == CHARTS_SCAN_HOF)
+    {
+      charts_hof_close ((CHARTS_HOF_T *) handle);
+    }
+  else
+    {
+      charts_tof_close ((CHARTS_TOF_T *) handle);
+    }
+}
+
+
+static void scan_chunk (int32_t task, int32_t thread, void *user)
+{
+  SCAN_JOB_T           *job = (SCAN_JOB_T *) user;
+  CHARTS_SCAN_CHUNK_T  *chunk = &job->chunks[task];
+  SCAN_THREAD_T        *state = &job->threads[thread];
+  size_t               size;
+  int32_t              ret;
+
+
+  chunk->thread = thread;
+  chunk->status = -1;
+
+  size = (job->type == CHARTS_SCAN_HOF) ? sizeof (HYDRO_OUTPUT_T) : sizeof (TOPO_OUTPUT_T);
+
+
+  if (state->handles == NULL && (state->handles = (void **) calloc (job->num_files, sizeof (void *))) == NULL) return;
+
+  if (state->buffer == NULL && (state->buffer = malloc ((size_t) job->chunk_records * size)) == NULL) return;
+
+
+  if (state->handles[chunk->file] == NULL)
+    {
+      if (job->type == CHARTS_SCAN_HOF)
+        {
+          state->handles[chunk->file] = charts_hof_open (job->files[chunk->file]);
+        }
+      else
+        {
+          state->handles[chunk->file] = charts_tof_open (job->files[chunk->file]);
+        }
+
+      if (state->handles[chunk->file] == NULL) return;
+    }
+
+
+  if (job->type == CHARTS_SCAN_HOF)
+    {
+      ret = charts_hof_read_records ((CHARTS_HOF_T *) state->handles[chunk->file], chunk->first, chunk->count,
+                                     (HYDRO_OUTPUT_T *) state->buffer);
+    }
+  else
+    {
+      ret = charts_tof_read_records ((CHARTS_TOF_T *) state->handles[chunk->file], chunk->first, chunk->count,
+                                     (TOPO_OUTPUT_T *) state->buffer);
+    }
+
+
+  /*  Short read (truncated file?).  Give the callback what we got.  */
+
+  if (ret <= 0) return;
+  chunk->count = ret;
+
+
+  chunk->status = (*job->func) (chunk, state->buffer, job->user);
+}
+
+
+/*  Splits "files" (all HOF or all TOF, "type" CHARTS_SCAN_HOF or CHARTS_SCAN_TOF) into chunks of "chunk_records"
+    records (CHARTS_SCAN_CHUNK if 0 or less) and runs "func" on every chunk using "num_threads" threads (0 for one
+    per CPU).  Returns the chunk array, in file and record order, with the number of chunks in "num_chunks".  Free
+    it with charts_scan_free.  Returns NULL on failure.  Files that can't be opened are reported and skipped.  */
+
+CHARTS_SCAN_CHUNK_T *charts_scan_files (char **files, int32_t num_files, int32_t type, int32_t chunk_records, int32_t num_threads,
+                                        size_t result_size, CHARTS_SCAN_FUNC func, void *user, int32_t *num_chunks)
+{
+  SCAN_JOB_T           job;
+  CHARTS_POOL_T        *pool;
+  CHARTS_SCAN_CHUNK_T  *chunks = NULL, *new_chunks;
+  CHARTS_HOF_T         *hof;
+  CHARTS_TOF_T         *tof;
+  int32_t              i, j, num_records, count = 0, first;
+
+
+  *num_chunks = 0;
+
+  if (chunk_records <= 0) chunk_records = CHARTS_SCAN_CHUNK;
+
+
+  /*  Count the records in each file and lay out the chunks.  */
+
+  for (i = 0 ; i < num_files ; i++)
+    {
+      num_records = 0;
+
+      if (type == CHARTS_SCAN_HOF)
+        {
+          if ((hof = charts_hof_open (files[i])) != NULL)
+            {
+              num_records = charts_hof_num_records (hof);
+              charts_hof_close (hof);
+            }
+        }
+      else
+        {
+          if ((tof = charts_tof_open (files[i])) != NULL)
+            {
+              num_records = charts_tof_num_records (tof);
+              charts_tof_close (tof);
+            }
+        }
+
+
+      if (num_records <= 0) continue;
+
+
+      if ((new_chunks = (CHARTS_SCAN_CHUNK_T *) realloc (chunks, (count + (num_records - 1) / chunk_records + 1) *
+                                                         sizeof (CHARTS_SCAN_CHUNK_T))) == NULL)
+        {
+          perror ("Allocating scan chunks");
+          charts_scan_free (chunks, count);
+          return (NULL);
+        }
+      chunks = new_chunks;
+
+
+      for (first = 1 ; first <= num_records ; first += chunk_records)
+        {
+          memset (&chunks[count], 0, sizeof (CHARTS_SCAN_CHUNK_T));
+          chunks[count].file = i;
+          chunks[count].first = first;
+          chunks[count].count = MIN (chunk_records, num_records - first + 1);
+          chunks[count].status = -1;
+
+          if (result_size && (chunks[count].result = calloc (1, result_size)) == NULL)
+            {
+              perror ("Allocating scan results");
+              charts_scan_free (chunks, count);
+              return (NULL);
+            }
+
+          count++;
+        }
+    }
+
+  if (!count) return (NULL);
+
+
+  if ((pool = charts_pool_open (num_threads)) == NULL)
+    {
+      charts_scan_free (chunks, count);
+      return (NULL);
+    }
+
+
+  job.files = files;
+  job.num_files = num_files;
+  job.type = type;
+  job.chunk_records = chunk_records;
+  job.chunks = chunks;
+  job.func = func;
+  job.user = user;
+
+  if ((job.threads = (SCAN_THREAD_T *) calloc (charts_pool_threads (pool), sizeof (SCAN_THREAD_T))) == NULL)
+    {
+      perror ("Allocating scan threads");
+      charts_pool_close (pool);
+      charts_scan_free (chunks, count);
+      return (NULL);
+    }
+
+
+  charts_pool_run (pool, count, scan_chunk, &job);
+
+
+  for (i = 0 ; i < charts_pool_threads (pool) ; i++)
+    {
+      if (job.threads[i].handles != NULL)
+        {
+          for (j = 0 ; j < num_files ; j++) scan_close (type, job.threads[i].handles[j]);
+          free (job.threads[i].handles);
+        }
+
+      free (job.threads[i].buffer);
+    }
+
+  free (job.threads);
+
+  charts_pool_close (pool);
+
+
+  *num_chunks = count;
+
+  return (chunks);
+}
+
+
+void charts_scan_free (CHARTS_SCAN_CHUNK_T *chunks, int32_t num_chunks)
+{
+  int32_t              i;
+
+
+  if (chunks == NULL) return;
+
+  for (i = 0 ; i < num_chunks ; i++) free (chunks[i].result);
+
+  free (chunks);
+}
@@ -0,0 +1,83 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_scan.h   Header
+ *
+ * Purpose:        Parallel scan driver for HOF and TOF files.  The files
+ *                 are cut into chunks of consecutive records and each
+ *                 chunk is read and handed to a user callback on a
+ *                 charts_pool thread.  Every chunk gets its own zeroed
+ *                 result area so the callback never has to lock anything;
+ *                 the caller reduces the per chunk results afterwards.
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_SCAN_H__
+#define __CHARTS_SCAN_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "charts.h"
+
+
+#define         CHARTS_SCAN_HOF         0
+#define         CHARTS_SCAN_TOF         1
+
+
+  /*  Default number of records per chunk.  */
+
+#define         CHARTS_SCAN_CHUNK       16384
+
+
+  typedef struct
+  {
+    int32_t     file;               /*  Index into the file list.  */
+    int32_t     first;              /*  First record of the chunk (counting from 1).  */
+    int32_t     count;              /*  Number of records in the chunk.  */
+    int32_t     thread;             /*  Pool thread that ran the chunk.  */
+    int32_t     status;             /*  Callback return, or -1 if the chunk couldn't be read.  */
+    void        *result;            /*  "result_size" zeroed bytes for the callback's use.  */
+  } CHARTS_SCAN_CHUNK_T;
+
+
+  /*  "records" points to chunk->count HYDRO_OUTPUT_T or TOPO_OUTPUT_T records (already byte swapped).  */
+
+  typedef int32_t (*CHARTS_SCAN_FUNC) (CHARTS_SCAN_CHUNK_T *chunk, const void *records, void *user);
+
+
+  CHARTS_SCAN_CHUNK_T *charts_scan_files (char **files, int32_t num_files, int32_t type, int32_t chunk_records, int32_t num_threads, size_t result_size, CHARTS_SCAN_FUNC func, void *user, int32_t *num_chunks);
+  void charts_scan_free (CHARTS_SCAN_CHUNK_T *chunks, int32_t num_chunks);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,315 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include "charts_session.h"
+
+
+/*  The files are sorted on start time.  Where two of them overlap the earlier one keeps its span and the later one
+    starts where it leaves off, so the spans ("start" through "end", inclusive) never overlap and "start" always
+    increases.  A file that is completely covered by an earlier one gets no span at all.  "span" are the file
+    numbers of the files that have one, in time order.  */
+
+struct CHARTS_POS_SESSION
+{
+  int32_t          count;
+  CHARTS_POS_T     **nav;
+  int32_t          num_spans;
+  int32_t          *span;
+  int64_t          *start;
+  int64_t          *end;
+  int32_t          current;            /*  Span of the last lookup, checked before searching.  */
+};
+
+
+static int32_t session_compare (const void *a, const void *b)
+{
+  int64_t          sa, sb;
+
+
+  sa = charts_pos_get_start_timestamp (*(CHARTS_POS_T * const *) a);
+  sb = charts_pos_get_start_timestamp (*(CHARTS_POS_T * const *) b);
+
+  if (sa < sb) return (-1);
+  if (sa > sb) return (1);
+  return (0);
+}
+
+
+/*  Opens the "count" POS/SBET files in "paths" (in any order) as one session.  Every file has to follow the
+    _YYMMDD_NNNN.out naming convention (see open_pos_file) and all of them have to open or nothing is opened.
+    Returns the session or NULL on failure.  */
+
+CHARTS_POS_SESSION_T *charts_pos_session_open (char **paths, int32_t count)
+{
+  CHARTS_POS_SESSION_T *session;
+  int32_t              i;
+  int64_t              start, end, last = 0;
+
+
+  if (count <= 0)
+    {
+      fprintf (stderr, "No POS files given for the session\n");
+      fflush (stderr);
+      return (NULL);
+    }
+
+  if ((session = (CHARTS_POS_SESSION_T *) calloc (1, sizeof (CHARTS_POS_SESSION_T))) == NULL)
+    {
+      perror ("Allocating POS session");
+      return (NULL);
+    }
+
+  session->nav = (CHARTS_POS_T **) calloc (count, sizeof (CHARTS_POS_T *));
+  session->span = (int32_t *) calloc (count, sizeof (int32_t));
+  session->start = (int64_t *) calloc (count, sizeof (int64_t));
+  session->end = (int64_t *) calloc (count, sizeof (int64_t));
+
+  if (session->nav == NULL || session->span == NULL || session->start == NULL || session->end == NULL)
+    {
+      perror ("Allocating POS session");
+      charts_pos_session_close (session);
+      return (NULL);
+    }
+
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if ((session->nav[i] = charts_pos_open (paths[i])) == NULL)
+        {
+          fprintf (stderr, "Unable to open POS file %s\n", paths[i]);
+          fflush (stderr);
+          charts_pos_session_close (session);
+          return (NULL);
+        }
+
+      session->count++;
+    }
+
+
+  qsort (session->nav, count, sizeof (CHARTS_POS_T *), session_compare);
+
+
+  /*  Lay the files end to end.  */
+
+  for (i = 0 ; i < count ; i++)
+    {
+      start = charts_pos_get_start_timestamp (session->nav[i]);
+      end = charts_pos_get_end_timestamp (session->nav[i]);
+
+      if (session->num_spans) start = MAX (start, last + 1);
+
+      if (end < start) continue;
+
+      session->span[session->num_spans] = i;
+      session->start[session->num_spans] = start;
+      session->end[session->num_spans] = end;
+      session->num_spans++;
+
+      last = end;
+    }
+
+  return (session);
+}
+
+
+void charts_pos_session_close (CHARTS_POS_SESSION_T *session)
+{
+  int32_t          i;
+
+
+  if (session == NULL) return;
+
+  for (i = 0 ; i < session->count ; i++) charts_pos_close (session->nav[i]);
+
+  free (session->nav);
+  free (session->span);
+  free (session->start);
+  free (session->end);
+  free (session);
+}
+
+
+/*  Number of files in the session.  */
+
+int32_t charts_pos_session_count (CHARTS_POS_SESSION_T *session)
+{
+  return (session->count);
+}
+
+
+/*  Handle for file "file" (counting from 0 in start time order), or NULL if there isn't one.  */
+
+CHARTS_POS_T *charts_pos_session_handle (CHARTS_POS_SESSION_T *session, int32_t file)
+{
+  if (file < 0 || file >= session->count) return (NULL);
+
+  return (session->nav[file]);
+}
+
+
+/*  Span covering "timestamp" or -1 if it falls in a gap or outside of the session.  */
+
+static int32_t session_span (CHARTS_POS_SESSION_T *session, int64_t timestamp)
+{
+  int32_t          low, high, mid;
+
+
+  if (session->current < session->num_spans && timestamp >= session->start[session->current] &&
+      timestamp <= session->end[session->current]) return (session->current);
+
+
+  /*  Last span starting at or before the timestamp.  */
+
+  low = 0;
+  high = session->num_spans;
+
+  while (low < high)
+    {
+      mid = low + (high - low) / 2;
+
+      if (session->start[mid] <= timestamp)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  if (!low || timestamp > session->end[low - 1]) return (-1);
+
+  session->current = low - 1;
+
+  return (low - 1);
+}
+
+
+/*  File (see charts_pos_session_handle) that lookups for "timestamp" go to or -1 if no file covers it.  */
+
+int32_t charts_pos_session_locate (CHARTS_POS_SESSION_T *session, int64_t timestamp)
+{
+  int32_t          k;
+
+
+  if ((k = session_span (session, timestamp)) < 0) return (-1);
+
+  return (session->span[k]);
+}
+
+
+/*  charts_pos_use_index for every file in the session.  Returns 0 or -1 if any of them failed.  */
+
+int32_t charts_pos_session_use_index (CHARTS_POS_SESSION_T *session, int32_t stride)
+{
+  int32_t          i, ret = 0;
+
+
+  for (i = 0 ; i < session->count ; i++) if (charts_pos_use_index (session->nav[i], stride)) ret = -1;
+
+  return (ret);
+}
+
+
+/*  charts_pos_set_interp for every file in the session.  */
+
+int32_t charts_pos_session_set_interp (CHARTS_POS_SESSION_T *session, int32_t mode, uint32_t mask)
+{
+  int32_t          i;
+
+
+  for (i = 0 ; i < session->count ; i++) if (charts_pos_set_interp (session->nav[i], mode, mask)) return (-1);
+
+  return (0);
+}
+
+
+/*  charts_pos_find_record across the whole session.  The returned record's gps_time is relative to the GPS week of
+    the file it came from so use the timestamp, not gps_time, to compare records from different files.  Returns
+    what charts_pos_find_record does, 0 if no file covers "timestamp".  */
+
+int64_t charts_pos_session_find_record (CHARTS_POS_SESSION_T *session, POS_OUTPUT_T *pos, int64_t timestamp)
+{
+  int32_t          k;
+
+
+  if ((k = session_span (session, timestamp)) < 0) return (0);
+
+  return (charts_pos_find_record (session->nav[session->span[k]], pos, timestamp));
+}
+
+
+/*  charts_pos_interp_batch across the whole session.  Each run of timestamps that falls in one file is handed to
+    that file's charts_pos_interp_batch in one go so increasing timestamps are still a forward sweep, crossing from
+    one file to the next as they go.  Timestamps that no file covers get a zero filled record.  Returns the number
+    of timestamps resolved or -1 on error.  */
+
+int32_t charts_pos_session_interp_batch (CHARTS_POS_SESSION_T *session, const int64_t *timestamps, size_t n,
+                                         POS_OUTPUT_T *out)
+{
+  size_t           j, run;
+  int32_t          k, ret, found = 0;
+
+
+  for (j = 0 ; j < n ; j += run)
+    {
+      k = session_span (session, timestamps[j]);
+
+      for (run = 1 ; j + run < n ; run++)
+        {
+          if (k < 0)
+            {
+              if (session_span (session, timestamps[j + run]) >= 0) break;
+            }
+          else
+            {
+              if (timestamps[j + run] < session->start[k] || timestamps[j + run] > session->end[k]) break;
+            }
+        }
+
+      if (k < 0)
+        {
+          memset (&out[j], 0, run * sizeof (POS_OUTPUT_T));
+          continue;
+        }
+
+      if ((ret = charts_pos_interp_batch (session->nav[session->span[k]], &timestamps[j], run, &out[j])) < 0)
+        return (-1);
+
+      found += ret;
+    }
+
+  return (found);
+}
+
+
+int64_t charts_pos_session_get_start_timestamp (CHARTS_POS_SESSION_T *session)
+{
+  return (session->num_spans ? session->start[0] : 0);
+}
+
+
+int64_t charts_pos_session_get_end_timestamp (CHARTS_POS_SESSION_T *session)
+{
+  return (session->num_spans ? session->end[session->num_spans - 1] : 0);
+}
@@ -0,0 +1,74 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_session.h   Header
+ *
+ * Purpose:          A set of POS/SBET files opened together (all of the
+ *                   sorties for a day, say) and looked up as if they were
+ *                   one file.  Each file is a CHARTS_POS_T handle with its
+ *                   own GPS week base and midnight flag.  The files are
+ *                   laid end to end on one time axis (microseconds from
+ *                   01/01/1970) so lookups can cross GPS week and day
+ *                   boundaries, and the file for a timestamp is found with
+ *                   a binary search on that axis.
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_SESSION_H__
+#define __CHARTS_SESSION_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "charts.h"
+#include "FilePOSOutput.h"
+
+
+  typedef struct CHARTS_POS_SESSION CHARTS_POS_SESSION_T;
+
+
+  CHARTS_POS_SESSION_T *charts_pos_session_open (char **paths, int32_t count);
+  void charts_pos_session_close (CHARTS_POS_SESSION_T *session);
+  int32_t charts_pos_session_count (CHARTS_POS_SESSION_T *session);
+  CHARTS_POS_T *charts_pos_session_handle (CHARTS_POS_SESSION_T *session, int32_t file);
+  int32_t charts_pos_session_locate (CHARTS_POS_SESSION_T *session, int64_t timestamp);
+  int32_t charts_pos_session_use_index (CHARTS_POS_SESSION_T *session, int32_t stride);
+  int32_t charts_pos_session_set_interp (CHARTS_POS_SESSION_T *session, int32_t mode, uint32_t mask);
+  int64_t charts_pos_session_find_record (CHARTS_POS_SESSION_T *session, POS_OUTPUT_T *pos, int64_t timestamp);
+  int32_t charts_pos_session_interp_batch (CHARTS_POS_SESSION_T *session, const int64_t *timestamps, size_t n,
+                                           POS_OUTPUT_T *out);
+  int64_t charts_pos_session_get_start_timestamp (CHARTS_POS_SESSION_T *session);
+  int64_t charts_pos_session_get_end_timestamp (CHARTS_POS_SESSION_T *session);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,696 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include <sys/stat.h>
+
+#include "charts_spatial.h"
+#include "FileHydroOutput.h"
+#include "FileTopoOutput.h"
+
+
+/*  Header of the spatial index sidecar file (<file>.spx).  It is followed by "num_runs" SPATIAL_RUN_T, in native
+    byte order, sorted by tile key and then first record.  */
+
+#define SPATIAL_MAGIC      "CHARTS SPX INDEX"
+#define SPATIAL_VERSION    1
+#define SPATIAL_MAX_ORDER  12
+#define SPATIAL_BATCH      4096
+
+typedef struct
+{
+  char             magic[16];
+  int32_t          version;
+  int32_t          byte_order;
+  int64_t          file_size;
+  int64_t          file_mtime;
+  int32_t          type;
+  int32_t          order;
+  int32_t          slack;
+  int32_t          num_runs;
+  double           min_lat;
+  double           min_lon;
+  double           max_lat;
+  double           max_lon;
+} SPATIAL_HEADER_T;
+
+
+/*  A run of records in one tile.  "key" is the tile's position along the Hilbert curve.  */
+
+typedef struct
+{
+  int32_t          key;
+  int32_t          first;
+  int32_t          count;
+} SPATIAL_RUN_T;
+
+
+struct CHARTS_SPATIAL
+{
+  int32_t          type;
+  void             *handle;          /*  CHARTS_HOF_T or CHARTS_TOF_T  */
+  int32_t          num_records;
+  int32_t          order;
+  double           min_lat;
+  double           min_lon;
+  double           max_lat;
+  double           max_lon;
+  int32_t          num_runs;
+  SPATIAL_RUN_T    *runs;
+  void             *buffer;          /*  SPATIAL_BATCH records  */
+};
+
+
+static int32_t spatial_file_stamp (char *path, int64_t *size, int64_t *mtime)
+{
+#ifdef NVWIN3X
+  struct _stati64        st;
+
+  if (_stati64 (path, &st)) return (-1);
+#else
+  struct stat64          st;
+
+  if (stat64 (path, &st)) return (-1);
+#endif
+
+  *size = st.st_size;
+  *mtime = st.st_mtime;
+
+  return (0);
+}
+
+
+static int32_t spatial_read (CHARTS_SPATIAL_T *index, int32_t first, int32_t count)
+{
+  if (index->type == CHARTS_SPATIAL_HOF)
+    return (charts_hof_read_records ((CHARTS_HOF_T *) index->handle, first, count, (HYDRO_OUTPUT_T *) index->buffer));
+
+  return (charts_tof_read_records ((CHARTS_TOF_T *) index->handle, first, count, (TOPO_OUTPUT_T *) index->buffer));
+}
+
+
+/*  Position of record "i" of the buffer.  For TOF we use the first return unless it's empty.  Returns 0 if the
+    record has no position (0, 0).  */
+
+static int32_t spatial_position (CHARTS_SPATIAL_T *index, int32_t i, double *lat, double *lon)
+{
+  HYDRO_OUTPUT_T   *hof;
+  TOPO_OUTPUT_T    *tof;
+
+
+  if (index->type == CHARTS_SPATIAL_HOF)
+    {
+      hof = &((HYDRO_OUTPUT_T *) index->buffer)[i];
+      *lat = hof->latitude;
+      *lon = hof->longitude;
+    }
+  else
+    {
+      tof = &((TOPO_OUTPUT_T *) index->buffer)[i];
+      *lat = tof->latitude_first;
+      *lon = tof->longitude_first;
+
+      if (*lat == 0.0 && *lon == 0.0)
+        {
+          *lat = tof->latitude_last;
+          *lon = tof->longitude_last;
+        }
+    }
+
+  return (*lat != 0.0 || *lon != 0.0);
+}
+
+
+/*  Distance along the Hilbert curve of cell "x", "y" in an "n" by "n" grid ("n" a power of 2).  */
+
+static int32_t spatial_hilbert (int32_t n, int32_t x, int32_t y)
+{
+  int32_t          rx, ry, s, t, d = 0;
+
+
+  for (s = n / 2 ; s > 0 ; s /= 2)
+    {
+      rx = (x & s) > 0;
+      ry = (y & s) > 0;
+      d += s * s * ((3 * rx) ^ ry);
+
+      if (!ry)
+        {
+          if (rx)
+            {
+              x = s - 1 - x;
+              y = s - 1 - y;
+            }
+
+          t = x;
+          x = y;
+          y = t;
+        }
+    }
+
+  return (d);
+}
+
+
+static int32_t spatial_cell (double value, double min, double max, int32_t n)
+{
+  int32_t          cell;
+
+
+  if (max <= min) return (0);
+
+  cell = (int32_t) ((value - min) / (max - min) * (double) n);
+
+  return (MAX (0, MIN (n - 1, cell)));
+}
+
+
+static int32_t spatial_key (CHARTS_SPATIAL_T *index, double lat, double lon)
+{
+  int32_t          n = 1 << index->order;
+
+
+  return (spatial_hilbert (n, spatial_cell (lon, index->min_lon, index->max_lon, n),
+                           spatial_cell (lat, index->min_lat, index->max_lat, n)));
+}
+
+
+static int spatial_compare_runs (const void *a, const void *b)
+{
+  const SPATIAL_RUN_T *ra = (const SPATIAL_RUN_T *) a, *rb = (const SPATIAL_RUN_T *) b;
+
+
+  if (ra->key != rb->key) return (ra->key < rb->key ? -1 : 1);
+
+  return (ra->first < rb->first ? -1 : (ra->first > rb->first));
+}
+
+
+static int spatial_compare_ranges (const void *a, const void *b)
+{
+  const CHARTS_SPATIAL_RANGE_T *ra = (const CHARTS_SPATIAL_RANGE_T *) a, *rb = (const CHARTS_SPATIAL_RANGE_T *) b;
+
+
+  return (ra->first < rb->first ? -1 : (ra->first > rb->first));
+}
+
+
+/*  Builds the run table from the records.  The positions are kept from the bounding box pass so the file is only
+    read once.  */
+
+static int32_t spatial_build (CHARTS_SPATIAL_T *index)
+{
+  double           *lat = NULL, *lon = NULL;
+  int32_t          *open = NULL, i, j, ret, key, n, size = 0;
+  SPATIAL_RUN_T    *runs;
+
+
+  if ((lat = (double *) malloc (MAX (index->num_records, 1) * sizeof (double))) == NULL ||
+      (lon = (double *) malloc (MAX (index->num_records, 1) * sizeof (double))) == NULL)
+    {
+      perror ("Allocating spatial index positions");
+      free (lat);
+      return (-1);
+    }
+
+
+  index->min_lat = index->min_lon = 999.0;
+  index->max_lat = index->max_lon = -999.0;
+
+  for (i = 1 ; i <= index->num_records ; i += ret)
+    {
+      if ((ret = spatial_read (index, i, MIN (SPATIAL_BATCH, index->num_records - i + 1))) <= 0) break;
+
+      for (j = 0 ; j < ret ; j++)
+        {
+          if (spatial_position (index, j, &lat[i + j - 1], &lon[i + j - 1]))
+            {
+              index->min_lat = MIN (index->min_lat, lat[i + j - 1]);
+              index->min_lon = MIN (index->min_lon, lon[i + j - 1]);
+              index->max_lat = MAX (index->max_lat, lat[i + j - 1]);
+              index->max_lon = MAX (index->max_lon, lon[i + j - 1]);
+            }
+          else
+            {
+              lat[i + j - 1] = lon[i + j - 1] = 999.0;
+            }
+        }
+    }
+
+
+  /*  Truncated file, only index what we could read.  */
+
+  index->num_records = MIN (index->num_records, i - 1);
+
+
+  n = 1 << index->order;
+
+  if ((open = (int32_t *) malloc ((size_t) n * n * sizeof (int32_t))) == NULL)
+    {
+      perror ("Allocating spatial index tiles");
+      free (lat);
+      free (lon);
+      return (-1);
+    }
+
+  for (i = 0 ; i < n * n ; i++) open[i] = -1;
+
+
+  /*  "open" is the last run started in each tile.  A record extends it if it's close enough to the run's end,
+      otherwise it starts a new one.  */
+
+  index->num_runs = 0;
+
+  for (i = 0 ; i < index->num_records ; i++)
+    {
+      if (lat[i] == 999.0) continue;
+
+      key = spatial_key (index, lat[i], lon[i]);
+
+      j = open[key];
+
+      if (j >= 0 && i + 1 - (index->runs[j].first + index->runs[j].count - 1) <= CHARTS_SPATIAL_SLACK)
+        {
+          index->runs[j].count = i + 1 - index->runs[j].first + 1;
+          continue;
+        }
+
+      if (index->num_runs == size)
+        {
+          size = size ? size * 2 : 1024;
+
+          if ((runs = (SPATIAL_RUN_T *) realloc (index->runs, size * sizeof (SPATIAL_RUN_T))) == NULL)
+            {
+              perror ("Allocating spatial index runs");
+              free (open);
+              free (lat);
+              free (lon);
+              return (-1);
+            }
+          index->runs = runs;
+        }
+
+      index->runs[index->num_runs].key = key;
+      index->runs[index->num_runs].first = i + 1;
+      index->runs[index->num_runs].count = 1;
+      open[key] = index->num_runs++;
+    }
+
+  free (open);
+  free (lat);
+  free (lon);
+
+
+  qsort (index->runs, index->num_runs, sizeof (SPATIAL_RUN_T), spatial_compare_runs);
+
+  return (0);
+}
+
+
+/*  Opens a HOF ("type" CHARTS_SPATIAL_HOF) or TOF (CHARTS_SPATIAL_TOF) file along with its spatial index.  The
+    index is read from the <file>.spx sidecar if that matches the file's size and modification time and was built
+    with the same "order" (CHARTS_SPATIAL_ORDER if 0 or less, at most 12), otherwise it is built from the records
+    (one pass through the file) and the sidecar is (re)written if we're allowed to.  Records with no position
+    (latitude and longitude both 0) aren't indexed.  Returns NULL on failure.  */
+
+CHARTS_SPATIAL_T *charts_spatial_open (char *path, int32_t type, int32_t order)
+{
+  CHARTS_SPATIAL_T       *index;
+  FILE                   *fp;
+  char                   spx_file[1040];
+  SPATIAL_HEADER_T       head;
+  int64_t                size, mtime;
+  size_t                 record_size;
+
+
+  if (order <= 0) order = CHARTS_SPATIAL_ORDER;
+  order = MIN (order, SPATIAL_MAX_ORDER);
+
+  record_size = (type == CHARTS_SPATIAL_HOF) ? sizeof (HYDRO_OUTPUT_T) : sizeof (TOPO_OUTPUT_T);
+
+
+  if ((index = (CHARTS_SPATIAL_T *) calloc (1, sizeof (CHARTS_SPATIAL_T))) == NULL ||
+      (index->buffer = malloc (SPATIAL_BATCH * record_size)) == NULL)
+    {
+      perror ("Allocating spatial index");
+      free (index);
+      return (NULL);
+    }
+
+  index->type = type;
+  index->order = order;
+
+  if (type == CHARTS_SPATIAL_HOF)
+    {
+      if ((index->handle = charts_hof_open (path)) != NULL) index->num_records = charts_hof_num_records ((CHARTS_HOF_T *) index->handle);
+    }
+  else
+    {
+      if ((index->handle = charts_tof_open (path)) != NULL) index->num_records = charts_tof_num_records ((CHARTS_TOF_T *) index->handle);
+    }
+
+  if (index->handle == NULL || spatial_file_stamp (path, &size, &mtime))
+    {
+      charts_spatial_close (index);
+      return (NULL);
+    }
+
+
+  if (snprintf (spx_file, sizeof (spx_file), "%s.spx", path) >= (int32_t) sizeof (spx_file))
+    {
+      fprintf (stderr, "File name %s is too long for a spatial index\n", path);
+      fflush (stderr);
+      charts_spatial_close (index);
+      return (NULL);
+    }
+
+
+  /*  Use the sidecar if it was made from this version of the file with this order.  */
+
+  if ((fp = fopen64 (spx_file, "rb")) != NULL)
+    {
+      if (fread (&head, sizeof (SPATIAL_HEADER_T), 1, fp) == 1 && !memcmp (head.magic, SPATIAL_MAGIC, 16) &&
+          head.version == SPATIAL_VERSION && head.byte_order == 0x01020304 && head.file_size == size &&
+          head.file_mtime == mtime && head.type == type && head.order == order && head.slack == CHARTS_SPATIAL_SLACK &&
+          head.num_runs >= 0 && (index->runs = (SPATIAL_RUN_T *) malloc (MAX (head.num_runs, 1) * sizeof (SPATIAL_RUN_T))) != NULL &&
+          fread (index->runs, sizeof (SPATIAL_RUN_T), head.num_runs, fp) == (size_t) head.num_runs)
+        {
+          fclose (fp);
+
+          index->num_runs = head.num_runs;
+          index->min_lat = head.min_lat;
+          index->min_lon = head.min_lon;
+          index->max_lat = head.max_lat;
+          index->max_lon = head.max_lon;
+
+          return (index);
+        }
+
+      free (index->runs);
+      index->runs = NULL;
+
+      fclose (fp);
+    }
+
+
+  if (spatial_build (index))
+    {
+      charts_spatial_close (index);
+      return (NULL);
+    }
+
+
+  /*  Failing to write the sidecar (read only directory, for instance) just means we'll build it again next time.  */
+
+  if ((fp = fopen64 (spx_file, "wb")) != NULL)
+    {
+      memset (&head, 0, sizeof (SPATIAL_HEADER_T));
+      memcpy (head.magic, SPATIAL_MAGIC, 16);
+      head.version = SPATIAL_VERSION;
+      head.byte_order = 0x01020304;
+      head.file_size = size;
+      head.file_mtime = mtime;
+      head.type = type;
+      head.order = order;
+      head.slack = CHARTS_SPATIAL_SLACK;
+      head.num_runs = index->num_runs;
+      head.min_lat = index->min_lat;
+      head.min_lon = index->min_lon;
+      head.max_lat = index->max_lat;
+      head.max_lon = index->max_lon;
+
+      if (fwrite (&head, sizeof (SPATIAL_HEADER_T), 1, fp) != 1 ||
+          fwrite (index->runs, sizeof (SPATIAL_RUN_T), index->num_runs, fp) != (size_t) index->num_runs)
+        {
+          fclose (fp);
+          remove (spx_file);
+        }
+      else
+        {
+          fclose (fp);
+        }
+    }
+
+  return (index);
+}
+
+
+void charts_spatial_close (CHARTS_SPATIAL_T *index)
+{
+  if (index == NULL) return;
+
+  if (index->handle != NULL)
+    {
+      if (index->type == CHARTS_SPATIAL_HOF)
+        {
+          charts_hof_close ((CHARTS_HOF_T *) index->handle);
+        }
+      else
+        {
+          charts_tof_close ((CHARTS_TOF_T *) index->handle);
+        }
+    }
+
+  free (index->runs);
+  free (index->buffer);
+  free (index);
+}
+
+
+/*  Bounding box of the indexed shots.  min > max if none of them had a position.  */
+
+void charts_spatial_bounds (CHARTS_SPATIAL_T *index, double *min_lat, double *min_lon, double *max_lat, double *max_lon)
+{
+  *min_lat = index->min_lat;
+  *min_lon = index->min_lon;
+  *max_lat = index->max_lat;
+  *max_lon = index->max_lon;
+}
+
+
+/*  Returns the number of record ranges that may contain shots inside the bounding box, in record order and not
+    overlapping, in "ranges" (allocated here, free it when you're done).  These are candidates only, the ranges
+    cover every shot in the box but may include shots outside of it (charts_spatial_bbox does the exact test).
+    Returns -1 on failure.  */
+
+int32_t charts_spatial_ranges (CHARTS_SPATIAL_T *index, double min_lat, double min_lon, double max_lat, double max_lon,
+                               CHARTS_SPATIAL_RANGE_T **ranges)
+{
+  CHARTS_SPATIAL_RANGE_T *list = NULL, *new_list;
+  int32_t                n, x, y, x0, x1, y0, y1, key, low, high, mid, count = 0, size = 0, i, j;
+
+
+  *ranges = NULL;
+
+  if (max_lat < index->min_lat || min_lat > index->max_lat || max_lon < index->min_lon || min_lon > index->max_lon ||
+      !index->num_runs) return (0);
+
+
+  n = 1 << index->order;
+
+  x0 = spatial_cell (min_lon, index->min_lon, index->max_lon, n);
+  x1 = spatial_cell (max_lon, index->min_lon, index->max_lon, n);
+  y0 = spatial_cell (min_lat, index->min_lat, index->max_lat, n);
+  y1 = spatial_cell (max_lat, index->min_lat, index->max_lat, n);
+
+
+  for (y = y0 ; y <= y1 ; y++)
+    {
+      for (x = x0 ; x <= x1 ; x++)
+        {
+          key = spatial_hilbert (n, x, y);
+
+
+          /*  First run for this tile.  */
+
+          low = 0;
+          high = index->num_runs;
+
+          while (low < high)
+            {
+              mid = low + (high - low) / 2;
+
+              if (index->runs[mid].key < key)
+                {
+                  low = mid + 1;
+                }
+              else
+                {
+                  high = mid;
+                }
+            }
+
+
+          for (i = low ; i < index->num_runs && index->runs[i].key == key ; i++)
+            {
+              if (count == size)
+                {
+                  size = size ? size * 2 : 256;
+
+                  if ((new_list = (CHARTS_SPATIAL_RANGE_T *) realloc (list, size * sizeof (CHARTS_SPATIAL_RANGE_T))) == NULL)
+                    {
+                      perror ("Allocating spatial ranges");
+                      free (list);
+                      return (-1);
+                    }
+                  list = new_list;
+                }
+
+              list[count].first = index->runs[i].first;
+              list[count].count = index->runs[i].count;
+              count++;
+            }
+        }
+    }
+
+  if (!count) return (0);
+
+
+  /*  Runs from different tiles interleave, so sort them into record order and merge the ones that overlap or
+      touch.  */
+
+  qsort (list, count, sizeof (CHARTS_SPATIAL_RANGE_T), spatial_compare_ranges);
+
+  for (i = 1, j = 0 ; i < count ; i++)
+    {
+      if (list[i].first <= list[j].first + list[j].count)
+        {
+          list[j].count = MAX (list[j].count, list[i].first + list[i].count - list[j].first);
+        }
+      else
+        {
+          list[++j] = list[i];
+        }
+    }
+
+  *ranges = list;
+
+  return (j + 1);
+}
+
+
+/*  Common code for the bbox and polygon queries.  Reads the candidate ranges and keeps the records that pass the
+    bounding box test and, if "poly_count" isn't 0, the point in polygon test.  */
+
+static int32_t spatial_query (CHARTS_SPATIAL_T *index, double min_lat, double min_lon, double max_lat, double max_lon,
+                              double *poly_lat, double *poly_lon, int32_t poly_count, int32_t **recnums)
+{
+  CHARTS_SPATIAL_RANGE_T *ranges;
+  int32_t                num_ranges, i, j, k, m, first, ret, count = 0, size = 0, *list = NULL, *new_list;
+  uint8_t                inside;
+  double                 lat, lon;
+
+
+  *recnums = NULL;
+
+  if ((num_ranges = charts_spatial_ranges (index, min_lat, min_lon, max_lat, max_lon, &ranges)) <= 0) return (num_ranges);
+
+
+  for (i = 0 ; i < num_ranges ; i++)
+    {
+      for (first = ranges[i].first ; first < ranges[i].first + ranges[i].count ; first += SPATIAL_BATCH)
+        {
+          if ((ret = spatial_read (index, first, MIN (SPATIAL_BATCH, ranges[i].first + ranges[i].count - first))) <= 0) break;
+
+          for (j = 0 ; j < ret ; j++)
+            {
+              if (!spatial_position (index, j, &lat, &lon) || lat < min_lat || lat > max_lat || lon < min_lon ||
+                  lon > max_lon) continue;
+
+
+              /*  Even-odd rule.  */
+
+              if (poly_count)
+                {
+                  inside = 0;
+
+                  for (k = 0, m = poly_count - 1 ; k < poly_count ; m = k++)
+                    {
+                      if ((poly_lat[k] > lat) != (poly_lat[m] > lat) &&
+                          lon < (poly_lon[m] - poly_lon[k]) * (lat - poly_lat[k]) / (poly_lat[m] - poly_lat[k]) + poly_lon[k])
+                        inside = !inside;
+                    }
+
+                  if (!inside) continue;
+                }
+
+
+              if (count == size)
+                {
+                  size = size ? size * 2 : 1024;
+
+                  if ((new_list = (int32_t *) realloc (list, size * sizeof (int32_t))) == NULL)
+                    {
+                      perror ("Allocating spatial query results");
+                      free (list);
+                      free (ranges);
+                      return (-1);
+                    }
+                  list = new_list;
+                }
+
+              list[count++] = first + j;
+            }
+        }
+    }
+
+  free (ranges);
+
+  *recnums = list;
+
+  return (count);
+}
+
+
+/*  Returns the number of records with shots inside the bounding box (inclusive) and their record numbers (counting
+    from 1), in increasing order, in "recnums" (allocated here, free it when you're done).  Returns -1 on
+    failure.  */
+
+int32_t charts_spatial_bbox (CHARTS_SPATIAL_T *index, double min_lat, double min_lon, double max_lat, double max_lon, int32_t **recnums)
+{
+  return (spatial_query (index, min_lat, min_lon, max_lat, max_lon, NULL, NULL, 0, recnums));
+}
+
+
+/*  Same as charts_spatial_bbox for the polygon with "count" vertices in "lat" and "lon" (it doesn't need to be
+    closed).  */
+
+int32_t charts_spatial_polygon (CHARTS_SPATIAL_T *index, double *lat, double *lon, int32_t count, int32_t **recnums)
+{
+  double                 min_lat = 999.0, min_lon = 999.0, max_lat = -999.0, max_lon = -999.0;
+  int32_t                i;
+
+
+  *recnums = NULL;
+
+  if (count < 3) return (0);
+
+  for (i = 0 ; i < count ; i++)
+    {
+      min_lat = MIN (min_lat, lat[i]);
+      min_lon = MIN (min_lon, lon[i]);
+      max_lat = MAX (max_lat, lat[i]);
+      max_lon = MAX (max_lon, lon[i]);
+    }
+
+  return (spatial_query (index, min_lat, min_lon, max_lat, max_lon, lat, lon, count, recnums));
+}
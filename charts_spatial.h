@@ -0,0 +1,92 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+/*****************************************************************************
+ * charts_spatial.h   Header
+ *
+ * Purpose:        Spatial index for HOF and TOF files.  The line's bounding
+ *                 box is cut into a 2^order by 2^order grid of tiles and
+ *                 each tile is mapped to the runs of records whose shots
+ *                 fall in it.  The runs are kept in Hilbert curve order of
+ *                 their tiles (so nearby tiles are nearby in the table) in
+ *                 a <file>.spx sidecar next to the data file.  Bounding box
+ *                 and polygon queries only read the records in the runs of
+ *                 the tiles they touch.
+ *
+ * Revision History:
+ *
+ ****************************************************************************/
+
+#ifndef __CHARTS_SPATIAL_H__
+#define __CHARTS_SPATIAL_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include "charts.h"
+
+
+#define         CHARTS_SPATIAL_HOF      0
+#define         CHARTS_SPATIAL_TOF      1
+
+
+  /*  Default grid order (256 by 256 tiles).  */
+
+#define         CHARTS_SPATIAL_ORDER    8
+
+
+  /*  Records in the same tile that are no more than this many records apart are kept in one run.  Scanning lidar
+      goes back and forth across a tile many times, so this keeps the run table small at the cost of reading a few
+      records from outside the tile.  */
+
+#define         CHARTS_SPATIAL_SLACK    64
+
+
+  /*  A run of "count" records starting at record "first" (counting from 1).  */
+
+  typedef struct
+  {
+    int32_t     first;
+    int32_t     count;
+  } CHARTS_SPATIAL_RANGE_T;
+
+
+  typedef struct CHARTS_SPATIAL CHARTS_SPATIAL_T;
+
+
+  CHARTS_SPATIAL_T *charts_spatial_open (char *path, int32_t type, int32_t order);
+  void charts_spatial_close (CHARTS_SPATIAL_T *index);
+  void charts_spatial_bounds (CHARTS_SPATIAL_T *index, double *min_lat, double *min_lon, double *max_lat, double *max_lon);
+  int32_t charts_spatial_ranges (CHARTS_SPATIAL_T *index, double min_lat, double min_lon, double max_lat, double max_lon, CHARTS_SPATIAL_RANGE_T **ranges);
+  int32_t charts_spatial_bbox (CHARTS_SPATIAL_T *index, double min_lat, double min_lon, double max_lat, double max_lon, int32_t **recnums);
+  int32_t charts_spatial_polygon (CHARTS_SPATIAL_T *index, double *lat, double *lon, int32_t count, int32_t **recnums);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,157 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#ifdef NVWIN3X
+  #include <windows.h>
+#endif
+
+#include "charts.h"
+
+
+/*  Per handle I/O counters.  These are plain wrappers around the stdio calls so that, with the counters turned off,
+    all they cost is a test of charts_io_stats_on.  */
+
+int32_t charts_io_stats_on = 0;
+
+
+/*  Turns the counters on (1) or off (0) for every handle.  */
+
+void charts_io_stats_enable (int32_t on)
+{
+  charts_io_stats_on = on;
+}
+
+
+/*  Seconds from some fixed point in the past.  Only good for differences.  */
+
+double charts_io_stats_clock ()
+{
+#ifdef NVWIN3X
+  LARGE_INTEGER    count, freq;
+
+
+  QueryPerformanceCounter (&count);
+  QueryPerformanceFrequency (&freq);
+
+  return ((double) count.QuadPart / (double) freq.QuadPart);
+#else
+  struct timespec  ts;
+
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ((double) ts.tv_sec + (double) ts.tv_nsec * 1.0e-9);
+#endif
+}
+
+
+int32_t charts_io_seek (CHARTS_IO_STATS_T *stats, FILE *fp, int64_t offset, int32_t whence)
+{
+  int32_t          ret;
+  double           start;
+
+
+  if (!charts_io_stats_on) return (fseeko64 (fp, offset, whence));
+
+  start = charts_io_stats_clock ();
+
+  ret = fseeko64 (fp, offset, whence);
+
+  stats->seeks++;
+  stats->io_seconds += charts_io_stats_clock () - start;
+
+  return (ret);
+}
+
+
+size_t charts_io_read (CHARTS_IO_STATS_T *stats, void *ptr, size_t size, size_t count, FILE *fp)
+{
+  size_t           ret;
+  double           start;
+
+
+  if (!charts_io_stats_on) return (fread (ptr, size, count, fp));
+
+  start = charts_io_stats_clock ();
+
+  ret = fread (ptr, size, count, fp);
+
+  stats->reads++;
+  stats->bytes_read += (int64_t) (ret * size);
+  stats->io_seconds += charts_io_stats_clock () - start;
+
+  return (ret);
+}
+
+
+size_t charts_io_write (CHARTS_IO_STATS_T *stats, const void *ptr, size_t size, size_t count, FILE *fp)
+{
+  size_t           ret;
+  double           start;
+
+
+  if (!charts_io_stats_on) return (fwrite (ptr, size, count, fp));
+
+  start = charts_io_stats_clock ();
+
+  ret = fwrite (ptr, size, count, fp);
+
+  stats->writes++;
+  stats->bytes_written += (int64_t) (ret * size);
+  stats->io_seconds += charts_io_stats_clock () - start;
+
+  return (ret);
+}
+
+
+/*  Writes "stats" as a single line JSON object.  "name" (usually the file name) is included as "file".  */
+
+void charts_io_stats_json (FILE *fp, const char *name, const CHARTS_IO_STATS_T *stats)
+{
+  const char       *c;
+
+
+  fprintf (fp, "{\"file\": \"");
+
+  for (c = name ; c && *c ; c++)
+    {
+      if (*c == '"' || *c == '\\')
+        {
+          fprintf (fp, "\\%c", *c);
+        }
+      else if ((uint8_t) *c < 0x20)
+        {
+          fprintf (fp, "\\u%04x", (uint8_t) *c);
+        }
+      else
+        {
+          fputc (*c, fp);
+        }
+    }
+
+  fprintf (fp, "\", \"seeks\": %"PRId64", \"reads\": %"PRId64", \"writes\": %"PRId64", \"bytes_read\": %"PRId64
+           ", \"bytes_written\": %"PRId64", \"swaps\": %"PRId64", \"cache_hits\": %"PRId64", \"cache_misses\": %"PRId64
+           ", \"header_seconds\": %.6f, \"io_seconds\": %.6f}\n", stats->seeks, stats->reads, stats->writes,
+           stats->bytes_read, stats->bytes_written, stats->swaps, stats->cache_hits, stats->cache_misses,
+           stats->header_seconds, stats->io_seconds);
+}
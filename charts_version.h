@@ -38,7 +38,7 @@
 
 #ifndef CHARTS_VERSION
 
-#define     CHARTS_VERSION     "PFM Software - charts library V1.33 - 06/01/15"
+#define     CHARTS_VERSION     "PFM Software - charts library V1.58 - 10/17/26"
 
 #endif
 
@@ -177,4 +177,261 @@
 
     Apparently, when I replaced the nvtypes definitions I screwed up the endian checking - DOH!
 
+
+    Version 1.34
+    PFM Software
+    10/17/26
+
+    Added charts_hof_map_open, charts_hof_map_span, and friends to hof_io.c.  These memory map the HOF file
+    and hand out the records after the header in place.  If the file is of the other endianness the (private)
+    mapping is swapped in full when it's opened, so nothing writes to it afterwards and it can be shared between
+    threads.  On Windows the records are read into memory instead.
+
+
+    Version 1.35
+    PFM Software
+    10/17/26
+
+    Added handle based versions of the readers (charts_hof_open, charts_tof_open, charts_image_open,
+    charts_wave_open, charts_pos_open, charts_rms_open, and charts_gps_open along with their read/write/find
+    functions).  Each handle carries its own endianness, header, index, GPS week base, midnight flag, and
+    record range instead of keeping them in file scope statics so more than one file of each type can be
+    open at once, from more than one thread.  The old FILE based functions are now thin wrappers around the
+    handle functions.
+
+    charts_wave_read_record uses waveform buffers owned by the handle so the caller no longer has to make
+    the record static.  dump_image no longer disturbs the state of the FILE based image calls and
+    image_get_metadata no longer reads one past the end of the index.
+
+
+    Version 1.36
+    PFM Software
+    10/17/26
+
+    Added hof_read_records, tof_read_records, and their handle versions.  These read a block of records with
+    one seek and one read into a caller supplied buffer and then swap the whole block if needed.
+
+
+    Version 1.37
+    PFM Software
+    10/17/26
+
+    Added charts_hof_load_columns and charts_hof_free_columns.  These decode a range of records from a
+    mapped HOF file into separate arrays (HOF_COLUMNS_T) for only the fields selected in a HOF_COLUMN_*
+    mask.
+
+
+    Version 1.38
+    PFM Software
+    10/17/26
+
+    Added bulk byte swap kernels (charts_swap_array_16/32/64) and a field run driven record swapper
+    (charts_swap_records) to swap_NV.c.  These use SSSE3 or AVX2 byte shuffles when the CPU has them
+    (checked at run time) and a portable fallback otherwise.  The single value swap functions now use
+    compiler byte swap builtins.
+
+    Added charts_swap_hof_records, charts_swap_tof_records, charts_swap_pos_records and
+    charts_swap_rms_records, and switched the readers over to them.  The POS swap now includes z_velocity,
+    which the old per field swap skipped.
+
+
+    Version 1.39
+    PFM Software
+    10/17/26
+
+    Image timestamp lookups (charts_image_find_record, image_find_record and the read_record calls) now use
+    a binary search on the in memory index when it's in time order.  Added
+    charts_image_find_records/image_find_records to resolve a sorted array of timestamps in a single merge
+    pass.
+
+
+    Version 1.40
+    PFM Software
+    10/17/26
+
+    Added charts_pos_use_index/pos_use_index.  These set up a sampled time index (every Nth record) for a
+    POS/SBET file, kept in a <file>.idx sidecar that is checked against the file's size and modification
+    time.  With the index, find_record reads one short stretch of records per lookup instead of doing the
+    interpolation search and walk.
+
+    Also fixed pos_find_record spinning forever when asked for exactly the end timestamp.
+
+
+    Version 1.41
+    PFM Software
+    10/17/26
+
+    Added charts_pos_interp_batch/pos_interp_batch.  These interpolate positions for an array of timestamps.
+    Increasing timestamps are resolved in a single forward sweep through the POS/SBET file, and
+    charts_pos_find_record is only used for timestamps that go backwards.
+
+
+    Version 1.42
+    PFM Software
+    10/17/26
+
+    Added hof_get_uncertainty_array.  It computes horizontal and vertical TPU for arrays of shots (nadir
+    angle, altitude, depth, abdc and data_type columns) with the constant terms hoisted out of the loop.
+    Each shot needs one tan and three sqrt calls, and there is no static state.
+
+
+    Version 1.43
+    PFM Software
+    10/17/26
+
+    charts_cvtime is now plain arithmetic (no putenv/tzset/localtime), so it's thread safe and doesn't
+    change the process TZ.  Added charts_cvtime_batch for arrays of timestamps and charts_utc_time.  The
+    POS, RMS and GPS readers now use charts_utc_time instead of mktime with TZ=GMT.  charts_jday2mday no
+    longer modifies a static table.
+
+
+    Version 1.44
+    PFM Software
+    10/17/26
+
+    Added charts_wave_view and charts_wave_read_block.  These read INH records a block at a time into a
+    handle owned buffer and hand out WAVE_DATA_T views whose waveform pointers point straight into it (no
+    per record allocation or copying, one read per block instead of six per record).
+
+    wave_read_record now clears its first call flag so it only allocates the waveform buffers once.  Also
+    fixed an overlapping strncpy in lidar_get_string.
+
+
+    Version 1.45
+    PFM Software
+    10/17/26
+
+    Added charts_pool (a small work-stealing pthread pool) and charts_scan, which splits a list of HOF or
+    TOF files into record range chunks and runs a user callback on each chunk in parallel, with a zeroed
+    per chunk result area for lock free reduction.
+
+
+    Version 1.46
+    PFM Software
+    10/17/26
+
+    Added charts_spatial, a persistent spatial index for HOF and TOF files.  Shots are binned into a 2^order
+    grid of tiles over the line and each tile is mapped to the runs of records that fall in it, sorted in
+    Hilbert curve order and kept in a <file>.spx sidecar.  charts_spatial_bbox and charts_spatial_polygon
+    return the matching record numbers while reading only the records in the touched tiles, and
+    charts_spatial_ranges returns the candidate record ranges themselves.
+
+
+    Version 1.47
+    PFM Software
+    10/17/26
+
+    The HOF, TOF, image and waveform header parsers now share a table driven parser (charts_header.c).  Each
+    line is split once at the colon and the key is looked up in a collision free hash of the table's keys
+    instead of being strstr'ed against every key.  The tables (charts_hof_header_table, etc.) can also be
+    used to write headers with charts_header_write.  String values are now limited to the size of their
+    field, and EndianType sets endian to 1 for Little and 0 for Big (it used to be 1 either way).
+
+
+    Version 1.48
+    PFM Software
+    10/17/26
+
+    Added charts_catalog, a survey wide catalog of HOF, TOF, IMG and INH headers kept in a binary cache
+    file.  charts_catalog_scan walks a directory tree and only reads the headers of new or changed files (by
+    size and modification time), and charts_catalog_query finds the lines overlapping a time span and/or
+    area without opening the data files.
+
+
+    Version 1.49
+    PFM Software
+    10/17/26
+
+    Added buffered HOF/TOF writers (charts_hof_append_open/append/append_flush/append_close and the TOF
+    equivalents).  Records are copied into an aligned buffer, swapped there if needed, and written
+    CHARTS_HOF_APPEND_BLOCK at a time.  On close the NumberShots, StartTimestamp and EndTimestamp header
+    entries and the num_shots, start_time and stop_time info fields are updated from the file.  Added
+    charts_header_patch to change one entry of an ASCII header in place.
+
+    charts_hof_write_record and charts_tof_write_record (and hof_write_record/tof_write_record) no longer
+    byte swap the caller's record.
+
+
+    Version 1.50
+    PFM Software
+    10/17/26
+
+    Added in place editing of the single byte status fields: charts_hof_edit_open/get/set/flush/close for
+    status, suspect_status and classification_status in HOF files and charts_tof_edit_* for
+    classification_status in TOF files.  The file is mapped read/write (read into memory on Windows),
+    changed pages are tracked in a bit map, and flushing writes them back with one msync (one write per run
+    of dirty pages on Windows).  The generic code is in charts_edit.c.
+
+
+    Version 1.51
+    PFM Software
+    10/17/26
+
+    Added charts_cache.c/.h, a byte budgeted LRU cache of IMG images keyed by image handle and record
+    number. Buffers are reference counted and are never evicted while referenced. On a miss the cache can
+    read the next few images in the direction of travel in one pass.
+
+
+    Version 1.52
+    PFM Software
+    10/17/26
+
+    Added charts_image_map_record, which returns a pointer into the memory mapped IMG file instead of a
+    malloc'd copy. dump_image now writes straight from the mapping.
+
+
+    Version 1.53
+    PFM Software
+    10/17/26
+
+    dump_image_file now writes the images on a thread pool. The -j option bounds the number of images in
+    flight. On Linux the bytes are copied file to file with copy_file_range; elsewhere they are written from
+    the mapped IMG file. Added time window (-s/-e), every Nth (-n), output directory (-o) and manifest (-m)
+    options.
+
+
+    Version 1.54
+    PFM Software
+    10/17/26
+
+    Added generate_charts_files.c, which writes a deterministic synthetic data set. It has HOF, TOF and IMG
+    files in both byte orders, an INH file, and a 200 Hz SBET, RMS and GPS that cross the end of a GPS week.
+    Added benchmark_charts_files.c, which times open, sequential and random reads, find record, and writes
+    for every reader, printing one JSON object per line.
+
+
+    Version 1.55
+    PFM Software
+    10/17/26
+
+    Added opt-in per handle I/O counters (charts_io_stats_enable, charts_*_stats, charts_io_stats_json).
+
+
+    Version 1.56
+    PFM Software
+    10/17/26
+
+    Added charts_georef.c to re-position HOF/TOF shots from a new SBET in parallel chunks.
+
+
+    Version 1.57
+    PFM Software
+    10/17/26
+
+    Added charts_pos_set_interp and charts_rms_set_interp (and the FILE based pos_set_interp and
+    rms_set_interp) to choose linear or cubic Hermite interpolation and the fields to interpolate
+    (POS_FIELD_* and RMS_FIELD_* masks).  Headings, wander angle, and longitude now go the short way around
+    when interpolated.  Fixed the record walk in charts_pos_find_record and charts_rms_find_record
+    interpolating against a stale record when it took more than one step, and RMS lookups after end of week
+    midnight (WEEK_OFFSET was in microseconds).
+
+
+    Version 1.58
+    PFM Software
+    10/17/26
+
+    Added charts_session.c/.h, a POS/SBET session that opens a set of files (the sorties for a day, say) and
+    lays them end to end on one time axis so charts_pos_session_find_record and
+    charts_pos_session_interp_batch work across GPS week and day boundaries without reopening anything.
+
 */
@@ -21,68 +21,300 @@
 
 *********************************************************************************************/
 
+/*  For the copy_file_range prototype (and loff_t).  This has to come before any system header.  */
+
+#if defined (__linux__) && !defined (_GNU_SOURCE)
+  #define _GNU_SOURCE
+#endif
+
+#ifndef NVWIN3X
+  #include <fcntl.h>
+#endif
+
+#include <getopt.h>
+
 #include "FileImage.h"
+#include "charts_pool.h"
 
 /*  dump_image_file  */
 
 
-int32_t main (int32_t argc, char *argv[])
+/*  Everything the workers need.  "recnums" are the selected records and "status" gets 0 or -1 for each one.  If the
+    file couldn't be mapped "mapped" is 0 and the images are read through the handle's FILE instead, one at a time.  */
+
+typedef struct
+{
+  CHARTS_IMAGE_T      *image;
+  uint8_t             mapped;
+  int32_t             *recnums;
+  int8_t              *status;
+  char                *dir;
+} DUMP_T;
+
+
+/*  Builds the JPEG file name for "image_index" in "path" ("size" bytes).  Returns 0 or -1 if it doesn't fit.  */
+
+static int32_t jpg_path (DUMP_T *dump, IMAGE_INDEX_T *image_index, char *path, size_t size)
+{
+  if (snprintf (path, size, "%s%s%04d_%"PRId64"_%d_%"PRId64".jpg", dump->dir ? dump->dir : "", dump->dir ? "/" : "",
+                image_index->image_number, image_index->byte_offset, image_index->image_size,
+                image_index->timestamp) >= (int32_t) size)
+    {
+      fprintf (stderr, "JPEG file name for image %d is too long\n", image_index->image_number);
+      fflush (stderr);
+      return (-1);
+    }
+
+  return (0);
+}
+
+
+/*  Writes one image.  On Linux the bytes go file to file in the kernel with copy_file_range, otherwise (or if the
+    kernel won't do it for these two files) they're written straight out of the mapped IMG file.  Either way
+    nothing is copied through a malloc'd buffer, unless the file isn't mapped in which case the image is read the
+    old way.  */
+
+static void dump_one (int32_t task, int32_t thread, void *user)
 {
-  FILE                *fp, *jpg_fp;
-  char                fn[512], jpg_name[512];
-  uint8_t             *image;
-  int32_t             i, num_recs;
+  DUMP_T              *dump = (DUMP_T *) user;
+  IMAGE_INDEX_T       image_index;
+  const uint8_t       *data;
+  uint8_t             *buffer = NULL;
+  char                jpg_name[1024];
   uint32_t            size;
-  int64_t             image_time;
-  IMAGE_HEADER_T      head;
+  int64_t             image_time, done;
+#ifdef NVWIN3X
+  FILE                *jpg_fp;
+#else
+  int32_t             fd;
+  ssize_t             ret;
+#endif
+
+
+  (void) thread;
+
+  dump->status[task] = -1;
+
+  charts_image_get_metadata (dump->image, dump->recnums[task], &image_index);
+
+  if (jpg_path (dump, &image_index, jpg_name, sizeof (jpg_name))) return;
+
+  if (dump->mapped)
+    {
+      data = charts_image_map_record (dump->image, dump->recnums[task], &size, &image_time);
+    }
+  else
+    {
+      data = buffer = charts_image_read_record_recnum (dump->image, dump->recnums[task], &size, &image_time);
+    }
+
+  if (data == NULL)
+    {
+      fprintf (stderr, "Record %d is past the end of the file\n", dump->recnums[task]);
+      return;
+    }
+
+
+#ifdef NVWIN3X
+
+  if ((jpg_fp = fopen (jpg_name, "wb")) == NULL)
+    {
+      perror (jpg_name);
+      if (buffer) free (buffer);
+      return;
+    }
+
+  done = fwrite (data, size, 1, jpg_fp) == 1 ? size : 0;
+
+  if (fclose (jpg_fp)) done = 0;
+
+#else
+
+  if ((fd = open (jpg_name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+    {
+      perror (jpg_name);
+      if (buffer) free (buffer);
+      return;
+    }
+
+  done = 0;
+
+#ifdef __linux__
+  if (dump->mapped)
+    {
+      loff_t   in_off = image_index.byte_offset;
+
+      while (done < size && (ret = copy_file_range (fileno (charts_image_fp (dump->image)), &in_off, fd, NULL,
+                                                    size - done, 0)) > 0) done += ret;
+    }
+#endif
+
+  while (done < size && (ret = write (fd, data + done, size - done)) > 0) done += ret;
+
+  if (close (fd)) done = 0;
+
+#endif
+
+
+  if (buffer) free (buffer);
+
+  if (done != size)
+    {
+      perror (jpg_name);
+      return;
+    }
+
+  dump->status[task] = 0;
+}
+
+
+static void usage ()
+{
+  fprintf (stderr, "\n\nUsage: dump_image_file [-j IN_FLIGHT] [-s START] [-e END] [-n NTH] [-o DIR] [-m MANIFEST] IMG_FILENAME\n\n");
+  fprintf (stderr, "  -j  Number of images being written at once (default 8)\n");
+  fprintf (stderr, "  -s  Skip images before this timestamp (microseconds from 01/01/1970)\n");
+  fprintf (stderr, "  -e  Skip images after this timestamp\n");
+  fprintf (stderr, "  -n  Only dump every NTH image in the time window\n");
+  fprintf (stderr, "  -o  Write the JPEGs into DIR instead of the current directory\n");
+  fprintf (stderr, "  -m  Write a list of the images dumped (record, image number, timestamp, size, file) to MANIFEST\n\n");
+  exit (-1);
+}
+
+
+int32_t main (int32_t argc, char *argv[])
+{
+  FILE                *mfp = NULL;
+  char                jpg_name[1024], *manifest = NULL;
+  int32_t             i, c, num_recs, count, in_flight = 8, nth = 1, window = 0, failed = 0;
+  int64_t             start = INT64_MIN, end = INT64_MAX;
   IMAGE_INDEX_T       image_index;
+  CHARTS_POOL_T       *pool;
+  DUMP_T              dump;
+
 
+  memset (&dump, 0, sizeof (DUMP_T));
 
-  if (argc < 2)
+  while ((c = getopt (argc, argv, "j:s:e:n:o:m:")) != -1)
     {
-      fprintf (stderr, "\n\nUsage: dump_image_file IMG_FILENAME\n\n");
-      exit (-1);
+      switch (c)
+        {
+        case 'j':
+          in_flight = atoi (optarg);
+          break;
+
+        case 's':
+          sscanf (optarg, "%"SCNd64, &start);
+          break;
+
+        case 'e':
+          sscanf (optarg, "%"SCNd64, &end);
+          break;
+
+        case 'n':
+          nth = atoi (optarg);
+          break;
+
+        case 'o':
+          dump.dir = optarg;
+          break;
+
+        case 'm':
+          manifest = optarg;
+          break;
+
+        default:
+          usage ();
+        }
     }
 
-  if ((fp = open_image_file (argv[1])) == NULL)
+  if (optind >= argc || in_flight < 1 || nth < 1) usage ();
+
+
+  if ((dump.image = charts_image_open (argv[optind])) == NULL) exit (-1);
+
+  num_recs = charts_image_header (dump.image)->text.number_images;
+
+
+  /*  Pick the records.  Empty ones are skipped but still count toward NTH so the spacing stays even in time.  */
+
+  if ((dump.recnums = (int32_t *) malloc ((num_recs + 1) * sizeof (int32_t))) == NULL ||
+      (dump.status = (int8_t *) malloc (num_recs + 1)) == NULL)
     {
-      perror (argv[1]);
+      perror ("Allocating record list");
       exit (-1);
     }
 
+  count = 0;
+  for (i = 0 ; i < num_recs ; i++)
+    {
+      charts_image_get_metadata (dump.image, i + 1, &image_index);
 
-  image_read_header (fp, &head);
+      if (image_index.timestamp < start || image_index.timestamp > end) continue;
 
-  num_recs = head.text.number_images;
+      if (window++ % nth) continue;
 
+      if (image_index.image_size) dump.recnums[count++] = i + 1;
+    }
 
-  for (i = 0 ; i < num_recs ; i++)
+
+  /*  The workers share the mapping, so map it here before they start.  If we can't, fall back to reading the images
+      through the one FILE, which means doing them one at a time.  */
+
+  dump.mapped = 1;
+
+  if (count && charts_image_map (dump.image))
     {
-      image_get_metadata (fp, i + 1, &image_index);
+      fprintf (stderr, "Unable to map %s, reading the images one at a time instead\n", argv[optind]);
+      fflush (stderr);
+
+      dump.mapped = 0;
+      in_flight = 1;
+    }
 
-      sprintf (jpg_name, "%04d_%d_%d_%lld.jpg", image_index.image_number, image_index.byte_offset, 
-               image_index.image_size, image_index.timestamp);
 
-      if (image_index.image_size)
-        {
-          image = image_read_record_recnum (fp, i + 1, &size, &image_time);
+  /*  The pool size is what bounds the I/O in flight.  */
 
+  if ((pool = charts_pool_open (in_flight)) == NULL) exit (-1);
 
-          if ((jpg_fp = fopen (jpg_name, "wb")) == NULL)
-            {
-              perror (jpg_name);
-              exit (-1);
-            }
+  charts_pool_run (pool, count, dump_one, &dump);
 
-          fwrite (image, size, 1, jpg_fp);
+  charts_pool_close (pool);
 
-          fclose (jpg_fp);
 
-          free (image);
+  if (manifest != NULL && (mfp = fopen (manifest, "w")) == NULL)
+    {
+      perror (manifest);
+      exit (-1);
+    }
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (dump.status[i])
+        {
+          failed++;
+          continue;
+        }
+
+      if (mfp != NULL)
+        {
+          charts_image_get_metadata (dump.image, dump.recnums[i], &image_index);
+
+          if (jpg_path (&dump, &image_index, jpg_name, sizeof (jpg_name))) continue;
+
+          fprintf (mfp, "%d %d %"PRId64" %d %s\n", dump.recnums[i], image_index.image_number, image_index.timestamp,
+                   image_index.image_size, jpg_name);
         }
     }
 
-  fclose (fp);
+  if (mfp != NULL) fclose (mfp);
 
-  return (0);
+  if (failed) fprintf (stderr, "%d of %d images could not be written\n", failed, count);
+
+
+  free (dump.recnums);
+  free (dump.status);
+
+  charts_image_close (dump.image);
+
+  return (failed ? -1 : 0);
 }
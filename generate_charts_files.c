@@ -0,0 +1,619 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+#include <getopt.h>
+
+#include "FileHydroOutput.h"
+#include "FileTopoOutput.h"
+#include "FileWave.h"
+#include "FileImage.h"
+#include "FilePOSOutput.h"
+#include "FileRMSOutput.h"
+#include "FileGPSOutput.h"
+
+#ifndef NV_DEG_TO_RAD
+  #define       NV_DEG_TO_RAD   0.017453293L
+#endif
+
+#ifndef NV_RAD_TO_DEG
+  #define       NV_RAD_TO_DEG   57.2957795147195L
+#endif
+
+/*  generate_charts_files
+
+    Writes a small, made up, but realistic looking CHARTS data set for testing and for benchmark_charts_files.  The
+    same options always give byte for byte the same files.  The aircraft flies a straight line at 60 m/s and 400 m
+    with a little roll, pitch, and yaw.  The shots come off a circular scanner at 3000 Hz and the SBET is 200 Hz.
+    The data set is dated Saturday 01/03/26 and the line is centered on the end of the GPS week so the SBET, RMS,
+    and GPS times wrap from 604800 back to 0 part way through (the "midnight" case in the POS/RMS readers).
+
+    HOF, TOF, and IMG files are written in both byte orders (*_le.* and *_be.*).  The INH, SBET, RMS, and GPS
+    readers assume little endian so those are only written that way.  */
+
+
+#define SHOT_RATE       3000
+#define SBET_RATE       200
+#define IMAGE_RATE      2
+#define MARGIN          10          /*  Seconds of navigation before and after the line.  */
+#define SPEED           60.0
+#define ALTITUDE        400.0
+#define HEADING         (45.0 * NV_DEG_TO_RAD)
+#define SCAN_ANGLE      20.0
+#define EARTH_RADIUS    6378137.0
+#define START_LAT       30.0
+#define START_LON       -80.0
+#define WEEK_SECONDS    604800
+
+
+/*  Our own generator so the files don't depend on the C library's rand.  */
+
+static uint64_t l_seed = 0x2545f4914f6cdd1dULL;
+
+static double uniform ()
+{
+  l_seed ^= l_seed >> 12;
+  l_seed ^= l_seed << 25;
+  l_seed ^= l_seed >> 27;
+
+  return ((double) ((l_seed * 0x2545f4914f6cdd1dULL) >> 11) / 9007199254740992.0);
+}
+
+
+/*  Aircraft position and attitude "t" seconds after the start of the navigation.  Angles are in radians.  */
+
+typedef struct
+{
+  double     lat, lon, alt, roll, pitch, heading;
+} TRAJ_T;
+
+static void trajectory (double t, TRAJ_T *traj)
+{
+  double     dist = SPEED * t;
+
+
+  traj->lat = START_LAT * NV_DEG_TO_RAD + dist * cos (HEADING) / EARTH_RADIUS;
+  traj->lon = START_LON * NV_DEG_TO_RAD + dist * sin (HEADING) / (EARTH_RADIUS * cos (START_LAT * NV_DEG_TO_RAD));
+  traj->alt = ALTITUDE + 2.0 * sin (0.1 * t);
+  traj->roll = 0.02 * sin (0.5 * t);
+  traj->pitch = 0.01 * cos (0.3 * t);
+  traj->heading = HEADING + 0.005 * sin (0.2 * t);
+}
+
+
+/*  Where shot "i" hits the ground, in degrees.  */
+
+static void shot_position (double t, int32_t i, double *lat, double *lon, float *azimuth)
+{
+  TRAJ_T     traj;
+  double     az, radius, north, east;
+
+
+  trajectory (t, &traj);
+
+  az = fmod ((double) i * 2.0 * M_PI / 300.0, 2.0 * M_PI);
+  radius = traj.alt * tan (SCAN_ANGLE * NV_DEG_TO_RAD + traj.roll * cos (az));
+
+  north = radius * cos (traj.heading + az);
+  east = radius * sin (traj.heading + az);
+
+  *lat = (traj.lat + north / EARTH_RADIUS) * NV_RAD_TO_DEG;
+  *lon = (traj.lon + east / (EARTH_RADIUS * cos (traj.lat))) * NV_RAD_TO_DEG;
+  *azimuth = (float) (az * NV_RAD_TO_DEG);
+}
+
+
+/*  Writes the ASCII header for "text", the "EOF" line, and zeros out to "header_size".  */
+
+static int32_t write_text_header (FILE *fp, CHARTS_HEADER_TABLE_T *table, void *text, int32_t header_size)
+{
+  fseeko64 (fp, 0LL, SEEK_SET);
+
+  charts_header_write (fp, table, text);
+  fprintf (fp, "EOF\n");
+
+  if (ftello64 (fp) > header_size) return (-1);
+
+  while (ftello64 (fp) < header_size) fputc (0, fp);
+
+  return (0);
+}
+
+
+static FILE *create (char *dir, char *name, char *path)
+{
+  FILE       *fp;
+
+
+  sprintf (path, "%s/%s", dir, name);
+
+  if ((fp = fopen64 (path, "wb")) == NULL) perror (path);
+
+  return (fp);
+}
+
+
+/*  Fills in the bits of the ASCII header that are common to all of the line files.  */
+
+#define FILL_TEXT(text, type, little, start, end)                       \
+  do                                                                    \
+    {                                                                   \
+      strcpy ((text).file_type, (type));                                \
+      (text).endian = (little);                                         \
+      (text).software_version = 2.0;                                    \
+      (text).file_version = 2.0;                                        \
+      strcpy ((text).project, "GENERATED");                             \
+      strcpy ((text).mission, "MD260103");                              \
+      strcpy ((text).dataset, "DS260103");                              \
+      strcpy ((text).flightline_number, "0001_1");                      \
+      (text).coded_fl_number = 1;                                       \
+      strcpy ((text).flight_date, "20260103");                          \
+      (text).start_timestamp = (start);                                 \
+      (text).end_timestamp = (end);                                     \
+      strcpy ((text).dataset_create_date, "20260104");                  \
+      strcpy ((text).dataset_create_time, "12:00:00");                  \
+    } while (0)
+
+
+static int32_t write_hof (char *dir, char *name, uint8_t little, int32_t num_shots, int64_t start, double t0)
+{
+  HOF_HEADER_T         *head;
+  CHARTS_HOF_T         *hof;
+  CHARTS_HOF_APPEND_T  *app;
+  HYDRO_OUTPUT_T       record;
+  FILE                 *fp;
+  TRAJ_T               traj;
+  char                 path[1024];
+  double               t;
+  float                azimuth;
+  int32_t              i;
+
+
+  if ((fp = create (dir, name, path)) == NULL) return (-1);
+
+  head = (HOF_HEADER_T *) calloc (1, sizeof (HOF_HEADER_T));
+
+  FILL_TEXT (head->text, "HOF", little, start, start + (int64_t) (num_shots - 1) * 1000000 / SHOT_RATE);
+  head->text.header_size = HOF_HEAD_SIZE;
+  head->text.text_block_size = HOF_HEAD_TEXT_BLK_SIZE;
+  head->text.bin_block_size = HOF_HEAD_BIN_BLK_SIZE;
+  head->text.record_size = sizeof (HYDRO_OUTPUT_T);
+  head->text.ab_system_type = 1;
+  head->text.ab_system_number = 1;
+  head->text.system_rep_rate = SHOT_RATE;
+  head->text.number_shots = 0;
+
+  write_text_header (fp, &charts_hof_header_table, &head->text, HOF_HEAD_SIZE);
+
+  fclose (fp);
+  free (head);
+
+
+  l_seed = 0x4f4f48ULL;
+
+  if ((hof = charts_hof_open (path)) == NULL || (app = charts_hof_append_open (hof, 1)) == NULL) return (-1);
+
+  for (i = 0 ; i < num_shots ; i++)
+    {
+      memset (&record, 0, sizeof (HYDRO_OUTPUT_T));
+
+      t = t0 + (double) i / SHOT_RATE;
+      trajectory (t, &traj);
+
+      record.timestamp = start + (int64_t) i * 1000000 / SHOT_RATE;
+      shot_position (t, i, &record.latitude, &record.longitude, &azimuth);
+      record.sec_latitude = record.latitude;
+      record.sec_longitude = record.longitude;
+      record.correct_depth = (float) (-8.0 - 6.0 * sin (t * 0.05) - uniform () * 0.3);
+      record.correct_sec_depth = record.correct_depth - 0.5;
+      record.abdc = uniform () < 0.9 ? 72 : 13;
+      record.sec_abdc = 13;
+      record.data_type = 1;
+      record.nadir_angle = SCAN_ANGLE;
+      record.scanner_azimuth = azimuth;
+      record.altitude = (float) traj.alt;
+      record.classification_status = record.abdc >= 70 ? 40 : 1;
+
+      charts_hof_append (app, &record, 1);
+    }
+
+  charts_hof_append_close (app);
+  charts_hof_close (hof);
+
+  return (0);
+}
+
+
+static int32_t write_tof (char *dir, char *name, uint8_t little, int32_t num_shots, int64_t start, double t0)
+{
+  TOF_HEADER_T         *head;
+  CHARTS_TOF_T         *tof;
+  CHARTS_TOF_APPEND_T  *app;
+  TOPO_OUTPUT_T        record;
+  FILE                 *fp;
+  TRAJ_T               traj;
+  char                 path[1024];
+  double               t, ground;
+  float                azimuth;
+  int32_t              i;
+
+
+  if ((fp = create (dir, name, path)) == NULL) return (-1);
+
+  head = (TOF_HEADER_T *) calloc (1, sizeof (TOF_HEADER_T));
+
+  FILL_TEXT (head->text, "TOF", little, start, start + (int64_t) (num_shots - 1) * 1000000 / SHOT_RATE);
+  head->text.header_size = TOF_HEAD_SIZE;
+  head->text.text_block_size = TOF_HEAD_TEXT_BLK_SIZE;
+  head->text.bin_block_size = TOF_HEAD_BIN_BLK_SIZE;
+  head->text.record_size = sizeof (TOPO_OUTPUT_T);
+  head->text.ab_system_type = 1;
+  head->text.ab_system_number = 1;
+  head->text.system_rep_rate = SHOT_RATE;
+
+  write_text_header (fp, &charts_tof_header_table, &head->text, TOF_HEAD_SIZE);
+
+  fclose (fp);
+  free (head);
+
+
+  l_seed = 0x464f54ULL;
+
+  if ((tof = charts_tof_open (path)) == NULL || (app = charts_tof_append_open (tof, 1)) == NULL) return (-1);
+
+  for (i = 0 ; i < num_shots ; i++)
+    {
+      memset (&record, 0, sizeof (TOPO_OUTPUT_T));
+
+      t = t0 + (double) i / SHOT_RATE;
+      trajectory (t, &traj);
+
+      record.timestamp = start + (int64_t) i * 1000000 / SHOT_RATE;
+      shot_position (t, i, &record.latitude_last, &record.longitude_last, &azimuth);
+      record.latitude_first = record.latitude_last;
+      record.longitude_first = record.longitude_last;
+
+      ground = 3.0 + 2.0 * sin (t * 0.07);
+      record.elevation_last = (float) (ground + uniform () * 0.1);
+      record.elevation_first = record.elevation_last + (uniform () < 0.3 ? (float) (uniform () * 15.0) : 0.0);
+      record.scanner_azimuth = azimuth;
+      record.nadir_angle = SCAN_ANGLE;
+      record.conf_first = record.conf_last = 80;
+      record.intensity_first = (uint8_t) (uniform () * 255.0);
+      record.intensity_last = (uint8_t) (uniform () * 255.0);
+      record.classification_status = 2;
+      record.altitude = (float) traj.alt;
+
+      charts_tof_append (app, &record, 1);
+    }
+
+  charts_tof_append_close (app);
+  charts_tof_close (tof);
+
+  return (0);
+}
+
+
+/*  Waveform sizes.  ShotDataSize includes the timestamp and (as GCS does from file version 1.5 on) the 8 unused
+    bytes at the end of each record, so the reader takes 16 off of it.  */
+
+#define WAVE_SHOT       120
+#define WAVE_PMT        500
+#define WAVE_APD        200
+#define WAVE_IR         200
+#define WAVE_RAMAN      200
+#define WAVE_HEAD_SIZE  (20 * 1024)
+
+static int32_t write_inh (char *dir, char *name, int32_t num_shots, int64_t start)
+{
+  WAVE_HEADER_T        head;
+  FILE                 *fp;
+  char                 path[1024];
+  uint8_t              record[WAVE_SHOT + WAVE_PMT + WAVE_APD + WAVE_IR + WAVE_RAMAN], *wave;
+  int64_t              timestamp;
+  int32_t              i, j, k, sizes[4] = {WAVE_PMT, WAVE_APD, WAVE_IR, WAVE_RAMAN}, bottom;
+
+
+  if ((fp = create (dir, name, path)) == NULL) return (-1);
+
+  memset (&head, 0, sizeof (WAVE_HEADER_T));
+
+  FILL_TEXT (head, "INH", 1, start, start + (int64_t) (num_shots - 1) * 1000000 / SHOT_RATE);
+  head.header_size = WAVE_HEAD_SIZE;
+  head.text_block_size = 8192;
+  head.bin_block_size = 8192;
+  head.hardware_block_size = 4096;
+  head.record_size = sizeof (record);
+  head.shot_data_size = WAVE_SHOT;
+  head.wave_form_size = WAVE_PMT + WAVE_APD + WAVE_IR + WAVE_RAMAN;
+  head.pmt_size = WAVE_PMT;
+  head.apd_size = WAVE_APD;
+  head.ir_size = WAVE_IR;
+  head.raman_size = WAVE_RAMAN;
+  head.ab_system_type = 1;
+  head.ab_system_number = 1;
+  head.system_rep_rate = SHOT_RATE;
+  head.number_shots = num_shots;
+
+  write_text_header (fp, &charts_wave_header_table, &head, WAVE_HEAD_SIZE);
+
+
+  /*  A surface return and a bottom return on a decaying background, plus some noise.  */
+
+  l_seed = 0x484e49ULL;
+
+  for (i = 0 ; i < num_shots ; i++)
+    {
+      memset (record, 0, sizeof (record));
+
+      timestamp = start + (int64_t) i * 1000000 / SHOT_RATE;
+      memcpy (record, &timestamp, sizeof (int64_t));
+
+      wave = record + WAVE_SHOT;
+      bottom = 60 + (int32_t) (uniform () * 40.0);
+
+      for (j = 0 ; j < 4 ; j++)
+        {
+          for (k = 0 ; k < sizes[j] ; k++)
+            {
+              wave[k] = (uint8_t) (20.0 + 200.0 * exp (-(k - 10) * (k - 10) / 8.0) + 80.0 * exp (-(k - bottom) * (k - bottom) / 20.0) +
+                                   30.0 * exp (-k / 50.0) + uniform () * 4.0);
+            }
+          wave += sizes[j];
+        }
+
+      fwrite (record, sizeof (record), 1, fp);
+    }
+
+  fclose (fp);
+
+  return (0);
+}
+
+
+/*  The images are filler between JPEG SOI and EOI markers, between 20K and 60K each.  */
+
+static int32_t write_img (char *dir, char *name, uint8_t little, int32_t num_images, int64_t start)
+{
+  IMAGE_TEXT_T         text;
+  IMAGE_INDEX_T        *index;
+  FILE                 *fp;
+  char                 path[1024];
+  uint8_t              *data;
+  int64_t              offset;
+  int32_t              i, j, max_size = 60 * 1024;
+
+
+  if ((fp = create (dir, name, path)) == NULL) return (-1);
+
+  memset (&text, 0, sizeof (IMAGE_TEXT_T));
+
+  FILL_TEXT (text, "IMG", little, start, start + (int64_t) (num_images - 1) * 1000000 / IMAGE_RATE);
+  text.header_size = IMAGE_HEAD_SIZE;
+  text.text_block_size = IMAGE_HEAD_TEXT_BLK_SIZE;
+  text.bin_block_size = IMAGE_HEAD_BIN_BLK_SIZE;
+  text.number_images = num_images;
+  text.record_size = sizeof (IMAGE_INDEX_T);
+  text.block_size = num_images * sizeof (IMAGE_INDEX_T);
+
+  write_text_header (fp, &charts_image_header_table, &text, IMAGE_HEAD_SIZE);
+
+
+  index = (IMAGE_INDEX_T *) calloc (num_images, sizeof (IMAGE_INDEX_T));
+  data = (uint8_t *) malloc (max_size);
+
+  l_seed = 0x474d49ULL;
+
+  offset = IMAGE_HEAD_SIZE + (int64_t) num_images * sizeof (IMAGE_INDEX_T);
+
+  for (i = 0 ; i < num_images ; i++)
+    {
+      index[i].timestamp = start + (int64_t) i * 1000000 / IMAGE_RATE;
+      index[i].byte_offset = offset;
+      index[i].image_size = 20 * 1024 + (int32_t) (uniform () * 40.0 * 1024.0);
+      index[i].image_number = i + 1;
+
+      offset += index[i].image_size;
+    }
+
+  for (i = 0 ; i < num_images ; i++)
+    {
+      IMAGE_INDEX_T   entry = index[i];
+
+      if (!little)
+        {
+          charts_swap_int64_t (&entry.timestamp);
+          charts_swap_int64_t (&entry.byte_offset);
+          charts_swap_int32_t (&entry.image_size);
+          charts_swap_int32_t (&entry.image_number);
+        }
+
+      fwrite (&entry, sizeof (IMAGE_INDEX_T), 1, fp);
+    }
+
+  for (i = 0 ; i < num_images ; i++)
+    {
+      for (j = 0 ; j < index[i].image_size ; j++) data[j] = (uint8_t) (uniform () * 256.0);
+
+      data[0] = 0xff;
+      data[1] = 0xd8;
+      data[index[i].image_size - 2] = 0xff;
+      data[index[i].image_size - 1] = 0xd9;
+
+      fwrite (data, index[i].image_size, 1, fp);
+    }
+
+  fclose (fp);
+  free (index);
+  free (data);
+
+  return (0);
+}
+
+
+/*  SBET, smrmsg, and GPS files.  "sow" is the GPS seconds of week of the first record.  */
+
+static int32_t write_nav (char *dir, double seconds, double sow)
+{
+  POS_OUTPUT_T         pos;
+  RMS_OUTPUT_T         rms;
+  GPS_OUTPUT_T         gps;
+  TRAJ_T               traj, next;
+  FILE                 *fp;
+  char                 path[1024];
+  double               t, dt = 1.0 / SBET_RATE;
+  int32_t              i, num;
+
+
+  if ((fp = create (dir, "sbet_260103_0001.out", path)) == NULL) return (-1);
+
+  num = (int32_t) (seconds * SBET_RATE);
+
+  for (i = 0 ; i < num ; i++)
+    {
+      memset (&pos, 0, sizeof (POS_OUTPUT_T));
+
+      t = (double) i * dt;
+      trajectory (t, &traj);
+      trajectory (t + dt, &next);
+
+      pos.gps_time = fmod (sow + t, (double) WEEK_SECONDS);
+      pos.latitude = traj.lat;
+      pos.longitude = traj.lon;
+      pos.altitude = traj.alt;
+      pos.x_velocity = SPEED * cos (HEADING);
+      pos.y_velocity = SPEED * sin (HEADING);
+      pos.z_velocity = (next.alt - traj.alt) / dt;
+      pos.roll = traj.roll;
+      pos.pitch = traj.pitch;
+      pos.platform_heading = traj.heading;
+      pos.x_body_ang_rate = (next.roll - traj.roll) / dt;
+      pos.y_body_ang_rate = (next.pitch - traj.pitch) / dt;
+      pos.z_body_ang_rate = (next.heading - traj.heading) / dt;
+      pos.z_body_accel = -9.8;
+
+      fwrite (&pos, sizeof (POS_OUTPUT_T), 1, fp);
+    }
+
+  fclose (fp);
+
+
+  if ((fp = create (dir, "smrmsg_260103_0001.out", path)) == NULL) return (-1);
+
+  for (i = 0 ; i < (int32_t) seconds ; i++)
+    {
+      rms.gps_time = fmod (sow + i, (double) WEEK_SECONDS);
+      rms.north_pos_rms = rms.south_pos_rms = 0.05;
+      rms.down_pos_rms = 0.08;
+      rms.north_vel_rms = rms.south_vel_rms = rms.down_vel_rms = 0.01;
+      rms.roll_rms = rms.pitch_rms = 0.3;
+      rms.heading_rms = 1.2;
+
+      fwrite (&rms, sizeof (RMS_OUTPUT_T), 1, fp);
+    }
+
+  fclose (fp);
+
+
+  if ((fp = create (dir, "gps_260103_0001.out", path)) == NULL) return (-1);
+
+  for (i = 0 ; i < (int32_t) seconds ; i++)
+    {
+      memset (&gps, 0, sizeof (GPS_OUTPUT_T));
+
+      gps.gps_time = fmod (sow + i, (double) WEEK_SECONDS);
+      gps.Time1 = gps.gps_time;
+      gps.Time2 = 3600.0 + i;
+      gps.HDOP = 0.9;
+      gps.VDOP = 1.4;
+      gps.TimeType = 0x24;
+      gps.Mode = 7;
+      gps.num_sats = 11;
+      gps.week = sow + i < WEEK_SECONDS ? 2399 : 2400;
+
+      fwrite (&gps, sizeof (GPS_OUTPUT_T), 1, fp);
+    }
+
+  fclose (fp);
+
+  return (0);
+}
+
+
+static void usage ()
+{
+  fprintf (stderr, "\n\nUsage: generate_charts_files [-n NUMBER_SHOTS] DIRECTORY\n\n");
+  fprintf (stderr, "  -n  Number of shots in the HOF, TOF, and INH files (default 100000)\n\n");
+  exit (-1);
+}
+
+
+int32_t main (int32_t argc, char *argv[])
+{
+  int32_t             c, num_shots = 100000, num_images, ret = 0;
+  int64_t             week, start;
+  double              line_seconds, sow;
+  char                *dir;
+
+
+  while ((c = getopt (argc, argv, "n:")) != -1)
+    {
+      switch (c)
+        {
+        case 'n':
+          num_shots = atoi (optarg);
+          break;
+
+        default:
+          usage ();
+        }
+    }
+
+  if (optind >= argc || num_shots < SHOT_RATE) usage ();
+
+  dir = argv[optind];
+
+
+  /*  GPS week base the same way the navigation readers get it from the file name, then center the line on the
+      end of the week.  */
+
+  week = charts_utc_time (2026, 1, 3);
+  week -= (((week / 86400) + 4) % 7) * 86400;
+
+  line_seconds = (double) num_shots / SHOT_RATE;
+  sow = (double) WEEK_SECONDS - MARGIN - floor (line_seconds / 2.0);
+  start = (week + (int64_t) sow + MARGIN) * 1000000;
+
+  num_images = (int32_t) (line_seconds * IMAGE_RATE);
+
+
+  ret |= write_nav (dir, line_seconds + 2 * MARGIN, sow);
+  ret |= write_hof (dir, "line_le.hof", 1, num_shots, start, MARGIN);
+  ret |= write_hof (dir, "line_be.hof", 0, num_shots, start, MARGIN);
+  ret |= write_tof (dir, "line_le.tof", 1, num_shots, start, MARGIN);
+  ret |= write_tof (dir, "line_be.tof", 0, num_shots, start, MARGIN);
+  ret |= write_inh (dir, "line.inh", num_shots, start);
+  ret |= write_img (dir, "line_le.img", 1, num_images, start);
+  ret |= write_img (dir, "line_be.img", 0, num_images, start);
+
+  return (ret ? -1 : 0);
+}
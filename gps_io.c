@@ -23,9 +23,22 @@
 
 #include "FileGPSOutput.h"
 
-static uint8_t swap = 1;
-static int64_t start_timestamp, end_timestamp, start_week;
-static int32_t year, month, day, start_record, end_record;
+/*  Per file state for the handle based calls (charts_gps_*).  The FILE based calls are thin wrappers around
+    these that use "l_gps" so they behave the way they always have, one GPS file at a time.  */
+
+struct CHARTS_GPS
+{
+  FILE             *fp;
+  uint8_t          swap;
+  int64_t          start_timestamp;
+  int64_t          end_timestamp;
+  int64_t          start_week;
+  int32_t          start_record;
+  int32_t          end_record;
+  CHARTS_IO_STATS_T stats;
+};
+
+static CHARTS_GPS_T l_gps = {.fp = NULL, .swap = 1};
 
 
 static void charts_swap_gps (GPS_OUTPUT_T *gps)
@@ -47,104 +60,163 @@ static void charts_swap_gps (GPS_OUTPUT_T *gps)
 }
 
 
-FILE *open_gps_file (char *path)
+/*  Opens the file and sets up "nav".  Returns the FILE pointer or NULL on failure.  */
+
+static FILE *gps_load (CHARTS_GPS_T *nav, char *path)
 {
   FILE                   *fp;
   GPS_OUTPUT_T           gps;
-  time_t                 tv_sec;
-  struct tm              tm;
-  static int32_t         tz_set = 0;
+  int64_t                tv_sec;
+  int32_t                year, month, day;
+  double                 start;
 
 
   int32_t big_endian ();
 
 
-  sscanf (&path[strlen (path) - 15], "%02d%02d%02d", &year, &month, &day);
-
-
-  /*  tm struct wants years since 1900!!!  */
+  memset (&nav->stats, 0, sizeof (CHARTS_IO_STATS_T));
+  start = charts_io_stats_clock ();
 
-  tm.tm_year = year + 100;
-  tm.tm_mon = month - 1;
-  tm.tm_mday = day;
-  tm.tm_hour = 0.0;
-  tm.tm_min = 0.0;
-  tm.tm_sec = 0.0;
-  tm.tm_isdst = -1;
 
-  if (!tz_set)
-    {
-#ifdef NVWIN3X
-  #if defined (__MINGW64__) || defined (__MINGW32__)
-      _putenv("TZ=GMT");
-      _tzset();
-  #else
-      _putenv("TZ=GMT");
-      _tzset();
-  #endif
-#else
-      putenv("TZ=GMT");
-      tzset();
-#endif
-      tz_set = 1;
-    }
+  sscanf (&path[strlen (path) - 15], "%02d%02d%02d", &year, &month, &day);
 
 
-  /*  Get seconds from the epoch (01-01-1970) for the date in the filename. 
-      This will also give us the day of the week for the GPS seconds of
-      week calculation.  */
+  /*  Get seconds from the epoch (01-01-1970) for the date in the filename.  */
 
-  tv_sec = mktime (&tm);
+  tv_sec = charts_utc_time (year + 2000, month, day);
 
 
-  /*  Subtract the number of days since Saturday midnight (Sunday morning) in seconds.  */
+  /*  Subtract the number of days since Saturday midnight (Sunday morning) in seconds.  01-01-1970 was a Thursday.  */
 
-  tv_sec = tv_sec - (tm.tm_wday * 86400);
-  start_week = tv_sec;
+  tv_sec = tv_sec - (((tv_sec / 86400) + 4) % 7) * 86400;
+  nav->start_week = tv_sec;
 
 
   /*  We have to assume that the file is little endian since there is no
       header and no field that we can use to deduce what it is.  */
 
-  swap = (uint8_t) big_endian ();
+  nav->swap = (uint8_t) big_endian ();
 
 
   if ((fp = fopen (path, "rb")) == NULL)
     {
+      nav->fp = NULL;
       return ((FILE *) NULL);
     }
   else
     {
       fread (&gps, sizeof (GPS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_gps (&gps);
-      start_timestamp = (int64_t) (((double) start_week + gps.gps_time) * 1000000.0);
-      start_record = 0;
+      if (nav->swap) charts_swap_gps (&gps);
+      nav->start_timestamp = (int64_t) (((double) nav->start_week + gps.gps_time) * 1000000.0);
+      nav->start_record = 0;
 
 
       fseeko64 (fp, -sizeof (GPS_OUTPUT_T), SEEK_END);
 
       fread (&gps, sizeof (GPS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_gps (&gps);
-      end_timestamp = (int64_t) (((double) start_week + gps.gps_time) * 1000000.0);
+      if (nav->swap) charts_swap_gps (&gps);
+      nav->end_timestamp = (int64_t) (((double) nav->start_week + gps.gps_time) * 1000000.0);
 
-      end_record = ftell (fp) / sizeof (GPS_OUTPUT_T);
+      nav->end_record = ftell (fp) / sizeof (GPS_OUTPUT_T);
 
       fseek (fp, 0, SEEK_SET);
     }
 
+  nav->fp = fp;
+
+  CHARTS_IO_COUNT (&nav->stats, header_seconds, charts_io_stats_clock () - start);
+
   return (fp);
 }
 
 
-int32_t gps_read_record (FILE *fp, GPS_OUTPUT_T *gps)
+int32_t charts_gps_read_record (CHARTS_GPS_T *nav, GPS_OUTPUT_T *gps)
 {
-  if (!fread (gps, sizeof (GPS_OUTPUT_T), 1, fp)) return (-1);
-  if (swap) charts_swap_gps (gps);
+  FILE              *fp = nav->fp;
+
+
+  if (!charts_io_read (&nav->stats, gps, sizeof (GPS_OUTPUT_T), 1, fp)) return (-1);
+  if (nav->swap)
+    {
+      charts_swap_gps (gps);
+      CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+    }
 
   return (0);
 }
 
 
+CHARTS_GPS_T *charts_gps_open (char *path)
+{
+  CHARTS_GPS_T    *nav;
+
+
+  if ((nav = (CHARTS_GPS_T *) calloc (1, sizeof (CHARTS_GPS_T))) == NULL)
+    {
+      perror ("Allocating GPS handle");
+      return (NULL);
+    }
+
+  if (gps_load (nav, path) == NULL)
+    {
+      free (nav);
+      return (NULL);
+    }
+
+  return (nav);
+}
+
+
+void charts_gps_close (CHARTS_GPS_T *nav)
+{
+  if (nav == NULL) return;
+
+  if (nav->fp != NULL) fclose (nav->fp);
+
+  free (nav);
+}
+
+
+FILE *charts_gps_fp (CHARTS_GPS_T *nav)
+{
+  return (nav->fp);
+}
+
+
+/*  I/O counters for "nav".  A NULL handle gets the counters for the FILE based calls.  */
+
+CHARTS_IO_STATS_T *charts_gps_stats (CHARTS_GPS_T *nav)
+{
+  return (nav ? &nav->stats : &l_gps.stats);
+}
+
+
+int64_t charts_gps_get_start_timestamp (CHARTS_GPS_T *nav)
+{
+  return (nav->start_timestamp);
+}
+
+
+int64_t charts_gps_get_end_timestamp (CHARTS_GPS_T *nav)
+{
+  return (nav->end_timestamp);
+}
+
+
+FILE *open_gps_file (char *path)
+{
+  return (gps_load (&l_gps, path));
+}
+
+
+int32_t gps_read_record (FILE *fp, GPS_OUTPUT_T *gps)
+{
+  l_gps.fp = fp;
+
+  return (charts_gps_read_record (&l_gps, gps));
+}
+
+
 void gps_dump_record (GPS_OUTPUT_T gps)
 {
   fprintf (stderr, "GPS seconds of week : %f\n", gps.gps_time);
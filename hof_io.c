@@ -25,15 +25,50 @@
 #include <string.h>
 #include <math.h>
 #include <errno.h>
+#include <stddef.h>
+
+#ifndef NVWIN3X
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
 
 #include "FileHydroOutput.h"
+#include "charts_edit.h"
 #include "hof_errors.h"
 
 #ifndef NV_DEG_TO_RAD
   #define       NV_DEG_TO_RAD   0.017453293L
 #endif
 
-static uint8_t swap = 1;
+/*  Per file state for the handle based calls (charts_hof_*).  The FILE based calls are thin wrappers around
+    these that use "l_hof" so they behave the way they always have, one HOF file at a time.  */
+
+struct CHARTS_HOF
+{
+  FILE             *fp;
+  uint8_t          swap;
+  int32_t          num_records;
+  HOF_HEADER_T     head;
+  CHARTS_IO_STATS_T stats;
+};
+
+static CHARTS_HOF_T l_hof = {.fp = NULL, .swap = 1};
+
+
+/*  Memory mapped HOF file.  The records after HOF_HEAD_SIZE are used in place.  If the file is of the other
+    endianness the mapping is private (copy-on-write) and all of the records are swapped once when it's opened, so
+    the mapping never changes after charts_hof_map_open returns.  */
+
+struct CHARTS_HOF_MAP
+{
+  HOF_HEADER_T     head;
+  uint8_t          swap;
+  int32_t          num_records;
+  int64_t          map_size;
+  uint8_t          *map;
+  HYDRO_OUTPUT_T   *records;
+};
 
 
 static void charts_swap_hof_header (HOF_HEADER_T *head)
@@ -77,64 +112,27 @@ static void charts_swap_hof_header (HOF_HEADER_T *head)
 }
 
 
-static void charts_swap_hof_record (HYDRO_OUTPUT_T *record)
+/*  The byte swapped fields of HYDRO_OUTPUT_T.  future_use through warnings3 is one run of 27 floats and 5 int32s and
+    bot_bin_first through sec_bot_bin_used_apd is one run of 6 int16s.  */
+
+static const CHARTS_SWAP_RUN_T hof_swap_runs[] =
 {
-  int16_t i;
+  {offsetof (HYDRO_OUTPUT_T, timestamp), 8, 1},
+  {offsetof (HYDRO_OUTPUT_T, haps_version), 2, 2},
+  {offsetof (HYDRO_OUTPUT_T, latitude), 8, 4},
+  {offsetof (HYDRO_OUTPUT_T, correct_depth), 4, 2},
+  {offsetof (HYDRO_OUTPUT_T, abdc), 2, 2},
+  {offsetof (HYDRO_OUTPUT_T, future_use), 4, 32},
+  {offsetof (HYDRO_OUTPUT_T, calc_bfom_thresh_times10), 2, 2},
+  {offsetof (HYDRO_OUTPUT_T, bot_bin_first), 2, 6}
+};
 
 
-  charts_swap_int64_t (&record->timestamp);
-  charts_swap_int16_t (&record->haps_version);
-  charts_swap_int16_t (&record->position_conf);
-  charts_swap_double (&record->latitude);
-  charts_swap_double (&record->longitude);
-  charts_swap_double (&record->sec_latitude);
-  charts_swap_double (&record->sec_longitude);
-  charts_swap_float (&record->correct_depth);
-  charts_swap_float (&record->correct_sec_depth);
-  charts_swap_int16_t (&record->abdc);
-  charts_swap_int16_t (&record->sec_abdc);
-
-  for (i = 0 ; i < 2 ; i++) charts_swap_float (&record->future_use[i]);
-
-  charts_swap_float (&record->tide_cor_depth);
-  charts_swap_float (&record->reported_depth);
-  charts_swap_float (&record->result_depth);
-  charts_swap_float (&record->sec_depth);
-  charts_swap_float (&record->wave_height);
-  charts_swap_float (&record->elevation);
-  charts_swap_float (&record->topo);
-  charts_swap_float (&record->altitude);
-  charts_swap_float (&record->kgps_elevation);
-  charts_swap_float (&record->kgps_res_elev);
-  charts_swap_float (&record->kgps_sec_elev);
-  charts_swap_float (&record->kgps_topo);
-  charts_swap_float (&record->kgps_datum);
-  charts_swap_float (&record->kgps_water_level);
-  charts_swap_float (&record->k);
-  charts_swap_float (&record->intensity);
-  charts_swap_float (&record->bot_conf);
-  charts_swap_float (&record->sec_bot_conf);
-  charts_swap_float (&record->nadir_angle);
-  charts_swap_float (&record->scanner_azimuth);
-  charts_swap_float (&record->sfc_fom_apd);
-  charts_swap_float (&record->sfc_fom_ir);
-  charts_swap_float (&record->sfc_fom_ram);
-  charts_swap_float (&record->no_bottom_at);
-  charts_swap_float (&record->no_bottom_at2);
-  charts_swap_int32_t (&record->depth_conf);
-  charts_swap_int32_t (&record->sec_depth_conf);
-  charts_swap_int32_t (&record->warnings);
-  charts_swap_int32_t (&record->warnings2);
-  charts_swap_int32_t (&record->warnings3);
-
-  for (i = 0 ; i < 2 ; i++) charts_swap_int16_t ((int16_t *) &record->calc_bfom_thresh_times10[i]);
-
-  charts_swap_int16_t (&record->bot_bin_first);
-  charts_swap_int16_t (&record->bot_bin_second);
-  charts_swap_int16_t (&record->bot_bin_used_pmt);
-  charts_swap_int16_t (&record->sec_bot_bin_used_pmt);
-  charts_swap_int16_t (&record->bot_bin_used_apd);
-  charts_swap_int16_t (&record->sec_bot_bin_used_apd);
+/*  Swaps "count" contiguous HOF records in place.  */
+
+void charts_swap_hof_records (HYDRO_OUTPUT_T *records, size_t count)
+{
+  charts_swap_records (records, count, sizeof (HYDRO_OUTPUT_T), hof_swap_runs, sizeof (hof_swap_runs) / sizeof (CHARTS_SWAP_RUN_T));
 }
 
 
@@ -161,24 +159,58 @@ FILE *open_hof_file (char *path)
 }
 
 
-int32_t hof_read_header (FILE *fp, HOF_HEADER_T *head)
-{
-  int64_t      long_pos;
-  char         varin[1024], info[1024];
-  int16_t      tmpi16;
-
+/*  Keys of the ASCII header, in the order they're written.  */
 
-  char *ngets (char *s, int32_t size, FILE *stream);
+static const CHARTS_HEADER_FIELD_T hof_header_fields[] =
+{
+  CHARTS_HEADER_FIELD ("FileType",               CHARTS_HEADER_STRING, HOF_TEXT_T, file_type),
+  CHARTS_HEADER_FIELD ("EndianType",             CHARTS_HEADER_ENDIAN, HOF_TEXT_T, endian),
+  CHARTS_HEADER_FIELD ("SoftwareVersionNumber",  CHARTS_HEADER_FLOAT,  HOF_TEXT_T, software_version),
+  CHARTS_HEADER_FIELD ("FileVersionNumber",      CHARTS_HEADER_FLOAT,  HOF_TEXT_T, file_version),
+  CHARTS_HEADER_FIELD ("Processed By",           CHARTS_HEADER_STRING, HOF_TEXT_T, UserName),
+  CHARTS_HEADER_FIELD ("HeaderSize",             CHARTS_HEADER_INT32,  HOF_TEXT_T, header_size),
+  CHARTS_HEADER_FIELD ("TextBlockSize",          CHARTS_HEADER_INT32,  HOF_TEXT_T, text_block_size),
+  CHARTS_HEADER_FIELD ("BinaryBlockSize",        CHARTS_HEADER_INT32,  HOF_TEXT_T, bin_block_size),
+  CHARTS_HEADER_FIELD ("RecordSize",             CHARTS_HEADER_INT32,  HOF_TEXT_T, record_size),
+  CHARTS_HEADER_FIELD ("ABSystemType",           CHARTS_HEADER_INT8,   HOF_TEXT_T, ab_system_type),
+  CHARTS_HEADER_FIELD ("ABSystemNumber",         CHARTS_HEADER_INT8,   HOF_TEXT_T, ab_system_number),
+  CHARTS_HEADER_FIELD ("SystemRepRate",          CHARTS_HEADER_INT16,  HOF_TEXT_T, system_rep_rate),
+  CHARTS_HEADER_FIELD ("Project",                CHARTS_HEADER_STRING, HOF_TEXT_T, project),
+  CHARTS_HEADER_FIELD ("Mission",                CHARTS_HEADER_STRING, HOF_TEXT_T, mission),
+  CHARTS_HEADER_FIELD ("Dataset",                CHARTS_HEADER_STRING, HOF_TEXT_T, dataset),
+  CHARTS_HEADER_FIELD ("FlightlineNumber",       CHARTS_HEADER_STRING, HOF_TEXT_T, flightline_number),
+  CHARTS_HEADER_FIELD ("CodedFLNumber",          CHARTS_HEADER_INT16,  HOF_TEXT_T, coded_fl_number),
+  CHARTS_HEADER_FIELD ("FlightDate",             CHARTS_HEADER_STRING, HOF_TEXT_T, flight_date),
+  CHARTS_HEADER_FIELD ("StartTime",              CHARTS_HEADER_STRING, HOF_TEXT_T, start_time),
+  CHARTS_HEADER_FIELD ("EndTime",                CHARTS_HEADER_STRING, HOF_TEXT_T, end_time),
+  CHARTS_HEADER_FIELD ("StartTimestamp",         CHARTS_HEADER_INT64,  HOF_TEXT_T, start_timestamp),
+  CHARTS_HEADER_FIELD ("EndTimestamp",           CHARTS_HEADER_INT64,  HOF_TEXT_T, end_timestamp),
+  CHARTS_HEADER_FIELD ("NumberShots",            CHARTS_HEADER_INT32,  HOF_TEXT_T, number_shots),
+  CHARTS_HEADER_FIELD ("FileCreateDate",         CHARTS_HEADER_STRING, HOF_TEXT_T, dataset_create_date),
+  CHARTS_HEADER_FIELD ("FileCreateTime",         CHARTS_HEADER_STRING, HOF_TEXT_T, dataset_create_time),
+  CHARTS_HEADER_FIELD ("LineMinLat",             CHARTS_HEADER_DOUBLE, HOF_TEXT_T, line_min_lat),
+  CHARTS_HEADER_FIELD ("LineMaxLat",             CHARTS_HEADER_DOUBLE, HOF_TEXT_T, line_max_lat),
+  CHARTS_HEADER_FIELD ("LineMinLong",            CHARTS_HEADER_DOUBLE, HOF_TEXT_T, line_min_lon),
+  CHARTS_HEADER_FIELD ("LineMaxLong",            CHARTS_HEADER_DOUBLE, HOF_TEXT_T, line_max_lon)
+};
+
+CHARTS_HEADER_TABLE_T charts_hof_header_table = CHARTS_HEADER_TABLE (hof_header_fields);
+
+
+/*  Parses the ASCII header and sets "l_swap" from the EndianType entry.  This is shared by hof_read_header,
+    charts_hof_open, and the mapped reader so that each keeps its own swap state.  */
+
+static int32_t hof_parse_header (FILE *fp, HOF_HEADER_T *head, uint8_t *l_swap)
+{
   int32_t big_endian ();
 
 
-  swap = 0;
+  *l_swap = 0;
 
 
   fseeko64 (fp, 0LL, SEEK_SET);
 
 
-
   /*  Read each entry.    */
 
   head->text.header_size = 0;
@@ -186,110 +218,182 @@ int32_t hof_read_header (FILE *fp, HOF_HEADER_T *head)
   head->text.line_max_lat = 0.0;
   head->text.line_min_lon = 0.0;
   head->text.line_max_lon = 0.0;
-  while (ngets (varin, sizeof (varin), fp) != NULL)
+
+  if (charts_header_read (fp, &charts_hof_header_table, &head->text, &head->text.header_size))
+    *l_swap = (head->text.endian == big_endian ());
+
+
+  /*  Make sure we're past the header.  */
+
+  fseeko64 (fp, (int64_t) head->text.header_size, SEEK_SET);
+
+
+  return (0);
+}
+
+
+/*  Opens a HOF file (read/write if possible) and reads the header.  Returns NULL on failure.  */
+
+CHARTS_HOF_T *charts_hof_open (char *path)
+{
+  CHARTS_HOF_T    *hof;
+  int64_t         file_size;
+  double          start;
+
+
+  if ((hof = (CHARTS_HOF_T *) calloc (1, sizeof (CHARTS_HOF_T))) == NULL)
     {
-      if (!strcmp (varin, "EOF")) break;
+      perror ("Allocating HOF handle");
+      return (NULL);
+    }
 
+  start = charts_io_stats_clock ();
 
-      /*  Put everything to the right of the colon into 'info'.   */
-            
-      if (strchr (varin, ':') != NULL) strcpy (info, (char *) (strchr (varin, ':') + 1));
+  if ((hof->fp = open_hof_file (path)) == NULL)
+    {
+      free (hof);
+      return (NULL);
+    }
 
+  hof_parse_header (hof->fp, &hof->head, &hof->swap);
 
-      /*  Check input for matching strings and load values if found.  */
-            
-      if (strstr (varin, "FileType:") != NULL) lidar_get_string (varin, head->text.file_type);
 
-      if (strstr (varin, "EndianType:") != NULL)
-        {
-          if (strstr (info, "Little")) 
-            {
-              head->text.endian = 1;
-              if (big_endian ()) swap = 1;
-            }
-          else
-            {
-              head->text.endian = 1;
-              if (!big_endian ()) swap = 1;
-            }
-        }
+  fseeko64 (hof->fp, 0LL, SEEK_END);
+  file_size = ftello64 (hof->fp);
 
+  if (file_size > HOF_HEAD_SIZE) hof->num_records = (int32_t) ((file_size - HOF_HEAD_SIZE) / (int64_t) sizeof (HYDRO_OUTPUT_T));
 
-      if (strstr (varin, "SoftwareVersionNumber:") != NULL) sscanf (info, "%f", &head->text.software_version);
+  fseeko64 (hof->fp, (int64_t) HOF_HEAD_SIZE, SEEK_SET);
 
-      if (strstr (varin, "FileVersionNumber:") != NULL) sscanf (info, "%f", &head->text.file_version);
+  CHARTS_IO_COUNT (&hof->stats, header_seconds, charts_io_stats_clock () - start);
 
 
-      if (strstr (varin, "Processed By:") != NULL) lidar_get_string (varin, head->text.UserName);
+  return (hof);
+}
 
 
-      if (strstr (varin, "HeaderSize:") != NULL) sscanf (info, "%d", &head->text.header_size);
+void charts_hof_close (CHARTS_HOF_T *hof)
+{
+  if (hof == NULL) return;
 
-      if (strstr (varin, "TextBlockSize:") != NULL) sscanf (info, "%d", &head->text.text_block_size);
+  if (hof->fp != NULL) fclose (hof->fp);
 
-      if (strstr (varin, "BinaryBlockSize:") != NULL) sscanf (info, "%d", &head->text.bin_block_size);
+  free (hof);
+}
 
-      if (strstr (varin, "RecordSize:") != NULL) sscanf (info, "%d", &head->text.record_size);
 
+FILE *charts_hof_fp (CHARTS_HOF_T *hof)
+{
+  return (hof->fp);
+}
 
-      if (strstr (varin, "ABSystemType:") != NULL)
-        {
-          sscanf (info, "%hd", &tmpi16);
-          head->text.ab_system_type = (int8_t) tmpi16;
-        }
 
-      if (strstr (varin, "ABSystemNumber:") != NULL)
-        {
-          sscanf (info, "%hd", &tmpi16);
-          head->text.ab_system_number = (int8_t) tmpi16;
-        }
+HOF_HEADER_T *charts_hof_header (CHARTS_HOF_T *hof)
+{
+  return (&hof->head);
+}
 
-      if (strstr (varin, "SystemRepRate:") != NULL) sscanf (info, "%hd", &head->text.system_rep_rate);
 
+int32_t charts_hof_num_records (CHARTS_HOF_T *hof)
+{
+  return (hof->num_records);
+}
 
-      if (strstr (varin, "Project:") != NULL) lidar_get_string (varin, head->text.project);
 
-      if (strstr (varin, "Mission:") != NULL) lidar_get_string (varin, head->text.mission);
+/*  I/O counters for "hof".  A NULL handle gets the counters for the FILE based calls.  */
+
+CHARTS_IO_STATS_T *charts_hof_stats (CHARTS_HOF_T *hof)
+{
+  return (hof ? &hof->stats : &l_hof.stats);
+}
+
+
+/*  Note that we're counting from 1 not 0.  Not my idea!  */
+
+int32_t charts_hof_read_record (CHARTS_HOF_T *hof, int32_t num, HYDRO_OUTPUT_T *record)
+{
+  int32_t ret;
+  int64_t long_pos;
+
+
+  if (!num)
+    {
+      fprintf (stderr, "Zero is not a valid HOF record number\n");
+      fflush (stderr);
+      return (0);
+    }
+
+
+  if (num != HOF_NEXT_RECORD)
+    {
+      charts_io_seek (&hof->stats, hof->fp, (int64_t) HOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (HYDRO_OUTPUT_T), SEEK_SET);
+    }
+  else
+    {
+      long_pos = ftello64 (hof->fp);
+      if (long_pos < HOF_HEAD_SIZE) charts_io_seek (&hof->stats, hof->fp, (int64_t) HOF_HEAD_SIZE, SEEK_SET);
+    }
 
-      if (strstr (varin, "Dataset:") != NULL) lidar_get_string (varin, head->text.dataset);
 
-      if (strstr (varin, "FlightlineNumber:") != NULL) lidar_get_string (varin, head->text.flightline_number);
+  ret = charts_io_read (&hof->stats, record, sizeof (HYDRO_OUTPUT_T), 1, hof->fp);
 
-      if (strstr (varin, "CodedFLNumber:") != NULL) sscanf (info, "%hd", &head->text.coded_fl_number);
 
-      if (strstr (varin, "FlightDate:") != NULL) lidar_get_string (varin, head->text.flight_date);
+  if (hof->swap)
+    {
+      charts_swap_hof_records (record, 1);
+      CHARTS_IO_COUNT (&hof->stats, swaps, 1);
+    }
 
-      if (strstr (varin, "StartTime:") != NULL) lidar_get_string (varin, head->text.start_time);
 
-      if (strstr (varin, "EndTime:") != NULL) lidar_get_string (varin, head->text.end_time);
+  return (ret);
+}
 
-      if (strstr (varin, "StartTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->text.start_timestamp);
 
-      if (strstr (varin, "EndTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->text.end_timestamp);
+/*  Reads "count" records starting at record "first" (counting from 1) into "buffer" with a single seek and read,
+    then swaps the whole batch if needed.  Returns the number of records actually read (less than "count" at the
+    end of the file).  */
 
-      if (strstr (varin, "NumberShots:") != NULL) sscanf (info, "%d", &head->text.number_shots);
+int32_t charts_hof_read_records (CHARTS_HOF_T *hof, int32_t first, int32_t count, HYDRO_OUTPUT_T *buffer)
+{
+  int32_t ret;
 
-      if (strstr (varin, "FileCreateDate:") != NULL) lidar_get_string (varin, head->text.dataset_create_date);
 
-      if (strstr (varin, "FileCreateTime:") != NULL) lidar_get_string (varin, head->text.dataset_create_time);
+  if (first < 1 || count < 1)
+    {
+      fprintf (stderr, "Invalid HOF record range %d, %d\n", first, count);
+      fflush (stderr);
+      return (0);
+    }
 
-      if (strstr (varin, "LineMinLat:") != NULL) sscanf (info, "%lf", &head->text.line_min_lat);
 
-      if (strstr (varin, "LineMaxLat:") != NULL) sscanf (info, "%lf", &head->text.line_max_lat);
+  charts_io_seek (&hof->stats, hof->fp, (int64_t) HOF_HEAD_SIZE + (int64_t) (first - 1) * (int64_t) sizeof (HYDRO_OUTPUT_T), SEEK_SET);
 
-      if (strstr (varin, "LineMinLong:") != NULL) sscanf (info, "%lf", &head->text.line_min_lon);
+  ret = charts_io_read (&hof->stats, buffer, sizeof (HYDRO_OUTPUT_T), count, hof->fp);
 
-      if (strstr (varin, "LineMaxLong:") != NULL) sscanf (info, "%lf", &head->text.line_max_lon);
 
-      long_pos = ftello64 (fp);
-      if (head->text.header_size && long_pos >= head->text.header_size) break;
+  if (hof->swap && ret > 0)
+    {
+      charts_swap_hof_records (buffer, ret);
+      CHARTS_IO_COUNT (&hof->stats, swaps, ret);
     }
 
 
-  /*  Make sure we're past the header.  */
+  return (ret);
+}
 
-  fseeko64 (fp, (int64_t) head->text.header_size, SEEK_SET);
 
+int32_t charts_hof_write_header (CHARTS_HOF_T *hof, HOF_HEADER_T *head)
+{
+  HOF_HEADER_T     l_head;
+
+
+  l_head = *head;
+
+  charts_io_seek (&hof->stats, hof->fp, 0LL, SEEK_SET);
+
+  if (hof->swap) charts_swap_hof_header (&l_head);
+
+  charts_io_write (&hof->stats, &l_head, sizeof (HOF_HEADER_T), 1, hof->fp);
 
   return (0);
 }
@@ -297,10 +401,10 @@ int32_t hof_read_header (FILE *fp, HOF_HEADER_T *head)
 
 /*  Note that we're counting from 1 not 0.  Not my idea!  */
 
-int32_t hof_read_record (FILE *fp, int32_t num, HYDRO_OUTPUT_T *record)
+int32_t charts_hof_write_record (CHARTS_HOF_T *hof, int32_t num, HYDRO_OUTPUT_T *record)
 {
-  int32_t ret;
-  int64_t long_pos;
+  int32_t ret, last;
+  HYDRO_OUTPUT_T l_record;
 
 
   if (!num)
@@ -311,64 +415,618 @@ int32_t hof_read_record (FILE *fp, int32_t num, HYDRO_OUTPUT_T *record)
     }
 
 
-  if (num != HOF_NEXT_RECORD)
+  if (num != HOF_NEXT_RECORD) charts_io_seek (&hof->stats, hof->fp, (int64_t) HOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (HYDRO_OUTPUT_T), SEEK_SET);
+
+
+  /*  Swap a copy, not the caller's record.  */
+
+  l_record = *record;
+  if (hof->swap)
     {
-      fseeko64 (fp, (int64_t) HOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (HYDRO_OUTPUT_T), SEEK_SET);
+      charts_swap_hof_records (&l_record, 1);
+      CHARTS_IO_COUNT (&hof->stats, swaps, 1);
     }
-  else
+
+
+  ret = charts_io_write (&hof->stats, &l_record, sizeof (HYDRO_OUTPUT_T), 1, hof->fp);
+
+
+  /*  Keep track of the number of records if we're extending the file.  */
+
+  last = (int32_t) ((ftello64 (hof->fp) - HOF_HEAD_SIZE) / (int64_t) sizeof (HYDRO_OUTPUT_T));
+  if (last > hof->num_records) hof->num_records = last;
+
+
+  return (ret);
+}
+
+
+/*  Buffered writer for rewriting or extending a HOF file.  Records are copied into "buffer" (so the caller's
+    records are never touched) and written CHARTS_HOF_APPEND_BLOCK at a time starting at record "next".  */
+
+struct CHARTS_HOF_APPEND
+{
+  CHARTS_HOF_T     *hof;
+  HYDRO_OUTPUT_T   *buffer;
+  int32_t          count;
+  int32_t          next;
+  int32_t          status;
+};
+
+
+static void *hof_aligned_alloc (size_t size)
+{
+  void             *ptr;
+
+
+#ifdef NVWIN3X
+  ptr = _aligned_malloc (size, 4096);
+#else
+  if (posix_memalign (&ptr, 4096, size)) ptr = NULL;
+#endif
+
+  return (ptr);
+}
+
+
+static void hof_aligned_free (void *ptr)
+{
+#ifdef NVWIN3X
+  _aligned_free (ptr);
+#else
+  free (ptr);
+#endif
+}
+
+
+/*  Starts writing records to "hof" at record "first" (HOF_NEXT_RECORD to append after the last record).
+    Returns NULL on failure.  */
+
+CHARTS_HOF_APPEND_T *charts_hof_append_open (CHARTS_HOF_T *hof, int32_t first)
+{
+  CHARTS_HOF_APPEND_T   *app;
+
+
+  if (first == HOF_NEXT_RECORD) first = hof->num_records + 1;
+
+  if (first < 1 || first > hof->num_records + 1)
+    {
+      fprintf (stderr, "Invalid HOF append record %d\n", first);
+      fflush (stderr);
+      return (NULL);
+    }
+
+
+  if ((app = (CHARTS_HOF_APPEND_T *) calloc (1, sizeof (CHARTS_HOF_APPEND_T))) == NULL ||
+      (app->buffer = (HYDRO_OUTPUT_T *) hof_aligned_alloc (CHARTS_HOF_APPEND_BLOCK * sizeof (HYDRO_OUTPUT_T))) == NULL)
     {
-      long_pos = ftello64 (fp);
-      if (long_pos < HOF_HEAD_SIZE) fseeko64 (fp, (int64_t) HOF_HEAD_SIZE, SEEK_SET);
+      perror ("Allocating HOF appender");
+      free (app);
+      return (NULL);
     }
 
+  app->hof = hof;
+  app->next = first;
 
-  ret = fread (record, sizeof (HYDRO_OUTPUT_T), 1, fp);
+  return (app);
+}
 
 
-  if (swap) charts_swap_hof_record (record);
+/*  Writes out whatever is in the buffer.  Returns 0 on success or -1 if this (or an earlier) write failed.  */
 
+int32_t charts_hof_append_flush (CHARTS_HOF_APPEND_T *app)
+{
+  if (!app->count || app->status) return (app->status);
 
-  return (ret);
+
+  if (app->hof->swap)
+    {
+      charts_swap_hof_records (app->buffer, app->count);
+      CHARTS_IO_COUNT (&app->hof->stats, swaps, app->count);
+    }
+
+  if (charts_io_seek (&app->hof->stats, app->hof->fp, (int64_t) HOF_HEAD_SIZE + (int64_t) (app->next - 1) * (int64_t) sizeof (HYDRO_OUTPUT_T), SEEK_SET) ||
+      charts_io_write (&app->hof->stats, app->buffer, sizeof (HYDRO_OUTPUT_T), app->count, app->hof->fp) != (size_t) app->count)
+    {
+      perror ("Writing HOF records");
+      app->status = -1;
+      return (-1);
+    }
+
+  app->next += app->count;
+  app->count = 0;
+
+  if (app->next - 1 > app->hof->num_records) app->hof->num_records = app->next - 1;
+
+  return (0);
 }
 
 
-int32_t hof_write_header (FILE *fp, HOF_HEADER_T head)
+/*  Adds "count" records.  Returns 0 on success or -1 on a write error.  */
+
+int32_t charts_hof_append (CHARTS_HOF_APPEND_T *app, const HYDRO_OUTPUT_T *records, int32_t count)
 {
-  fseeko64 (fp, 0LL, SEEK_SET);
+  int32_t          n;
+
+
+  while (count > 0 && !app->status)
+    {
+      n = MIN (count, CHARTS_HOF_APPEND_BLOCK - app->count);
+
+      memcpy (&app->buffer[app->count], records, n * sizeof (HYDRO_OUTPUT_T));
+
+      app->count += n;
+      records += n;
+      count -= n;
+
+      if (app->count == CHARTS_HOF_APPEND_BLOCK) charts_hof_append_flush (app);
+    }
+
+  return (app->status);
+}
+
+
+static int32_t hof_patch_failed (const char *key)
+{
+  fprintf (stderr, "Unable to update %s in the HOF header (missing or no room in the text block)\n", key);
+  fflush (stderr);
+
+
+  /*  So the caller's perror doesn't say "Success".  */
+
+  errno = EINVAL;
+
+  return (-1);
+}
+
+
+/*  Sets NumberShots, StartTimestamp and EndTimestamp in the ASCII header and num_shots, start_time and stop_time in
+    the binary (info) header from the records now in the file.  Other header entries are left alone.  Returns 0 or
+    -1 on failure, in which case the header on disk isn't changed.  */
+
+static int32_t hof_patch_header (CHARTS_HOF_T *hof)
+{
+  HOF_HEADER_T     head;
+  HYDRO_OUTPUT_T   first, last;
+  char             value[64];
+
+
+  memset (&first, 0, sizeof (HYDRO_OUTPUT_T));
+  memset (&last, 0, sizeof (HYDRO_OUTPUT_T));
+
+  if (hof->num_records > 0 && (charts_hof_read_records (hof, 1, 1, &first) != 1 ||
+                                  charts_hof_read_records (hof, hof->num_records, 1, &last) != 1)) return (-1);
+
+
+  charts_io_seek (&hof->stats, hof->fp, 0LL, SEEK_SET);
+  if (charts_io_read (&hof->stats, &head, sizeof (HOF_HEADER_T), 1, hof->fp) != 1) return (-1);
+
+
+  /*  If the ASCII header can't be made to match, don't touch the file at all.  */
+
+  sprintf (value, "%d", hof->num_records);
+  if (charts_header_patch ((char *) &head, HOF_HEAD_TEXT_BLK_SIZE, "NumberShots", value)) return (hof_patch_failed ("NumberShots"));
+
+  sprintf (value, "%"PRId64, first.timestamp);
+  if (charts_header_patch ((char *) &head, HOF_HEAD_TEXT_BLK_SIZE, "StartTimestamp", value)) return (hof_patch_failed ("StartTimestamp"));
+
+  sprintf (value, "%"PRId64, last.timestamp);
+  if (charts_header_patch ((char *) &head, HOF_HEAD_TEXT_BLK_SIZE, "EndTimestamp", value)) return (hof_patch_failed ("EndTimestamp"));
+
+
+  if (hof->swap) charts_swap_hof_header (&head);
+
+  head.info.num_shots = hof->num_records;
+  head.info.start_time = first.timestamp;
+  head.info.stop_time = last.timestamp;
+
+  hof->head.info = head.info;
+  hof->head.text.number_shots = hof->num_records;
+  hof->head.text.start_timestamp = first.timestamp;
+  hof->head.text.end_timestamp = last.timestamp;
+
+  if (hof->swap) charts_swap_hof_header (&head);
+
+
+  charts_io_seek (&hof->stats, hof->fp, 0LL, SEEK_SET);
+  if (charts_io_write (&hof->stats, &head, sizeof (HOF_HEADER_T), 1, hof->fp) != 1) return (-1);
+
+  return (fflush (hof->fp) ? -1 : 0);
+}
+
+
+/*  Flushes the buffer, updates the header to match the records in the file (see hof_patch_header) and frees the
+    appender.  The HOF handle stays open.  Returns 0 on success or -1 if anything failed.  */
+
+int32_t charts_hof_append_close (CHARTS_HOF_APPEND_T *app)
+{
+  int32_t          status;
+
+
+  if (app == NULL) return (-1);
+
+  status = charts_hof_append_flush (app);
 
-  if (swap) charts_swap_hof_header (&head);
+  if (!status && hof_patch_header (app->hof))
+    {
+      perror ("Updating HOF header");
+      status = -1;
+    }
+
+  hof_aligned_free (app->buffer);
+  free (app);
+
+  return (status);
+}
+
+
+/*  In place editing of the status, suspect_status and classification_status fields of a HOF file (see
+    charts_edit.c).  Only the pages holding changed records are written back.  */
+
+CHARTS_HOF_EDIT_T *charts_hof_edit_open (char *path)
+{
+  return (charts_edit_open (path, (int64_t) HOF_HEAD_SIZE, sizeof (HYDRO_OUTPUT_T)));
+}
+
+
+int32_t charts_hof_edit_num_records (CHARTS_HOF_EDIT_T *edit)
+{
+  return (charts_edit_num_records (edit));
+}
 
-  fwrite (&head, sizeof (HOF_HEADER_T), 1, fp);
+
+/*  Gets the status fields of record "num" (counting from 1).  Returns 0 on success or -1 if "num" is out of
+    range.  */
+
+int32_t charts_hof_edit_get (CHARTS_HOF_EDIT_T *edit, int32_t num, char *status, char *suspect_status, uint8_t *classification_status)
+{
+  if (charts_edit_get (edit, num, offsetof (HYDRO_OUTPUT_T, status), (uint8_t *) status) ||
+      charts_edit_get (edit, num, offsetof (HYDRO_OUTPUT_T, suspect_status), (uint8_t *) suspect_status) ||
+      charts_edit_get (edit, num, offsetof (HYDRO_OUTPUT_T, classification_status), classification_status)) return (-1);
 
   return (0);
 }
 
 
-/*  Note that we're counting from 1 not 0.  Not my idea!  */
+/*  Sets the fields of record "num" selected by "mask" (HOF_COLUMN_STATUS, HOF_COLUMN_SUSPECT_STATUS and/or
+    HOF_COLUMN_CLASSIFICATION_STATUS).  Nothing is written to the file until charts_hof_edit_flush or
+    charts_hof_edit_close.  Returns 0 on success or -1 if "num" is out of range.  */
+
+int32_t charts_hof_edit_set (CHARTS_HOF_EDIT_T *edit, int32_t num, uint32_t mask, char status, char suspect_status,
+                             uint8_t classification_status)
+{
+  if ((mask & HOF_COLUMN_STATUS) && charts_edit_put (edit, num, offsetof (HYDRO_OUTPUT_T, status), (uint8_t) status)) return (-1);
+
+  if ((mask & HOF_COLUMN_SUSPECT_STATUS) &&
+      charts_edit_put (edit, num, offsetof (HYDRO_OUTPUT_T, suspect_status), (uint8_t) suspect_status)) return (-1);
+
+  if ((mask & HOF_COLUMN_CLASSIFICATION_STATUS) &&
+      charts_edit_put (edit, num, offsetof (HYDRO_OUTPUT_T, classification_status), classification_status)) return (-1);
+
+  return (0);
+}
+
+
+int32_t charts_hof_edit_flush (CHARTS_HOF_EDIT_T *edit)
+{
+  return (charts_edit_flush (edit));
+}
+
+
+int32_t charts_hof_edit_close (CHARTS_HOF_EDIT_T *edit)
+{
+  return (charts_edit_close (edit));
+}
+
+
+int32_t hof_read_header (FILE *fp, HOF_HEADER_T *head)
+{
+  int32_t         ret;
+  double          start;
+
+
+  l_hof.fp = fp;
+  memset (&l_hof.stats, 0, sizeof (CHARTS_IO_STATS_T));
+
+  start = charts_io_stats_clock ();
+  ret = hof_parse_header (fp, head, &l_hof.swap);
+  CHARTS_IO_COUNT (&l_hof.stats, header_seconds, charts_io_stats_clock () - start);
+
+  return (ret);
+}
+
+
+int32_t hof_read_record (FILE *fp, int32_t num, HYDRO_OUTPUT_T *record)
+{
+  l_hof.fp = fp;
+
+  return (charts_hof_read_record (&l_hof, num, record));
+}
+
+
+int32_t hof_read_records (FILE *fp, int32_t first, int32_t count, HYDRO_OUTPUT_T *buffer)
+{
+  l_hof.fp = fp;
+
+  return (charts_hof_read_records (&l_hof, first, count, buffer));
+}
+
+
+int32_t hof_write_header (FILE *fp, HOF_HEADER_T head)
+{
+  l_hof.fp = fp;
+
+  return (charts_hof_write_header (&l_hof, &head));
+}
+
 
 int32_t hof_write_record (FILE *fp, int32_t num, HYDRO_OUTPUT_T *record)
 {
-  int32_t ret;
+  l_hof.fp = fp;
+
+  return (charts_hof_write_record (&l_hof, num, record));
+}
 
 
-  if (!num)
+
+/*  Opens a HOF file as a read-only memory map.  Returns NULL on failure.  The ASCII header is parsed the same way
+    as hof_read_header.  On Windows (NVWIN3X) the records are read into memory instead of being mapped.  If the file
+    is of the other endianness every record is swapped here, which touches every page of the file and makes a
+    private copy of each one, so that costs about as much memory and time as reading the whole file.  */
+
+CHARTS_HOF_MAP_T *charts_hof_map_open (char *path)
+{
+  CHARTS_HOF_MAP_T    *map;
+  FILE                *fp;
+  int64_t             file_size;
+#ifndef NVWIN3X
+  int32_t             fd;
+#endif
+
+
+  if ((map = (CHARTS_HOF_MAP_T *) calloc (1, sizeof (CHARTS_HOF_MAP_T))) == NULL)
     {
-      fprintf (stderr, "Zero is not a valid HOF record number\n");
+      perror ("Allocating HOF map");
+      return (NULL);
+    }
+
+
+  if ((fp = fopen64 (path, "rb")) == NULL)
+    {
+      perror (path);
+      free (map);
+      return (NULL);
+    }
+
+  hof_parse_header (fp, &map->head, &map->swap);
+
+  fseeko64 (fp, 0LL, SEEK_END);
+  file_size = ftello64 (fp);
+
+  if (file_size < HOF_HEAD_SIZE)
+    {
+      fprintf (stderr, "%s is too small to be a HOF file\n", path);
       fflush (stderr);
-      return (0);
+      fclose (fp);
+      free (map);
+      return (NULL);
     }
 
+  map->num_records = (int32_t) ((file_size - HOF_HEAD_SIZE) / (int64_t) sizeof (HYDRO_OUTPUT_T));
+  map->map_size = (int64_t) HOF_HEAD_SIZE + (int64_t) map->num_records * (int64_t) sizeof (HYDRO_OUTPUT_T);
 
-  if (num != HOF_NEXT_RECORD) fseeko64 (fp, (int64_t) HOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (HYDRO_OUTPUT_T), SEEK_SET);
 
+#ifdef NVWIN3X
 
-  if (swap) charts_swap_hof_record (record);
+  if ((map->map = (uint8_t *) malloc (map->map_size)) == NULL)
+    {
+      perror ("Allocating HOF map");
+      fclose (fp);
+      free (map);
+      return (NULL);
+    }
 
+  fseeko64 (fp, 0LL, SEEK_SET);
+  if (!fread (map->map, map->map_size, 1, fp))
+    {
+      perror (path);
+      fclose (fp);
+      free (map->map);
+      free (map);
+      return (NULL);
+    }
 
-  ret = fwrite (record, sizeof (HYDRO_OUTPUT_T), 1, fp);
+  fclose (fp);
 
+#else
 
-  return (ret);
+  fclose (fp);
+
+
+  if ((fd = open (path, O_RDONLY)) < 0)
+    {
+      perror (path);
+      free (map);
+      return (NULL);
+    }
+
+
+  /*  A private, writable mapping lets us swap in place without touching the file.  */
+
+  if (map->swap)
+    {
+      map->map = (uint8_t *) mmap (NULL, map->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+  else
+    {
+      map->map = (uint8_t *) mmap (NULL, map->map_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+  close (fd);
+
+  if (map->map == (uint8_t *) MAP_FAILED)
+    {
+      perror (path);
+      free (map);
+      return (NULL);
+    }
+
+  madvise (map->map, map->map_size, MADV_SEQUENTIAL);
+
+#endif
+
+
+  map->records = (HYDRO_OUTPUT_T *) (map->map + HOF_HEAD_SIZE);
+
+
+  /*  Swap everything up front.  Doing it lazily as spans are handed out would mean writing to the mapping (and
+      keeping track of what's been done) while other threads are reading it.  */
+
+  if (map->swap) charts_swap_hof_records (map->records, map->num_records);
+
+  return (map);
+}
+
+
+void charts_hof_map_close (CHARTS_HOF_MAP_T *map)
+{
+  if (map == NULL) return;
+
+  if (map->map != NULL)
+    {
+#ifdef NVWIN3X
+      free (map->map);
+#else
+      munmap (map->map, map->map_size);
+#endif
+    }
+
+  free (map);
+}
+
+
+HOF_HEADER_T *charts_hof_map_header (CHARTS_HOF_MAP_T *map)
+{
+  return (&map->head);
+}
+
+
+int32_t charts_hof_map_num_records (CHARTS_HOF_MAP_T *map)
+{
+  return (map->num_records);
+}
+
+
+/*  Returns a pointer to "count" contiguous records starting at record "first" or NULL if the range is outside of
+    the file.  The pointer is valid until charts_hof_map_close is called.  Note that we're counting from 1 not 0 to
+    match hof_read_record.  */
+
+const HYDRO_OUTPUT_T *charts_hof_map_span (CHARTS_HOF_MAP_T *map, int32_t first, int32_t count)
+{
+  if (first < 1 || count < 1 || first - 1 > map->num_records - count) return (NULL);
+
+  return (&map->records[first - 1]);
+}
+
+
+const HYDRO_OUTPUT_T *charts_hof_map_record (CHARTS_HOF_MAP_T *map, int32_t num)
+{
+  return (charts_hof_map_span (map, num, 1));
+}
+
+
+
+/*  Where each HOF_COLUMN_* field lives in HYDRO_OUTPUT_T and in HOF_COLUMNS_T.  */
+
+typedef struct
+{
+  uint32_t       bit;
+  int32_t        size;
+  size_t         record_offset;
+  size_t         column_offset;
+} HOF_COLUMN_DEF_T;
+
+static HOF_COLUMN_DEF_T hof_column_defs[] =
+{
+  {HOF_COLUMN_TIMESTAMP, 8, offsetof (HYDRO_OUTPUT_T, timestamp), offsetof (HOF_COLUMNS_T, timestamp)},
+  {HOF_COLUMN_LATITUDE, 8, offsetof (HYDRO_OUTPUT_T, latitude), offsetof (HOF_COLUMNS_T, latitude)},
+  {HOF_COLUMN_LONGITUDE, 8, offsetof (HYDRO_OUTPUT_T, longitude), offsetof (HOF_COLUMNS_T, longitude)},
+  {HOF_COLUMN_SEC_LATITUDE, 8, offsetof (HYDRO_OUTPUT_T, sec_latitude), offsetof (HOF_COLUMNS_T, sec_latitude)},
+  {HOF_COLUMN_SEC_LONGITUDE, 8, offsetof (HYDRO_OUTPUT_T, sec_longitude), offsetof (HOF_COLUMNS_T, sec_longitude)},
+  {HOF_COLUMN_CORRECT_DEPTH, 4, offsetof (HYDRO_OUTPUT_T, correct_depth), offsetof (HOF_COLUMNS_T, correct_depth)},
+  {HOF_COLUMN_CORRECT_SEC_DEPTH, 4, offsetof (HYDRO_OUTPUT_T, correct_sec_depth), offsetof (HOF_COLUMNS_T, correct_sec_depth)},
+  {HOF_COLUMN_ABDC, 2, offsetof (HYDRO_OUTPUT_T, abdc), offsetof (HOF_COLUMNS_T, abdc)},
+  {HOF_COLUMN_SEC_ABDC, 2, offsetof (HYDRO_OUTPUT_T, sec_abdc), offsetof (HOF_COLUMNS_T, sec_abdc)},
+  {HOF_COLUMN_STATUS, 1, offsetof (HYDRO_OUTPUT_T, status), offsetof (HOF_COLUMNS_T, status)},
+  {HOF_COLUMN_SUSPECT_STATUS, 1, offsetof (HYDRO_OUTPUT_T, suspect_status), offsetof (HOF_COLUMNS_T, suspect_status)},
+  {HOF_COLUMN_CLASSIFICATION_STATUS, 1, offsetof (HYDRO_OUTPUT_T, classification_status), offsetof (HOF_COLUMNS_T, classification_status)},
+  {HOF_COLUMN_DATA_TYPE, 1, offsetof (HYDRO_OUTPUT_T, data_type), offsetof (HOF_COLUMNS_T, data_type)},
+  {HOF_COLUMN_NADIR_ANGLE, 4, offsetof (HYDRO_OUTPUT_T, nadir_angle), offsetof (HOF_COLUMNS_T, nadir_angle)},
+  {HOF_COLUMN_SCANNER_AZIMUTH, 4, offsetof (HYDRO_OUTPUT_T, scanner_azimuth), offsetof (HOF_COLUMNS_T, scanner_azimuth)},
+  {HOF_COLUMN_ALTITUDE, 4, offsetof (HYDRO_OUTPUT_T, altitude), offsetof (HOF_COLUMNS_T, altitude)}
+};
+
+#define HOF_COLUMN_DEFS  (int32_t) (sizeof (hof_column_defs) / sizeof (HOF_COLUMN_DEF_T))
+
+
+/*  Decodes records "first" through "first" + "count" - 1 (counting from 1) of a mapped HOF file into the column arrays
+    selected by "mask".  The fields are pulled straight out of the mapping, one column at a time, so the full records
+    are never copied.  Returns the number of records loaded or -1 on error.
+    Free the arrays with charts_hof_free_columns.  */
+
+int32_t charts_hof_load_columns (CHARTS_HOF_MAP_T *map, uint32_t mask, int32_t first, int32_t count, HOF_COLUMNS_T *columns)
+{
+  int32_t        j, k;
+  uint8_t        *src, *dst;
+
+
+  memset (columns, 0, sizeof (HOF_COLUMNS_T));
+
+  if (first < 1 || count < 1 || first - 1 > map->num_records - count) return (-1);
+
+  columns->mask = mask;
+  columns->count = count;
+
+
+  for (k = 0 ; k < HOF_COLUMN_DEFS ; k++)
+    {
+      if (!(mask & hof_column_defs[k].bit)) continue;
+
+      if ((dst = (uint8_t *) malloc ((size_t) count * hof_column_defs[k].size)) == NULL)
+        {
+          perror ("Allocating HOF columns");
+          charts_hof_free_columns (columns);
+          return (-1);
+        }
+
+      *(uint8_t **) ((uint8_t *) columns + hof_column_defs[k].column_offset) = dst;
+
+
+      src = (uint8_t *) &map->records[first - 1] + hof_column_defs[k].record_offset;
+
+      for (j = 0 ; j < count ; j++, src += sizeof (HYDRO_OUTPUT_T)) memcpy (dst + j * hof_column_defs[k].size, src, hof_column_defs[k].size);
+    }
+
+  return (count);
+}
+
+
+void charts_hof_free_columns (HOF_COLUMNS_T *columns)
+{
+  int32_t        k;
+  void           **array;
+
+
+  for (k = 0 ; k < HOF_COLUMN_DEFS ; k++)
+    {
+      array = (void **) ((uint8_t *) columns + hof_column_defs[k].column_offset);
+
+      if (*array) free (*array);
+      *array = NULL;
+    }
+
+  columns->mask = 0;
+  columns->count = 0;
 }
 
 
@@ -537,6 +1195,84 @@ void hof_get_uncertainty (HYDRO_OUTPUT_T *record, float *h_error, float *v_error
 
 
 
+/*  Array version of hof_get_uncertainty for "count" shots, taking the same columns charts_hof_load_columns produces
+    (depth is whichever depth you'd pass as "in_depth", abdc the matching confidence).  The math is the same chain
+    rearranged so everything that doesn't depend on the shot is computed once up front:
+
+        - roll, pitch, scan angle, calibration and laser pointing errors all scale with altitude / cos^2 (nadir),
+          so their squares fold into one constant times (altitude * sec^2 (nadir))^2
+        - sec^2 = 1 + tan^2 and tan (nadir - 5) comes from tan (nadir), so the only transcendental left per shot is
+          one tan (plus three sqrt)
+        - the intermediate totals are only ever squared again so their sqrt calls drop out
+
+    The loop has no branches or calls other than tan/sqrt so the compiler can vectorize it.  A zero altitude uses
+    400 meters, just like hof_get_uncertainty (which never actually updates its "previous" altitude).  */
+
+void hof_get_uncertainty_array (const float *nadir_angle, const float *altitude, const float *depth, const int16_t *abdc, const char *data_type, int32_t count, float *h_error, float *v_error)
+{
+  int32_t           i;
+  double            c_altitude, c_yaw, c_antenna, c_height, c_iho, c_beam, c_propagation, tan_5, c_random, c_bias;
+  double            alt, d, t, t2, sec_2, t_m5, t_m5_2, kgps, aircraft_2, platform_2, random_2, bias, h, v;
+
+
+  /*  Horizontal constants.  */
+
+  c_altitude = NV_DEG_TO_RAD * NV_DEG_TO_RAD * (E_ROLL * E_ROLL + E_PITCH * E_PITCH + 2.0 * E_SCAN_ANGLE * E_SCAN_ANGLE +
+                                                2.0 * E_H_CALIBRATION * E_H_CALIBRATION + E_LASER_POINTING * E_LASER_POINTING);
+  c_yaw = 2.0 * (1.0 - cos (NV_DEG_TO_RAD * E_YAW));
+  c_antenna = 2.0 * E_ANTENNA * E_ANTENNA;
+  c_height = E_HEIGHT * E_HEIGHT;
+  c_iho = 1.0 / (1.96 * 1.96);
+  c_beam = (0.45 / 100.0) * (0.45 / 100.0);
+  c_propagation = E_PROPAGATION * E_PROPAGATION;
+  tan_5 = tan (5.0 * NV_DEG_TO_RAD);
+
+
+  /*  Vertical constants.  */
+
+  c_random = E_ALTIMETER_TIM_2 + E_CFD_2 + E_LOG_AMP_DELAY_2 + E_WAVE_HEIGHT_2 + E_PULSE_LOCATION_2;
+  c_bias = E_THERMAL_2 + E_V_CALIBRATION_2 + E_PMT_DELAY_2 + E_SURFACE_ORIGIN_2;
+
+
+  for (i = 0 ; i < count ; i++)
+    {
+      alt = altitude[i] == 0.0 ? 400.0 : altitude[i];
+      d = (double) ((int32_t) -depth[i]);
+      kgps = data_type[i] ? 1.0 : 0.0;
+
+      t = tan (NV_DEG_TO_RAD * nadir_angle[i]);
+      t2 = t * t;
+      sec_2 = 1.0 + t2;
+      t_m5 = (t - tan_5) / (1.0 + t * tan_5);
+      t_m5_2 = t_m5 * t_m5;
+
+
+      /*  CHARTS system errors, water parameter errors and the DGPS/KGPS horizontal error (2.00 / 0.15).  */
+
+      aircraft_2 = c_height * t2 + alt * alt * (c_altitude * sec_2 * sec_2 + c_yaw * t2) + c_antenna;
+
+      platform_2 = aircraft_2 + (0.25 + (0.013 * d) * (0.013 * d)) * c_iho * t_m5_2 + c_propagation * d * d +
+        c_beam * d * d * t_m5_2;
+
+      h = sqrt (platform_2 + (kgps ? 0.15 * 0.15 : 2.00 * 2.00)) * 1.96;
+
+
+      /*  Vertical random and bias errors.  */
+
+      random_2 = c_random + E_ELLIPSOID_TO_LASER_KGPS_2 * kgps + c_beam * d * d;
+      bias = sqrt (c_bias + (36.0 + 0.2025 * d * d) / 10000.0);
+      v = fabs (bias - E_CONSTANT_BIAS) + sqrt (random_2) * 1.96;
+
+
+      /*  No data gets nothing and land values have no vertical error estimate.  */
+
+      h_error[i] = depth[i] <= -998.0 ? 0.0 : (float) h;
+      v_error[i] = (depth[i] <= -998.0 || abdc[i] == 70 || abdc[i] == 13) ? 0.0 : (float) v;
+    }
+}
+
+
+
 void hof_dump_record (HYDRO_OUTPUT_T *record)
 {
   int32_t         year, day, hour, minute, month, mday;
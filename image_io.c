@@ -26,12 +26,35 @@
 #include <errno.h>
 #include <string.h>
 
+#ifdef NVWIN3X
+  #include <windows.h>
+  #include <io.h>
+#else
+  #include <sys/mman.h>
+#endif
+
 #include "FileImage.h"
 
-static uint8_t swap = 1;
-static IMAGE_HEADER_T l_head;
-static IMAGE_INDEX_T *records = NULL;
-static int32_t old = 0;
+/*  Per file state for the handle based calls (charts_image_*).  The FILE based calls are thin wrappers around
+    these that use "l_image" so they behave the way they always have, one IMG file at a time.  */
+
+struct CHARTS_IMAGE
+{
+  FILE             *fp;
+  uint8_t          swap;
+  int32_t          old;
+  IMAGE_HEADER_T   head;
+  IMAGE_INDEX_T    *records;
+  uint8_t          sorted;
+  uint8_t          *map;            /*  Whole file, mapped on the first charts_image_map_record call.  */
+  int64_t          map_size;
+  CHARTS_IO_STATS_T stats;
+#ifdef NVWIN3X
+  HANDLE           mapping;
+#endif
+};
+
+static CHARTS_IMAGE_T l_image = {.fp = NULL, .swap = 1, .old = 0};
 
 
 static void charts_swap_image_header (IMAGE_INFO_T *info)
@@ -49,17 +72,48 @@ static void charts_swap_image_header (IMAGE_INFO_T *info)
 }
 
 
-int32_t image_read_header (FILE *fp, IMAGE_HEADER_T *head)
+/*  Keys of the ASCII header, in the order they're written.  */
+
+static const CHARTS_HEADER_FIELD_T image_header_fields[] =
+{
+  CHARTS_HEADER_FIELD ("FileType",               CHARTS_HEADER_STRING, IMAGE_TEXT_T, file_type),
+  CHARTS_HEADER_FIELD ("EndianType",             CHARTS_HEADER_ENDIAN, IMAGE_TEXT_T, endian),
+  CHARTS_HEADER_FIELD ("SoftwareVersionNumber",  CHARTS_HEADER_FLOAT,  IMAGE_TEXT_T, software_version),
+  CHARTS_HEADER_FIELD ("FileVersionNumber",      CHARTS_HEADER_FLOAT,  IMAGE_TEXT_T, file_version),
+  CHARTS_HEADER_FIELD ("Downloaded By",          CHARTS_HEADER_STRING, IMAGE_TEXT_T, UserName),
+  CHARTS_HEADER_FIELD ("HeaderSize",             CHARTS_HEADER_INT32,  IMAGE_TEXT_T, header_size),
+  CHARTS_HEADER_FIELD ("TextBlockSize",          CHARTS_HEADER_INT32,  IMAGE_TEXT_T, text_block_size),
+  CHARTS_HEADER_FIELD ("BinaryBlockSize",        CHARTS_HEADER_INT32,  IMAGE_TEXT_T, bin_block_size),
+  CHARTS_HEADER_FIELD ("Project",                CHARTS_HEADER_STRING, IMAGE_TEXT_T, project),
+  CHARTS_HEADER_FIELD ("Mission",                CHARTS_HEADER_STRING, IMAGE_TEXT_T, mission),
+  CHARTS_HEADER_FIELD ("Dataset",                CHARTS_HEADER_STRING, IMAGE_TEXT_T, dataset),
+  CHARTS_HEADER_FIELD ("FlightlineNumber",       CHARTS_HEADER_STRING, IMAGE_TEXT_T, flightline_number),
+  CHARTS_HEADER_FIELD ("CodedFLNumber",          CHARTS_HEADER_INT16,  IMAGE_TEXT_T, coded_fl_number),
+  CHARTS_HEADER_FIELD ("FlightDate",             CHARTS_HEADER_STRING, IMAGE_TEXT_T, flight_date),
+  CHARTS_HEADER_FIELD ("StartTime",              CHARTS_HEADER_STRING, IMAGE_TEXT_T, start_time),
+  CHARTS_HEADER_FIELD ("EndTime",                CHARTS_HEADER_STRING, IMAGE_TEXT_T, end_time),
+  CHARTS_HEADER_FIELD ("StartTimestamp",         CHARTS_HEADER_INT64,  IMAGE_TEXT_T, start_timestamp),
+  CHARTS_HEADER_FIELD ("EndTimestamp",           CHARTS_HEADER_INT64,  IMAGE_TEXT_T, end_timestamp),
+  CHARTS_HEADER_FIELD ("NumberImages",           CHARTS_HEADER_INT32,  IMAGE_TEXT_T, number_images),
+  CHARTS_HEADER_FIELD ("IndexRecordSize",        CHARTS_HEADER_INT32,  IMAGE_TEXT_T, record_size),
+  CHARTS_HEADER_FIELD ("IndexBlockSize",         CHARTS_HEADER_INT32,  IMAGE_TEXT_T, block_size)
+};
+
+CHARTS_HEADER_TABLE_T charts_image_header_table = CHARTS_HEADER_TABLE (image_header_fields);
+
+
+/*  Parses the header and sets "l_swap".  Returns 1 for the old (binary header) format, otherwise 0.  */
+
+static int32_t image_parse_header (FILE *fp, IMAGE_HEADER_T *head, uint8_t *l_swap)
 {
   int32_t      ret;
-  int64_t      long_pos;
-  char         varin[1024], info[1024];
+  char         varin[1024];
 
   char *ngets (char *s, int32_t size, FILE *stream);
   int32_t big_endian ();
 
 
-  swap = 0;
+  *l_swap = 0;
 
 
   /*  Check for the new format file.  If the first four characters are 
@@ -76,83 +130,9 @@ int32_t image_read_header (FILE *fp, IMAGE_HEADER_T *head)
       /*  Read each entry.    */
 
       head->text.header_size = 0;
-      while (ngets (varin, sizeof (varin), fp) != NULL)
-        {
-          if (!strcmp (varin, "EOF")) break;
-
-
-          /*  Put everything to the right of the colon into 'info'.   */
-            
-          if (strchr (varin, ':') != NULL) strcpy (info, (char *) (strchr (varin, ':') + 1));
-
-
-          /*  Check input for matching strings and load values if found.  */
-            
-          if (strstr (varin, "FileType:") != NULL) lidar_get_string (varin, head->text.file_type);
-
-          if (strstr (varin, "EndianType:") != NULL)
-            {
-              if (strstr (info, "Little"))
-                {
-                  head->text.endian = 1;
-                  if (big_endian ()) swap = 1;
-                }
-              else
-                {
-                  head->text.endian = 1;
-                  if (!big_endian ()) swap = 1;
-                }
-            }
-
-
-          if (strstr (varin, "SoftwareVersionNumber:") != NULL) sscanf (info, "%f", &head->text.software_version);
-
-          if (strstr (varin, "FileVersionNumber:") != NULL) sscanf (info, "%f", &head->text.file_version);
-
-
-          if (strstr (varin, "Downloaded By:") != NULL) lidar_get_string (varin, head->text.UserName);
-
-
-          if (strstr (varin, "HeaderSize:") != NULL) sscanf (info, "%d", &head->text.header_size);
-
-          if (strstr (varin, "TextBlockSize:") != NULL) sscanf (info, "%d", &head->text.text_block_size);
-
-          if (strstr (varin, "BinaryBlockSize:") != NULL) sscanf (info, "%d", &head->text.bin_block_size);
-
-
-          if (strstr (varin, "Project:") != NULL) lidar_get_string (varin, head->text.project);
-
-          if (strstr (varin, "Mission:") != NULL) lidar_get_string (varin, head->text.mission);
-
-          if (strstr (varin, "Dataset:") != NULL) lidar_get_string (varin, head->text.dataset);
-
-          if (strstr (varin, "FlightlineNumber:") != NULL) lidar_get_string (varin, head->text.flightline_number);
-
-          if (strstr (varin, "CodedFLNumber:") != NULL) sscanf (info, "%hd", &head->text.coded_fl_number);
 
-          if (strstr (varin, "FlightDate:") != NULL) lidar_get_string (varin, head->text.flight_date);
-
-          if (strstr (varin, "StartTime:") != NULL) lidar_get_string (varin, head->text.start_time);
-
-          if (strstr (varin, "EndTime:") != NULL) lidar_get_string (varin, head->text.end_time);
-
-          if (strstr (varin, "StartTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->text.start_timestamp);
-
-          if (strstr (varin, "EndTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->text.end_timestamp);
-
-          if (strstr (varin, "NumberImages:") != NULL) sscanf (info, "%d", &head->text.number_images);
-
-          if (strstr (varin, "IndexRecordSize:") != NULL) sscanf (info, "%d", &head->text.record_size);
-
-          if (strstr (varin, "IndexBlockSize:") != NULL) sscanf (info, "%d", &head->text.block_size);
-
-          if (strstr (varin, "FileCreateDate:") != NULL) lidar_get_string (varin, head->text.dataset_create_date);
-
-          if (strstr (varin, "FileCreateTime:") != NULL) lidar_get_string (varin, head->text.dataset_create_time);
-
-          long_pos = ftello64 (fp);
-          if (head->text.header_size && long_pos >= head->text.header_size) break;
-        }
+      if (charts_header_read (fp, &charts_image_header_table, &head->text, &head->text.header_size))
+        *l_swap = (head->text.endian == big_endian ());
 
 
       /*  Make sure we're past the header.  */
@@ -172,7 +152,7 @@ int32_t image_read_header (FILE *fp, IMAGE_HEADER_T *head)
 
       /*  Swap the INFO block if needed.  */
 
-      if (swap) charts_swap_image_header (&head->info);
+      if (*l_swap) charts_swap_image_header (&head->info);
 
 
       head->text.start_timestamp = head->info.start_timestamp;
@@ -183,28 +163,51 @@ int32_t image_read_header (FILE *fp, IMAGE_HEADER_T *head)
     }
 
 
-  head->text.data_size = l_head.text.data_size;
+  return (ret);
+}
+
+
 
+/*  Drops the mapping made by image_map, if there is one.  */
 
-  return (ret);
+static void image_unmap (CHARTS_IMAGE_T *image)
+{
+  if (image->map == NULL) return;
+
+#ifdef NVWIN3X
+  UnmapViewOfFile (image->map);
+  CloseHandle (image->mapping);
+#else
+  munmap (image->map, image->map_size);
+#endif
+
+  image->map = NULL;
+  image->map_size = 0;
 }
 
 
+/*  Opens the file and loads the index into "image".  Returns the FILE pointer or NULL on failure.  */
 
-FILE *open_image_file (char *path)
+static FILE *image_load (CHARTS_IMAGE_T *image, char *path)
 {
   FILE                  *fp;
   int32_t               i;
   OLD_IMAGE_INDEX_T     old_record;
+  double                start;
 
 
   int32_t big_endian ();
 
 
-  swap = (uint8_t) big_endian ();
+  image_unmap (image);
+
+  memset (&image->stats, 0, sizeof (CHARTS_IO_STATS_T));
+  start = charts_io_stats_clock ();
 
+  image->swap = (uint8_t) big_endian ();
 
-  l_head.text.data_size = 0;
+
+  image->head.text.data_size = 0;
 
 
   /*  Brute force!  Load the index into memory, it ain't big anyway.  */
@@ -215,25 +218,26 @@ FILE *open_image_file (char *path)
     }
   else
     {
-      old = image_read_header (fp, &l_head);
+      image->old = image_parse_header (fp, &image->head, &image->swap);
+      image->head.text.data_size = 0;
 
-      if (records) free (records);
+      if (image->records) free (image->records);
 
-      records = (IMAGE_INDEX_T *) calloc (l_head.text.number_images, sizeof (IMAGE_INDEX_T));
+      image->records = (IMAGE_INDEX_T *) calloc (image->head.text.number_images, sizeof (IMAGE_INDEX_T));
 
-      if (records == NULL)
+      if (image->records == NULL)
         {
           perror ("Allocating image index");
           exit (-1);
         }
 
-      if (old)
+      if (image->old)
         {
-          for (i = 0 ; i < l_head.text.number_images ; i++)
+          for (i = 0 ; i < image->head.text.number_images ; i++)
             {
               fread (&old_record, sizeof (OLD_IMAGE_INDEX_T), 1, fp);
                 
-              if (swap)
+              if (image->swap)
                 {
                   charts_swap_int64_t (&old_record.timestamp);
                   charts_swap_int64_t (&old_record.byte_offset);
@@ -241,191 +245,424 @@ FILE *open_image_file (char *path)
                   charts_swap_int32_t (&old_record.image_size);
                   charts_swap_int32_t (&old_record.image_number);
                 }
-              records[i].timestamp = old_record.timestamp;
-              records[i].byte_offset = old_record.byte_offset;
-              records[i].image_size = old_record.image_size;
-              records[i].image_number = old_record.image_number;
+              image->records[i].timestamp = old_record.timestamp;
+              image->records[i].byte_offset = old_record.byte_offset;
+              image->records[i].image_size = old_record.image_size;
+              image->records[i].image_number = old_record.image_number;
 
-              l_head.text.data_size += records[i].image_size;
+              image->head.text.data_size += image->records[i].image_size;
             }
         }
       else
         {
-          for (i = 0 ; i < l_head.text.number_images ; i++)
+          for (i = 0 ; i < image->head.text.number_images ; i++)
             {
-              fread (&records[i], sizeof (IMAGE_INDEX_T), 1, fp);
+              fread (&image->records[i], sizeof (IMAGE_INDEX_T), 1, fp);
 
-              if (swap)
+              if (image->swap)
                 {
-                  charts_swap_int64_t (&records[i].timestamp);
-                  charts_swap_int64_t (&records[i].byte_offset);
+                  charts_swap_int64_t (&image->records[i].timestamp);
+                  charts_swap_int64_t (&image->records[i].byte_offset);
 
-                  charts_swap_int32_t (&records[i].image_size);
-                  charts_swap_int32_t (&records[i].image_number);
+                  charts_swap_int32_t (&image->records[i].image_size);
+                  charts_swap_int32_t (&image->records[i].image_number);
                 }
 
-              l_head.text.data_size += records[i].image_size;
+              image->head.text.data_size += image->records[i].image_size;
+            }
+        }
+
+
+      /*  The index should always be in time order but we don't trust it for the binary search unless it is.  */
+
+      image->sorted = 1;
+      for (i = 1 ; i < image->head.text.number_images ; i++)
+        {
+          if (image->records[i].timestamp < image->records[i - 1].timestamp)
+            {
+              image->sorted = 0;
+              break;
             }
         }
     }
 
+  image->fp = fp;
+
+  CHARTS_IO_COUNT (&image->stats, header_seconds, charts_io_stats_clock () - start);
+
   return (fp);
 }
 
 
+/*  Opens an IMG file and loads its index.  Returns NULL on failure.  */
+
+CHARTS_IMAGE_T *charts_image_open (char *path)
+{
+  CHARTS_IMAGE_T    *image;
+
+
+  if ((image = (CHARTS_IMAGE_T *) calloc (1, sizeof (CHARTS_IMAGE_T))) == NULL)
+    {
+      perror ("Allocating image handle");
+      return (NULL);
+    }
+
+  if (image_load (image, path) == NULL)
+    {
+      charts_image_close (image);
+      return (NULL);
+    }
+
+  return (image);
+}
+
+
+void charts_image_close (CHARTS_IMAGE_T *image)
+{
+  if (image == NULL) return;
+
+  image_unmap (image);
+
+  if (image->fp != NULL) fclose (image->fp);
+  if (image->records) free (image->records);
+
+  free (image);
+}
+
+
+FILE *charts_image_fp (CHARTS_IMAGE_T *image)
+{
+  return (image->fp);
+}
+
+
+IMAGE_HEADER_T *charts_image_header (CHARTS_IMAGE_T *image)
+{
+  return (&image->head);
+}
+
+
+/*  I/O counters for "image".  A NULL handle gets the counters for the FILE based calls.  */
+
+CHARTS_IO_STATS_T *charts_image_stats (CHARTS_IMAGE_T *image)
+{
+  return (image ? &image->stats : &l_image.stats);
+}
+
+
 /*  Note that we're counting from 1 not 0.  Not my idea!  */
 
-int32_t image_get_metadata (FILE *fp, int32_t rec_num, IMAGE_INDEX_T *image_index)
+int32_t charts_image_get_metadata (CHARTS_IMAGE_T *image, int32_t rec_num, IMAGE_INDEX_T *image_index)
 {
   int32_t     real_num;
 
 
   real_num = rec_num - 1;
 
-  if (real_num < 0 || real_num > l_head.text.number_images) return (-1);
+  if (real_num < 0 || real_num >= image->head.text.number_images) return (-1);
 
-  image_index->timestamp = records[real_num].timestamp;
-  image_index->byte_offset = records[real_num].byte_offset;
-  image_index->image_size = records[real_num].image_size;
-  image_index->image_number = records[real_num].image_number;
+  image_index->timestamp = image->records[real_num].timestamp;
+  image_index->byte_offset = image->records[real_num].byte_offset;
+  image_index->image_size = image->records[real_num].image_size;
+  image_index->image_number = image->records[real_num].image_number;
 
   return (0);
 }
 
 
-/*  Returns the nearest record number to "timestamp".  Note that we're counting
-    from 1 not 0.  Not my idea!  */
+/*  Returns the index of the first record at or after "timestamp", searching from record index "start" on.  Uses a
+    binary search if the index is in time order, otherwise a linear scan.  Returns number_images if there isn't one.  */
 
-int32_t image_find_record (FILE *fp, int64_t timestamp)
+static int32_t image_lower_bound (CHARTS_IMAGE_T *image, int64_t timestamp, int32_t start)
 {
-  int32_t        i, j;
+  int32_t        low, high, mid;
+  IMAGE_INDEX_T  *records = image->records;
+
+
+  if (!image->sorted)
+    {
+      for (low = start ; low < image->head.text.number_images ; low++) if (timestamp <= records[low].timestamp) break;
+
+      return (low);
+    }
 
 
-  if (timestamp < l_head.text.start_timestamp || timestamp > l_head.text.end_timestamp) return (0);
+  low = start;
+  high = image->head.text.number_images;
 
-  j = -1;
-  for (i = 0 ; i < l_head.text.number_images ; i++)
+  while (low < high)
     {
-      if (timestamp <= records[i].timestamp)
+      mid = low + (high - low) / 2;
+
+      if (records[mid].timestamp < timestamp)
         {
-          if (!i)
-            {
-              j = i;
-            }
-          else
-            {
-              if ((timestamp - records[i - 1].timestamp) < (records[i].timestamp - timestamp))
-                {
-                  j = i - 1;
-                }
-              else
-                {
-                  j = i;
-                }
-            }
-          break;
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
         }
     }
 
-  return (j + 1);
+  return (low);
 }
 
 
+/*  Given the first record index "i" at or after "timestamp", returns the nearest record number (counting from 1) or 0
+    if there's no record at or after "timestamp".  */
 
-/*  This function tries to find the record based on the timestamp.  Returns NULL on failure or the 
-    image if it succeeds.  You must free the image in the calling program.  */
+static int32_t image_nearest (CHARTS_IMAGE_T *image, int64_t timestamp, int32_t i)
+{
+  IMAGE_INDEX_T  *records = image->records;
 
-uint8_t *image_read_record (FILE *fp, int64_t timestamp, uint32_t *size, int64_t *image_time)
+
+  if (i >= image->head.text.number_images) return (0);
+
+  if (i && (timestamp - records[i - 1].timestamp) < (records[i].timestamp - timestamp)) return (i);
+
+  return (i + 1);
+}
+
+
+/*  Returns the nearest record number to "timestamp".  Note that we're counting
+    from 1 not 0.  Not my idea!  */
+
+int32_t charts_image_find_record (CHARTS_IMAGE_T *image, int64_t timestamp)
 {
-  uint8_t          *image;
-  int32_t          i, j;
+  if (timestamp < image->head.text.start_timestamp || timestamp > image->head.text.end_timestamp) return (0);
+
+  return (image_nearest (image, timestamp, image_lower_bound (image, timestamp, 0)));
+}
 
 
-  if (timestamp < l_head.text.start_timestamp || timestamp > l_head.text.end_timestamp) return (NULL);
+/*  Looks up "count" timestamps at once, putting the nearest record number (counting from 1, 0 if not found) for
+    each in "recnums".  If "timestamps" is in ascending order the whole batch is resolved in a single merge pass over
+    the index.  Out of order timestamps still work, they just restart the search.  Returns the number found.  */
+
+int32_t charts_image_find_records (CHARTS_IMAGE_T *image, int64_t *timestamps, int32_t count, int32_t *recnums)
+{
+  int32_t        i, j, found = 0;
+  IMAGE_INDEX_T  *records = image->records;
 
-  j = -1;
-  for (i = 0 ; i < l_head.text.number_images ; i++)
+
+  i = 0;
+  for (j = 0 ; j < count ; j++)
     {
-      if (timestamp <= records[i].timestamp)
+      recnums[j] = 0;
+
+      if (timestamps[j] < image->head.text.start_timestamp || timestamps[j] > image->head.text.end_timestamp) continue;
+
+      if (!image->sorted || (j && timestamps[j] < timestamps[j - 1]))
         {
-          if (!i)
-            {
-              j = i;
-            }
-          else
-            {
-              if ((timestamp - records[i - 1].timestamp) < (records[i].timestamp - timestamp))
-                {
-                  j = i - 1;
-                }
-              else
-                {
-                  j = i;
-                }
-            }
-          break;
+          i = image_lower_bound (image, timestamps[j], 0);
         }
+      else
+        {
+          while (i < image->head.text.number_images && records[i].timestamp < timestamps[j]) i++;
+        }
+
+      if ((recnums[j] = image_nearest (image, timestamps[j], i))) found++;
     }
 
+  return (found);
+}
+
 
-  /*  Make sure we got an image.  */
+/*  This call reads the image at record "recnum".  Returns NULL on failure or the 
+    image if it succeeds.  You must free the image in the calling program.  */
 
-  if (j == -1 || records[j].image_size == 0) return ((uint8_t *) NULL);
+uint8_t *charts_image_read_record_recnum (CHARTS_IMAGE_T *image, int32_t recnum, uint32_t *size, int64_t *image_time)
+{
+  uint8_t         *data;
+  int32_t         j;
+
+
+  if (recnum < 1 || recnum > image->head.text.number_images) return (NULL);
+
+  j = recnum - 1;
 
 
-  *image_time = records[j].timestamp;
+  if (image->records[j].image_size == 0) return (NULL);
 
 
-  image = (uint8_t *) malloc (records[j].image_size);
-  if (image == NULL)
+  *image_time = image->records[j].timestamp;
+
+  data = (uint8_t *) malloc (image->records[j].image_size);
+  if (data == NULL)
     {
       perror ("Allocating image memory");
       exit (-1);
     }
 
 
-  fseeko64 (fp, records[j].byte_offset, SEEK_SET);
-  fread (image, records[j].image_size, 1, fp);
+  charts_io_seek (&image->stats, image->fp, image->records[j].byte_offset, SEEK_SET);
+  charts_io_read (&image->stats, data, image->records[j].image_size, 1, image->fp);
 
-  *size = records[j].image_size;
+  *size = image->records[j].image_size;
 
-  return (image);
+  return (data);
 }
 
 
-/*  This call reads the image at record "recnum".  Returns NULL on failure or the 
-    image if it succeeds.  You must free the image in the calling program.  */
+/*  Maps the whole file read only.  Returns 0 on success.  */
 
-uint8_t *image_read_record_recnum (FILE *fp, int32_t recnum, uint32_t *size, int64_t *image_time)
+static int32_t image_map (CHARTS_IMAGE_T *image)
 {
-  uint8_t         *image;
-  int32_t         j;
+  int64_t          size;
+  uint8_t          *map;
+#ifdef NVWIN3X
+  HANDLE           mapping;
+#endif
 
 
-  if (recnum < 1 || recnum > l_head.text.number_images) return (NULL);
+  if (image->map != NULL) return (0);
+
+  if (image->fp == NULL || fseeko64 (image->fp, 0LL, SEEK_END) || (size = ftello64 (image->fp)) <= 0) return (-1);
 
-  j = recnum - 1;
 
+#ifdef NVWIN3X
 
-  if (records[j].image_size == 0) return (NULL);
+  if ((mapping = CreateFileMapping ((HANDLE) _get_osfhandle (_fileno (image->fp)), NULL, PAGE_READONLY, 0, 0, NULL))
+      == NULL) return (-1);
+
+  if ((map = (uint8_t *) MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0)) == NULL)
+    {
+      CloseHandle (mapping);
+      return (-1);
+    }
 
+  image->mapping = mapping;
 
-  *image_time = records[j].timestamp;
+#else
 
-  image = (uint8_t *) malloc (records[j].image_size);
-  if (image == NULL)
+  if ((map = (uint8_t *) mmap (NULL, size, PROT_READ, MAP_SHARED, fileno (image->fp), 0)) == MAP_FAILED)
     {
-      perror ("Allocating image memory");
-      exit (-1);
+      perror ("Mapping image file");
+      return (-1);
     }
 
+#endif
 
-  fseeko64 (fp, records[j].byte_offset, SEEK_SET);
-  fread (image, records[j].image_size, 1, fp);
 
-  *size = records[j].image_size;
+  image->map = map;
+  image->map_size = size;
 
-  return (image);
+  return (0);
+}
+
+
+/*  Maps the file for charts_image_map_record.  The first charts_image_map_record call does this anyway, but call it
+    before sharing the handle between threads (and check what it returns, there's no sense starting them if the
+    file can't be mapped).  Returns 0 on success or -1 on failure.  */
+
+int32_t charts_image_map (CHARTS_IMAGE_T *image)
+{
+  return (image_map (image));
+}
+
+
+/*  Same as charts_image_read_record_recnum except that it returns a pointer into the mapped file instead of a
+    copy, so there's nothing to free.  The pointer is good until the handle is closed.  The first call maps the
+    file (see charts_image_map).  Returns NULL if the record doesn't exist, is empty, runs off the end of the file,
+    or the file can't be mapped.  */
+
+const uint8_t *charts_image_map_record (CHARTS_IMAGE_T *image, int32_t recnum, uint32_t *size, int64_t *image_time)
+{
+  int32_t         j;
+
+
+  if (recnum < 1 || recnum > image->head.text.number_images) return (NULL);
+
+  j = recnum - 1;
+
+
+  if (image->records[j].image_size == 0) return (NULL);
+
+  if (image_map (image)) return (NULL);
+
+  if (image->records[j].byte_offset < 0 ||
+      image->records[j].byte_offset + image->records[j].image_size > image->map_size) return (NULL);
+
+
+  *image_time = image->records[j].timestamp;
+  *size = image->records[j].image_size;
+
+  return (image->map + image->records[j].byte_offset);
+}
+
+
+/*  This function tries to find the record based on the timestamp.  Returns NULL on failure or the 
+    image if it succeeds.  You must free the image in the calling program.  */
+
+uint8_t *charts_image_read_record (CHARTS_IMAGE_T *image, int64_t timestamp, uint32_t *size, int64_t *image_time)
+{
+  int32_t          recnum;
+
+
+  /*  Make sure we got an image.  */
+
+  if (!(recnum = charts_image_find_record (image, timestamp))) return ((uint8_t *) NULL);
+
+  return (charts_image_read_record_recnum (image, recnum, size, image_time));
+}
+
+
+int32_t image_read_header (FILE *fp, IMAGE_HEADER_T *head)
+{
+  int32_t      ret;
+
+
+  ret = image_parse_header (fp, head, &l_image.swap);
+
+  head->text.data_size = l_image.head.text.data_size;
+
+  return (ret);
+}
+
+
+FILE *open_image_file (char *path)
+{
+  return (image_load (&l_image, path));
+}
+
+
+int32_t image_get_metadata (FILE *fp, int32_t rec_num, IMAGE_INDEX_T *image_index)
+{
+  l_image.fp = fp;
+
+  return (charts_image_get_metadata (&l_image, rec_num, image_index));
+}
+
+
+int32_t image_find_record (FILE *fp, int64_t timestamp)
+{
+  l_image.fp = fp;
+
+  return (charts_image_find_record (&l_image, timestamp));
+}
+
+
+int32_t image_find_records (FILE *fp, int64_t *timestamps, int32_t count, int32_t *recnums)
+{
+  l_image.fp = fp;
+
+  return (charts_image_find_records (&l_image, timestamps, count, recnums));
+}
+
+
+uint8_t *image_read_record (FILE *fp, int64_t timestamp, uint32_t *size, int64_t *image_time)
+{
+  l_image.fp = fp;
+
+  return (charts_image_read_record (&l_image, timestamp, size, image_time));
+}
+
+
+uint8_t *image_read_record_recnum (FILE *fp, int32_t recnum, uint32_t *size, int64_t *image_time)
+{
+  l_image.fp = fp;
+
+  return (charts_image_read_record_recnum (&l_image, recnum, size, image_time));
 }
 
 
@@ -437,36 +674,40 @@ uint8_t *image_read_record_recnum (FILE *fp, int32_t recnum, uint32_t *size, int
 
 int64_t dump_image (char *file, int64_t timestamp, char *path)
 {
-  uint8_t      *image;
-  char         img_file[512];
-  uint32_t     size;
-  FILE         *lfp, *dfp;
-  int64_t      ret = 0;
+  const uint8_t   *data;
+  uint8_t         *copy = NULL;
+  char            img_file[512];
+  uint32_t        size;
+  int32_t         recnum;
+  FILE            *dfp;
+  CHARTS_IMAGE_T  *image;
+  int64_t         ret = 0;
 
 
   strcpy (img_file, file);
   strcpy (&img_file[strlen (img_file) - 4], ".img");
 
-  if ((lfp = open_image_file (img_file)) != NULL)
+  if ((image = charts_image_open (img_file)) != NULL)
     {
-      image = image_read_record (lfp, timestamp, &size, &ret);
+      /*  Straight from the mapped file if we can, otherwise the old way.  */
+
+      if ((recnum = charts_image_find_record (image, timestamp)) &&
+          (data = charts_image_map_record (image, recnum, &size, &ret)) == NULL)
+        data = copy = charts_image_read_record_recnum (image, recnum, &size, &ret);
 
-      if (size)
+      if (recnum && data)
         {
-          if (image)
+          if ((dfp = fopen64 (path, "wb")) != NULL)
             {
-              if ((dfp = fopen64 (path, "wb")) != NULL)
-                {
-                  fwrite (image, size, 1, dfp);
-
-                  fclose (dfp);
+              fwrite (data, size, 1, dfp);
 
-                  free (image);
-                }
+              fclose (dfp);
             }
 
-          fclose (lfp);
+          if (copy) free (copy);
         }
+
+      charts_image_close (image);
     }
 
   return (ret);
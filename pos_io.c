@@ -21,17 +21,43 @@
 
 *********************************************************************************************/
 
+#include <sys/stat.h>
+
 #include "FilePOSOutput.h"
 
 #ifndef NV_RAD_TO_DEG
   #define       NV_RAD_TO_DEG   57.2957795147195L
 #endif
 
-static uint8_t swap = 1;
-static uint8_t midnight = 0.0;
-static double start_gps_time = 0.0;
-static int64_t start_timestamp, end_timestamp, start_week;
-static int32_t year, month, day, start_record, end_record;
+/*  Per file state for the handle based calls (charts_pos_*).  The FILE based calls are thin wrappers around
+    these that use "l_pos" so they behave the way they always have, one POS/SBET file at a time.  */
+
+struct CHARTS_POS
+{
+  FILE             *fp;
+  uint8_t          swap;
+  uint8_t          midnight;
+  double           start_gps_time;
+  int64_t          start_timestamp;
+  int64_t          end_timestamp;
+  int64_t          start_week;
+  int32_t          start_record;
+  int32_t          end_record;
+  char             path[1024];
+  int32_t          index_stride;     /*  Sampled time index (charts_pos_use_index), NULL index_time if not in use.  */
+  int32_t          index_count;
+  double           *index_time;
+  POS_OUTPUT_T     *block;           /*  The index_stride + 1 records last read by an indexed lookup.  */
+  int32_t          block_start;
+  int32_t          block_count;
+  CHARTS_IO_STATS_T stats;
+  int32_t          interp_mode;      /*  charts_pos_set_interp.  */
+  uint32_t         interp_mask;
+  int32_t          segment_record;   /*  Record at the end of the Hermite segment in "segment", 0 if none.  */
+  CHARTS_INTERP_SEGMENT_T segment;
+};
+
+static CHARTS_POS_T l_pos = {.fp = NULL, .swap = 1, .midnight = 0, .start_gps_time = 0.0};
 
 
 #ifdef NVWIN3X
@@ -44,6 +70,30 @@ static int32_t year, month, day, start_record, end_record;
 #define WEEK_OFFSET  7.0L * 86400.0L
 
 
+/*  Number of fields after gps_time in a POS_OUTPUT_T and the ones that are angles that wrap around.  */
+
+#define POS_NUM_FIELDS    16
+#define POS_ANGLE_FIELDS  (POS_FIELD_LONGITUDE | POS_FIELD_PLATFORM_HEADING | POS_FIELD_WANDER_ANGLE)
+
+
+/*  Header of the time index sidecar file (<pos file>.idx) written by charts_pos_use_index.  It is followed by
+    "count" doubles, the (midnight corrected) gps_time of every "stride"th record, in native byte order.  */
+
+#define POS_INDEX_MAGIC    "CHARTS POS INDEX"
+#define POS_INDEX_VERSION  1
+
+typedef struct
+{
+  char             magic[16];
+  int32_t          version;
+  int32_t          byte_order;      /*  0x01020304 as written, so we can tell it was written on this kind of machine.  */
+  int64_t          file_size;
+  int64_t          file_mtime;
+  int32_t          stride;
+  int32_t          count;
+} POS_INDEX_HEADER_T;
+
+
 
 
 
@@ -349,39 +399,46 @@ uint8_t get_pos_file (char *htpi_file, char *pos_file)
 
 
 
-static void charts_swap_pos (POS_OUTPUT_T *pos)
+/*  POS_OUTPUT_T is nothing but doubles so "count" records are just one array of doubles.  Unlike the old per field swap this includes z_velocity.  */
+
+void charts_swap_pos_records (POS_OUTPUT_T *records, size_t count)
 {
-  charts_swap_double (&pos->gps_time);
-  charts_swap_double (&pos->latitude);
-  charts_swap_double (&pos->longitude);
-  charts_swap_double (&pos->altitude);
-  charts_swap_double (&pos->x_velocity);
-  charts_swap_double (&pos->y_velocity);
-  charts_swap_double (&pos->roll);
-  charts_swap_double (&pos->pitch);
-  charts_swap_double (&pos->platform_heading);
-  charts_swap_double (&pos->wander_angle);
-  charts_swap_double (&pos->x_body_accel);
-  charts_swap_double (&pos->y_body_accel);
-  charts_swap_double (&pos->z_body_accel);
-  charts_swap_double (&pos->x_body_ang_rate);
-  charts_swap_double (&pos->y_body_ang_rate);
-  charts_swap_double (&pos->z_body_ang_rate);
+  charts_swap_array_64 (records, count * (sizeof (POS_OUTPUT_T) / sizeof (double)));
 }
 
 
-FILE *open_pos_file (char *path)
+static void pos_free_index (CHARTS_POS_T *nav)
+{
+  if (nav->index_time) free (nav->index_time);
+  if (nav->block) free (nav->block);
+
+  nav->index_time = NULL;
+  nav->block = NULL;
+  nav->index_stride = nav->index_count = nav->block_count = 0;
+}
+
+
+/*  Opens the file and sets up "nav".  Returns the FILE pointer or NULL on failure.  */
+
+static FILE *pos_load (CHARTS_POS_T *nav, char *path)
 {
   FILE                   *fp;
   POS_OUTPUT_T           pos;
-  time_t                 tv_sec;
-  struct tm              tm;
-  static int32_t         tz_set = 0;
+  int64_t                tv_sec;
+  int32_t                year, month, day;
+  double                 start;
 
 
   int32_t big_endian ();
 
 
+  pos_free_index (nav);
+
+  memset (&nav->stats, 0, sizeof (CHARTS_IO_STATS_T));
+  nav->segment_record = 0;
+  start = charts_io_stats_clock ();
+
+
   /*  Check the file name for following the naming convention as best we can.  */
 
   if (path[strlen (path) - 16] != '_' || path[strlen (path) - 9] != '_' || path[strlen (path) - 4] != '.')
@@ -396,147 +453,363 @@ FILE *open_pos_file (char *path)
   sscanf (&path[strlen (path) - 15], "%02d%02d%02d", &year, &month, &day);
 
 
-  /*  tm struct wants years since 1900!!!  */
-
-  tm.tm_year = year + 100;
-  tm.tm_mon = month - 1;
-  tm.tm_mday = day;
-  tm.tm_hour = 0.0;
-  tm.tm_min = 0.0;
-  tm.tm_sec = 0.0;
-  tm.tm_isdst = -1;
-
-  if (!tz_set)
-    {
-#ifdef NVWIN3X
-  #if defined (__MINGW64__) || defined (__MINGW32__)
-      putenv("TZ=GMT");
-      tzset();
-  #else
-      _putenv("TZ=GMT");
-      _tzset();
-  #endif
-#else
-      putenv("TZ=GMT");
-      tzset();
-#endif
-      tz_set = 1;
-    }
+  /*  Get seconds from the epoch (01-01-1970) for the date in the filename.  */
 
+  tv_sec = charts_utc_time (year + 2000, month, day);
 
-  /*  Get seconds from the epoch (01-01-1970) for the date in the filename. 
-      This will also give us the day of the week for the GPS seconds of
-      week calculation.  */
 
-  tv_sec = mktime (&tm);
+  /*  Subtract the number of days since Saturday midnight (Sunday morning) in seconds.  01-01-1970 was a Thursday.  */
 
-
-  /*  Subtract the number of days since Saturday midnight (Sunday morning) in seconds.  */
-
-  tv_sec = tv_sec - (tm.tm_wday * 86400);
-  start_week = tv_sec;
+  tv_sec = tv_sec - (((tv_sec / 86400) + 4) % 7) * 86400;
+  nav->start_week = tv_sec;
 
 
   /*  We have to assume that the file is little endian since there is no
       header and no field that we can use to deduce what it is.  */
 
-  swap = (uint8_t) big_endian ();
+  nav->swap = (uint8_t) big_endian ();
 
 
   if ((fp = fopen (path, "rb")) == NULL)
     {
+      nav->fp = NULL;
       return ((FILE *) NULL);
     }
   else
     {
       fread (&pos, sizeof (POS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_pos (&pos);
-      start_timestamp = (int64_t) (((double) start_week + pos.gps_time) * 1000000.0);
-      start_record = 0;
-      start_gps_time = pos.gps_time;
+      if (nav->swap) charts_swap_pos_records (&pos, 1);
+      nav->start_timestamp = (int64_t) (((double) nav->start_week + pos.gps_time) * 1000000.0);
+      nav->start_record = 0;
+      nav->start_gps_time = pos.gps_time;
 
 
       fseek (fp, -sizeof (POS_OUTPUT_T), SEEK_END);
 
       fread (&pos, sizeof (POS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_pos (&pos);
-      end_timestamp = (int64_t) (((double) start_week + pos.gps_time) * 1000000.0);
+      if (nav->swap) charts_swap_pos_records (&pos, 1);
+      nav->end_timestamp = (int64_t) (((double) nav->start_week + pos.gps_time) * 1000000.0);
 
 
       /*  Check for crossing midnight at end of GPS week (stupid f***ing Applanix bozos).  */
 
-      if (end_timestamp < start_timestamp)
+      if (nav->end_timestamp < nav->start_timestamp)
         {
-          midnight = 1;
-          end_timestamp += ((int64_t) WEEK_OFFSET * 1000000);
+          nav->midnight = 1;
+          nav->end_timestamp += ((int64_t) WEEK_OFFSET * 1000000);
         }
 
 
-      end_record = ftell (fp) / sizeof (POS_OUTPUT_T);
+      nav->end_record = ftell (fp) / sizeof (POS_OUTPUT_T);
 
       fseek (fp, 0, SEEK_SET);
+
+      strncpy (nav->path, path, sizeof (nav->path) - 1);
     }
 
+  nav->fp = fp;
+
+  CHARTS_IO_COUNT (&nav->stats, header_seconds, charts_io_stats_clock () - start);
+
   return (fp);
 }
 
 
-static double interp (double t0, double t1, double t2, double y0, double y2)
+/*  Timestamp (microseconds from 01/01/1970) of a (midnight corrected) gps_time, computed the same way
+    charts_pos_find_record does.  */
+
+static int64_t pos_time (CHARTS_POS_T *nav, double gps_time)
+{
+  return ((int64_t) (((double) nav->start_week + gps_time) * 1000000.0));
+}
+
+
+/*  Reads up to "count" records starting at record "first" (counting from 0) into "buffer", swapped and midnight
+    corrected.  Returns the number read.  */
+
+static int32_t pos_read_block (CHARTS_POS_T *nav, int32_t first, int32_t count, POS_OUTPUT_T *buffer)
+{
+  int32_t           i;
+
+
+  count = MIN (count, nav->end_record - first);
+
+  if (count <= 0 || charts_io_seek (&nav->stats, nav->fp, (int64_t) first * (int64_t) sizeof (POS_OUTPUT_T), SEEK_SET)) return (0);
+
+  count = charts_io_read (&nav->stats, buffer, sizeof (POS_OUTPUT_T), count, nav->fp);
+
+  if (nav->swap)
+    {
+      charts_swap_pos_records (buffer, count);
+      CHARTS_IO_COUNT (&nav->stats, swaps, count);
+    }
+
+
+  /*  Dealing with end of week midnight *&^@$^#%*!  */
+
+  if (nav->midnight)
+    {
+      for (i = 0 ; i < count ; i++) if (buffer[i].gps_time < nav->start_gps_time) buffer[i].gps_time += WEEK_OFFSET;
+    }
+
+  return (count);
+}
+
+
+/*  Interpolates between records "record" - 1 ("prev") and "record" ("next") for gps_time "t1" into "pos" the way
+    charts_pos_set_interp set the handle up.  "before" and "after" are records "record" - 2 and "record" + 1 if the
+    caller has them handy, otherwise NULL.  They're only needed (and read if we have to) when a Hermite segment
+    has to be set up, and the file is left where it was.  */
+
+static void pos_interp (CHARTS_POS_T *nav, int32_t record, const POS_OUTPUT_T *before, const POS_OUTPUT_T *prev,
+                        const POS_OUTPUT_T *next, const POS_OUTPUT_T *after, double t1, POS_OUTPUT_T *pos)
 {
-  return (y0 + (y2 - y0) * ((t1 - t0) / (t2 - t0)));
+  POS_OUTPUT_T      extra[2];
+  uint32_t          mask;
+  int64_t           here = -1;
+
+
+  mask = nav->interp_mask ? nav->interp_mask : POS_FIELD_ALL;
+
+  memset (pos, 0, sizeof (POS_OUTPUT_T));
+
+  if (nav->interp_mode != CHARTS_INTERP_HERMITE)
+    {
+      charts_interp_linear ((const double *) prev, (const double *) next, t1, mask, POS_ANGLE_FIELDS, POS_NUM_FIELDS,
+                            (double *) pos);
+      return;
+    }
+
+
+  if (record != nav->segment_record)
+    {
+      if ((before == NULL && record >= 2) || (after == NULL && record + 1 < nav->end_record)) here = ftello64 (nav->fp);
+
+      if (before == NULL && record >= 2 && pos_read_block (nav, record - 2, 1, &extra[0]) == 1) before = &extra[0];
+      if (after == NULL && record + 1 < nav->end_record && pos_read_block (nav, record + 1, 1, &extra[1]) == 1) after = &extra[1];
+
+      if (here >= 0) charts_io_seek (&nav->stats, nav->fp, here, SEEK_SET);
+
+      charts_interp_segment (&nav->segment, (const double *) before, (const double *) prev, (const double *) next,
+                             (const double *) after, mask, POS_ANGLE_FIELDS, POS_NUM_FIELDS);
+      nav->segment_record = record;
+    }
+
+  charts_interp_eval (&nav->segment, t1, (double *) pos);
 }
 
 
-static POS_OUTPUT_T pos_interp (POS_OUTPUT_T pos, POS_OUTPUT_T prev_pos, double t1)
+/*  Size and modification time of "path", used to tell whether a time index sidecar is still good.  */
+
+static int32_t pos_file_stamp (char *path, int64_t *size, int64_t *mtime)
 {
-  POS_OUTPUT_T new_pos;
+#ifdef NVWIN3X
+  struct _stati64        st;
 
+  if (_stati64 (path, &st)) return (-1);
+#else
+  struct stat64          st;
 
-  new_pos.gps_time = t1;
+  if (stat64 (path, &st)) return (-1);
+#endif
 
-  new_pos.latitude = interp (pos.gps_time, t1, prev_pos.gps_time, pos.latitude, prev_pos.latitude);
-  new_pos.longitude = interp (pos.gps_time, t1, prev_pos.gps_time, pos.longitude, prev_pos.longitude);
-  new_pos.altitude = interp (pos.gps_time, t1, prev_pos.gps_time, pos.altitude, prev_pos.altitude);
-  new_pos.x_velocity = interp (pos.gps_time, t1, prev_pos.gps_time, pos.x_velocity, prev_pos.x_velocity);
-  new_pos.y_velocity = interp (pos.gps_time, t1, prev_pos.gps_time, pos.y_velocity, prev_pos.y_velocity);
-  new_pos.z_velocity = interp (pos.gps_time, t1, prev_pos.gps_time, pos.z_velocity, prev_pos.z_velocity);
-  new_pos.roll = interp (pos.gps_time, t1, prev_pos.gps_time, pos.roll, prev_pos.roll);
-  new_pos.pitch = interp (pos.gps_time, t1, prev_pos.gps_time, pos.pitch, prev_pos.pitch);
-  new_pos.platform_heading = interp (pos.gps_time, t1, prev_pos.gps_time, pos.platform_heading, prev_pos.platform_heading);
-  new_pos.wander_angle = interp (pos.gps_time, t1, prev_pos.gps_time, pos.wander_angle, prev_pos.wander_angle);
-  new_pos.x_body_accel = interp (pos.gps_time, t1, prev_pos.gps_time, pos.x_body_accel, prev_pos.x_body_accel);
-  new_pos.y_body_accel = interp (pos.gps_time, t1, prev_pos.gps_time, pos.y_body_accel, prev_pos.y_body_accel);
-  new_pos.z_body_accel = interp (pos.gps_time, t1, prev_pos.gps_time, pos.z_body_accel, prev_pos.z_body_accel);
-  new_pos.x_body_ang_rate = interp (pos.gps_time, t1, prev_pos.gps_time, pos.x_body_ang_rate, prev_pos.x_body_ang_rate);
-  new_pos.y_body_ang_rate = interp (pos.gps_time, t1, prev_pos.gps_time, pos.y_body_ang_rate, prev_pos.y_body_ang_rate);
-  new_pos.z_body_ang_rate = interp (pos.gps_time, t1, prev_pos.gps_time, pos.z_body_ang_rate, prev_pos.z_body_ang_rate);
+  *size = st.st_size;
+  *mtime = st.st_mtime;
 
-  return (new_pos);
+  return (0);
 }
 
 
+/*  Sets up a sampled time index for "nav": the gps_time of every "stride"th record (CHARTS_POS_INDEX_STRIDE if
+    "stride" is 0 or less).  The index is read from the <pos file>.idx sidecar if that matches the file's size and
+    modification time, otherwise it is built by reading just the sampled records and the sidecar is (re)written if
+    we're allowed to.  After this charts_pos_find_record only needs to read "stride" + 1 records per lookup, and
+    none if the lookup falls in the same stretch as the last one.  Returns 0 on success or -1 on failure.  */
 
-int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
+int32_t charts_pos_use_index (CHARTS_POS_T *nav, int32_t stride)
+{
+  FILE                   *fp;
+  char                   idx_file[1040];
+  POS_INDEX_HEADER_T     head;
+  POS_OUTPUT_T           pos;
+  int64_t                size, mtime;
+  int32_t                i, count;
+  double                 start;
+
+
+  if (nav->fp == NULL) return (-1);
+
+  if (stride <= 0) stride = CHARTS_POS_INDEX_STRIDE;
+
+  pos_free_index (nav);
+
+  if (pos_file_stamp (nav->path, &size, &mtime)) return (-1);
+
+  count = (nav->end_record + stride - 1) / stride;
+
+  if ((nav->index_time = (double *) malloc (count * sizeof (double))) == NULL ||
+      (nav->block = (POS_OUTPUT_T *) malloc ((stride + 1) * sizeof (POS_OUTPUT_T))) == NULL)
+    {
+      perror ("Allocating POS index");
+      pos_free_index (nav);
+      return (-1);
+    }
+
+  nav->index_stride = stride;
+  nav->index_count = count;
+
+  sprintf (idx_file, "%s.idx", nav->path);
+
+
+  /*  Use the sidecar if it was made from this version of the file with this stride.  Loading it counts as a cache
+      hit, having to build the index as a miss.  */
+
+  start = charts_io_stats_clock ();
+
+  if ((fp = fopen64 (idx_file, "rb")) != NULL)
+    {
+      if (fread (&head, sizeof (POS_INDEX_HEADER_T), 1, fp) == 1 && !memcmp (head.magic, POS_INDEX_MAGIC, 16) &&
+          head.version == POS_INDEX_VERSION && head.byte_order == 0x01020304 && head.file_size == size &&
+          head.file_mtime == mtime && head.stride == stride && head.count == count &&
+          fread (nav->index_time, sizeof (double), count, fp) == (size_t) count)
+        {
+          fclose (fp);
+          CHARTS_IO_COUNT (&nav->stats, cache_hits, 1);
+          CHARTS_IO_COUNT (&nav->stats, header_seconds, charts_io_stats_clock () - start);
+          return (0);
+        }
+
+      fclose (fp);
+    }
+
+  CHARTS_IO_COUNT (&nav->stats, cache_misses, 1);
+
+
+  /*  Build it from the sampled records.  */
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (charts_pos_read_record_num (nav, &pos, i * stride))
+        {
+          pos_free_index (nav);
+          return (-1);
+        }
+
+      nav->index_time[i] = pos.gps_time;
+    }
+
+
+  /*  Failing to write the sidecar (read only directory, for instance) just means we'll build it again next time.  */
+
+  if ((fp = fopen64 (idx_file, "wb")) != NULL)
+    {
+      memset (&head, 0, sizeof (POS_INDEX_HEADER_T));
+      memcpy (head.magic, POS_INDEX_MAGIC, 16);
+      head.version = POS_INDEX_VERSION;
+      head.byte_order = 0x01020304;
+      head.file_size = size;
+      head.file_mtime = mtime;
+      head.stride = stride;
+      head.count = count;
+
+      if (fwrite (&head, sizeof (POS_INDEX_HEADER_T), 1, fp) != 1 ||
+          fwrite (nav->index_time, sizeof (double), count, fp) != (size_t) count)
+        {
+          fclose (fp);
+          remove (idx_file);
+        }
+      else
+        {
+          fclose (fp);
+        }
+    }
+
+  return (0);
+}
+
+
+/*  charts_pos_find_record using the sampled time index.  Finds the last sample before "timestamp", reads that
+    stretch of records in one go (unless we already have it) and interpolates between the two records that bracket
+    "timestamp", which is what the interpolation search and walk in charts_pos_find_record end up doing.  */
+
+static int64_t pos_find_indexed (CHARTS_POS_T *nav, POS_OUTPUT_T *pos, int64_t timestamp)
+{
+  int32_t           low, high, mid, first, i;
+  double            t1;
+
+
+  t1 = (double) timestamp / 1000000.0 - nav->start_week;
+
+
+  /*  Last sample with a time before "timestamp" (-1 if there isn't one).  */
+
+  low = 0;
+  high = nav->index_count;
+
+  while (low < high)
+    {
+      mid = low + (high - low) / 2;
+
+      if (pos_time (nav, nav->index_time[mid]) < timestamp)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  first = MAX (low - 1, 0) * nav->index_stride;
+
+
+  if (!nav->block_count || first != nav->block_start)
+    {
+      nav->block_count = pos_read_block (nav, first, nav->index_stride + 1, nav->block);
+      nav->block_start = first;
+    }
+
+
+  /*  First record at or after "timestamp".  */
+
+  for (i = 0 ; i < nav->block_count ; i++) if (pos_time (nav, nav->block[i].gps_time) >= timestamp) break;
+
+  if (i == nav->block_count || nav->block_count < 2) return (0);
+
+  if (!i) i = 1;
+
+  pos_interp (nav, nav->block_start + i, (i >= 2) ? &nav->block[i - 2] : NULL, &nav->block[i - 1], &nav->block[i],
+              (i + 1 < nav->block_count) ? &nav->block[i + 1] : NULL, t1, pos);
+
+  return (timestamp);
+}
+
+
+int64_t charts_pos_find_record (CHARTS_POS_T *nav, POS_OUTPUT_T *pos, int64_t timestamp)
 {
+  FILE              *fp = nav->fp;
   int64_t           x[3], time_found;
   int32_t           y[3], j;
   POS_OUTPUT_T      prev_pos, new_pos;
   double            t1;
 
 
-  if (timestamp < start_timestamp || timestamp > end_timestamp) return (0);
+  if (timestamp < nav->start_timestamp || timestamp > nav->end_timestamp) return (0);
+
+
+  if (nav->index_time) return (pos_find_indexed (nav, pos, timestamp));
 
 
-  t1 = (double) timestamp / 1000000.0 - start_week;
+  t1 = (double) timestamp / 1000000.0 - nav->start_week;
 
 
   /*  Load the x and y values into the local arrays.  */
     
-  y[0] = start_record;
-  y[2] = end_record;
-  x[0] = start_timestamp;
+  y[0] = nav->start_record;
+  y[2] = nav->end_record;
+  x[0] = nav->start_timestamp;
   x[1] = timestamp;
-  x[2] = end_timestamp;
+  x[2] = nav->end_timestamp;
 
 
   /*  Give it three shots at finding the time.    */
@@ -544,21 +817,26 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
   for (j = 0; j < 3; j++)
     {
       y[1] = y[0] + (int32_t) ((double) (y[2] - y[0]) * ((double) (x[1] - x[0]) / (double) (x[2] - x[0])));
+      y[1] = MIN (MAX (y[1], 0), nav->end_record - 1);
 
 
       /*  Get the time of the interpolated record.   */
 
-      fseek (fp, (start_record + y[1] * sizeof (POS_OUTPUT_T)), SEEK_SET);
-      fread (pos, sizeof (POS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_pos (pos);
+      charts_io_seek (&nav->stats, fp, (nav->start_record + y[1] * sizeof (POS_OUTPUT_T)), SEEK_SET);
+      charts_io_read (&nav->stats, pos, sizeof (POS_OUTPUT_T), 1, fp);
+      if (nav->swap)
+        {
+          charts_swap_pos_records (pos, 1);
+          CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+        }
 
 
       /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-      if (midnight && pos->gps_time < start_gps_time) pos->gps_time += WEEK_OFFSET;
+      if (nav->midnight && pos->gps_time < nav->start_gps_time) pos->gps_time += WEEK_OFFSET;
 
 
-      time_found = ((double) start_week + pos->gps_time) * 1000000.0;
+      time_found = ((double) nav->start_week + pos->gps_time) * 1000000.0;
 
 
       /*  If time found is less than the time searched for... */
@@ -591,17 +869,26 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
         {
           y[1]++;
 
-          fseek (fp, (start_record + y[1] * sizeof (POS_OUTPUT_T)), SEEK_SET);
-          fread (pos, sizeof (POS_OUTPUT_T), 1, fp);
-          if (swap) charts_swap_pos (pos);
+
+          /*  Ran off the end of the file (it used to spin here forever).  */
+
+          if (y[1] >= nav->end_record) return (0);
+
+          charts_io_seek (&nav->stats, fp, (nav->start_record + y[1] * sizeof (POS_OUTPUT_T)), SEEK_SET);
+          charts_io_read (&nav->stats, pos, sizeof (POS_OUTPUT_T), 1, fp);
+          if (nav->swap)
+            {
+              charts_swap_pos_records (pos, 1);
+              CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+            }
 
 
           /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-          if (midnight && pos->gps_time < start_gps_time) pos->gps_time += WEEK_OFFSET;
+          if (nav->midnight && pos->gps_time < nav->start_gps_time) pos->gps_time += WEEK_OFFSET;
 
 
-          time_found = ((double) start_week + pos->gps_time) * 1000000.0;
+          time_found = ((double) nav->start_week + pos->gps_time) * 1000000.0;
 
 
           if (time_found >= x[1]) 
@@ -613,8 +900,8 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
 
               if (pos->gps_time - prev_pos.gps_time < 1000000.0)
                 {
-                  new_pos = pos_interp (prev_pos, *pos, t1);
-                  *pos = new_pos;
+                  new_pos = *pos;
+                  pos_interp (nav, y[1], NULL, &prev_pos, &new_pos, NULL, t1, pos);
 
                   /*
                     pos_dump_record (*pos);
@@ -627,6 +914,9 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
                   return (time_found);
                 }
             }
+
+
+          prev_pos = *pos;
         }
     }
 
@@ -639,17 +929,23 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
         {
           y[1]--;
 
-          fseek (fp, (start_record + y[1] * sizeof (POS_OUTPUT_T)), SEEK_SET);
-          fread (pos, sizeof (POS_OUTPUT_T), 1, fp);
-          if (swap) charts_swap_pos (pos);
+          if (y[1] < 0) return (0);
+
+          charts_io_seek (&nav->stats, fp, (nav->start_record + y[1] * sizeof (POS_OUTPUT_T)), SEEK_SET);
+          charts_io_read (&nav->stats, pos, sizeof (POS_OUTPUT_T), 1, fp);
+          if (nav->swap)
+            {
+              charts_swap_pos_records (pos, 1);
+              CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+            }
 
 
           /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-          if (midnight && pos->gps_time < start_gps_time) pos->gps_time += WEEK_OFFSET;
+          if (nav->midnight && pos->gps_time < nav->start_gps_time) pos->gps_time += WEEK_OFFSET;
 
 
-          time_found = ((double) start_week + pos->gps_time) * 1000000.0;
+          time_found = ((double) nav->start_week + pos->gps_time) * 1000000.0;
 
 
           if (time_found <= x[1])
@@ -661,8 +957,8 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
 
               if (pos->gps_time - prev_pos.gps_time < 1000000.0)
                 {
-                  new_pos = pos_interp (*pos, prev_pos, t1);
-                  *pos = new_pos;
+                  new_pos = *pos;
+                  pos_interp (nav, y[1] + 1, NULL, &new_pos, &prev_pos, NULL, t1, pos);
 
                   /*
                     pos_dump_record (*pos);
@@ -675,6 +971,9 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
                   return (time_found);
                 }
             }
+
+
+          prev_pos = *pos;
         }
     }
 
@@ -685,62 +984,373 @@ int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
 }
 
 
-int64_t pos_get_start_timestamp ()
+/*  Returns the first record (counting from 0) at or after "timestamp" using a binary search, narrowed down by the
+    time index if there is one.  "timestamp" must be within the file.  */
+
+static int32_t pos_locate (CHARTS_POS_T *nav, int64_t timestamp)
 {
-  return (start_timestamp);
+  int32_t           low, high, mid;
+  POS_OUTPUT_T      pos;
+
+
+  low = 0;
+
+  if (nav->index_time)
+    {
+      high = nav->index_count;
+
+      while (low < high)
+        {
+          mid = low + (high - low) / 2;
+
+          if (pos_time (nav, nav->index_time[mid]) < timestamp)
+            {
+              low = mid + 1;
+            }
+          else
+            {
+              high = mid;
+            }
+        }
+
+      high = MIN (low * nav->index_stride + 1, nav->end_record);
+      low = MAX (low - 1, 0) * nav->index_stride;
+    }
+  else
+    {
+      high = nav->end_record;
+    }
+
+  while (low < high)
+    {
+      mid = low + (high - low) / 2;
+
+      if (pos_read_block (nav, mid, 1, &pos) == 1 && pos_time (nav, pos.gps_time) < timestamp)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  return (low);
 }
 
 
-int64_t pos_get_end_timestamp ()
+/*  Interpolates the position for each of the "n" "timestamps" into "out".  While the timestamps keep increasing
+    (HOF/TOF shots always do) they're resolved in one forward sweep through the file, reading CHARTS_POS_BATCH
+    records at a time, so there's no searching after the first one.  A timestamp that goes backwards falls back to
+    charts_pos_find_record and the sweep starts over from the next one.  Timestamps outside of the file get a zero
+    filled record.  Returns the number of timestamps resolved or -1 on error.  */
+
+int32_t charts_pos_interp_batch (CHARTS_POS_T *nav, const int64_t *timestamps, size_t n, POS_OUTPUT_T *out)
+{
+  POS_OUTPUT_T      *buffer;
+  int32_t           first = 0, count = 0, i = 0, k, found = 0;
+  size_t            j;
+  int64_t           prev = 0;
+  double            t1;
+
+
+  if ((buffer = (POS_OUTPUT_T *) malloc (CHARTS_POS_BATCH * sizeof (POS_OUTPUT_T))) == NULL)
+    {
+      perror ("Allocating POS batch buffer");
+      return (-1);
+    }
+
+
+  for (j = 0 ; j < n ; j++)
+    {
+      if (timestamps[j] < nav->start_timestamp || timestamps[j] > nav->end_timestamp)
+        {
+          memset (&out[j], 0, sizeof (POS_OUTPUT_T));
+          continue;
+        }
+
+
+      /*  Out of order, do it the hard way and start the sweep over next time.  */
+
+      if (count && timestamps[j] < prev)
+        {
+          if (charts_pos_find_record (nav, &out[j], timestamps[j]))
+            {
+              found++;
+            }
+          else
+            {
+              memset (&out[j], 0, sizeof (POS_OUTPUT_T));
+            }
+
+          count = 0;
+          continue;
+        }
+
+      prev = timestamps[j];
+
+
+      /*  Start (or restart) the sweep one record before the first record at or after this timestamp.  */
+
+      if (!count)
+        {
+          first = MAX (pos_locate (nav, timestamps[j]) - 1, 0);
+          count = pos_read_block (nav, first, CHARTS_POS_BATCH, buffer);
+          i = 0;
+        }
+
+
+      /*  Move forward to the first record at or after the timestamp, sliding the buffer along as needed but keeping
+          the last record so we always have the one before.  */
+
+      while (1)
+        {
+          while (i < count && pos_time (nav, buffer[i].gps_time) < timestamps[j]) i++;
+
+          if (i < count || first + count >= nav->end_record) break;
+
+          buffer[0] = buffer[count - 1];
+          first += count - 1;
+          count = 1 + pos_read_block (nav, first + 1, CHARTS_POS_BATCH - 1, &buffer[1]);
+          i = 1;
+
+          if (count == 1) break;
+        }
+
+      if (i >= count || count < 2)
+        {
+          memset (&out[j], 0, sizeof (POS_OUTPUT_T));
+          count = 0;
+          continue;
+        }
+
+
+      t1 = (double) timestamps[j] / 1000000.0 - nav->start_week;
+
+      k = MAX (i, 1);
+      pos_interp (nav, first + k, (k >= 2) ? &buffer[k - 2] : NULL, &buffer[k - 1], &buffer[k],
+                  (k + 1 < count) ? &buffer[k + 1] : NULL, t1, &out[j]);
+      found++;
+    }
+
+
+  free (buffer);
+
+  return (found);
+}
+
+
+/*  Sets how charts_pos_find_record and charts_pos_interp_batch interpolate between records.  "mode" is
+    CHARTS_INTERP_LINEAR (the default) or CHARTS_INTERP_HERMITE and "mask" is an OR of the POS_FIELD_* bits for the
+    fields to interpolate (0 means all of them).  Fields not in "mask" come back as zero.  Returns 0 or -1 if "mode"
+    is bogus.  */
+
+int32_t charts_pos_set_interp (CHARTS_POS_T *nav, int32_t mode, uint32_t mask)
 {
-  return (end_timestamp);
+  if (mode != CHARTS_INTERP_LINEAR && mode != CHARTS_INTERP_HERMITE)
+    {
+      fprintf (stderr, "Unknown POS interpolation mode %d\n", mode);
+      fflush (stderr);
+      return (-1);
+    }
+
+  nav->interp_mode = mode;
+  nav->interp_mask = mask ? mask : POS_FIELD_ALL;
+  nav->segment_record = 0;
+
+  return (0);
 }
 
 
-int64_t pos_get_timestamp (POS_OUTPUT_T pos)
+int64_t charts_pos_get_start_timestamp (CHARTS_POS_T *nav)
+{
+  return (nav->start_timestamp);
+}
+
+
+int64_t charts_pos_get_end_timestamp (CHARTS_POS_T *nav)
+{
+  return (nav->end_timestamp);
+}
+
+
+int64_t charts_pos_get_timestamp (CHARTS_POS_T *nav, POS_OUTPUT_T pos)
 {
   int64_t time_found;
 
-  if (midnight && pos.gps_time < start_gps_time) pos.gps_time += WEEK_OFFSET;
+  if (nav->midnight && pos.gps_time < nav->start_gps_time) pos.gps_time += WEEK_OFFSET;
 
-  time_found = ((double) start_week + pos.gps_time) * 1000000.0;
+  time_found = ((double) nav->start_week + pos.gps_time) * 1000000.0;
 
   return (time_found);
 }
 
 
-int32_t pos_read_record (FILE *fp, POS_OUTPUT_T *pos)
+int32_t charts_pos_read_record (CHARTS_POS_T *nav, POS_OUTPUT_T *pos)
 {
-  if (!fread (pos, sizeof (POS_OUTPUT_T), 1, fp)) return (-1);
-  if (swap) charts_swap_pos (pos);
+  FILE              *fp = nav->fp;
+
+
+  if (!charts_io_read (&nav->stats, pos, sizeof (POS_OUTPUT_T), 1, fp)) return (-1);
+  if (nav->swap)
+    {
+      charts_swap_pos_records (pos, 1);
+      CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+    }
 
 
   /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-  if (midnight && pos->gps_time < start_gps_time) pos->gps_time += WEEK_OFFSET;
+  if (nav->midnight && pos->gps_time < nav->start_gps_time) pos->gps_time += WEEK_OFFSET;
 
 
   return (0);
 }
 
 
-int32_t pos_read_record_num (FILE *fp, POS_OUTPUT_T *pos, int32_t recnum)
+int32_t charts_pos_read_record_num (CHARTS_POS_T *nav, POS_OUTPUT_T *pos, int32_t recnum)
 {
-  if (fseek (fp, recnum * sizeof (POS_OUTPUT_T), SEEK_SET)) return (-1);
+  FILE              *fp = nav->fp;
+
+
+  if (charts_io_seek (&nav->stats, fp, recnum * sizeof (POS_OUTPUT_T), SEEK_SET)) return (-1);
 
-  if (!fread (pos, sizeof (POS_OUTPUT_T), 1, fp)) return (-1);
-  if (swap) charts_swap_pos (pos);
+  if (!charts_io_read (&nav->stats, pos, sizeof (POS_OUTPUT_T), 1, fp)) return (-1);
+  if (nav->swap)
+    {
+      charts_swap_pos_records (pos, 1);
+      CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+    }
 
 
   /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-  if (midnight && pos->gps_time < start_gps_time) pos->gps_time += WEEK_OFFSET;
+  if (nav->midnight && pos->gps_time < nav->start_gps_time) pos->gps_time += WEEK_OFFSET;
 
 
   return (0);
 }
 
 
+CHARTS_POS_T *charts_pos_open (char *path)
+{
+  CHARTS_POS_T    *nav;
+
+
+  if ((nav = (CHARTS_POS_T *) calloc (1, sizeof (CHARTS_POS_T))) == NULL)
+    {
+      perror ("Allocating POS handle");
+      return (NULL);
+    }
+
+  if (pos_load (nav, path) == NULL)
+    {
+      free (nav);
+      return (NULL);
+    }
+
+  return (nav);
+}
+
+
+void charts_pos_close (CHARTS_POS_T *nav)
+{
+  if (nav == NULL) return;
+
+  if (nav->fp != NULL) fclose (nav->fp);
+
+  pos_free_index (nav);
+
+  free (nav);
+}
+
+
+FILE *charts_pos_fp (CHARTS_POS_T *nav)
+{
+  return (nav->fp);
+}
+
+
+/*  I/O counters for "nav".  A NULL handle gets the counters for the FILE based calls.  */
+
+CHARTS_IO_STATS_T *charts_pos_stats (CHARTS_POS_T *nav)
+{
+  return (nav ? &nav->stats : &l_pos.stats);
+}
+
+
+FILE *open_pos_file (char *path)
+{
+  return (pos_load (&l_pos, path));
+}
+
+
+int32_t pos_use_index (FILE *fp, int32_t stride)
+{
+  l_pos.fp = fp;
+
+  return (charts_pos_use_index (&l_pos, stride));
+}
+
+
+int32_t pos_set_interp (FILE *fp, int32_t mode, uint32_t mask)
+{
+  l_pos.fp = fp;
+
+  return (charts_pos_set_interp (&l_pos, mode, mask));
+}
+
+
+int32_t pos_interp_batch (FILE *fp, const int64_t *timestamps, size_t n, POS_OUTPUT_T *out)
+{
+  l_pos.fp = fp;
+
+  return (charts_pos_interp_batch (&l_pos, timestamps, n, out));
+}
+
+
+int64_t pos_find_record (FILE *fp, POS_OUTPUT_T *pos, int64_t timestamp)
+{
+  l_pos.fp = fp;
+
+  return (charts_pos_find_record (&l_pos, pos, timestamp));
+}
+
+
+int64_t pos_get_start_timestamp ()
+{
+  return (charts_pos_get_start_timestamp (&l_pos));
+}
+
+
+int64_t pos_get_end_timestamp ()
+{
+  return (charts_pos_get_end_timestamp (&l_pos));
+}
+
+
+int64_t pos_get_timestamp (POS_OUTPUT_T pos)
+{
+  return (charts_pos_get_timestamp (&l_pos, pos));
+}
+
+
+int32_t pos_read_record (FILE *fp, POS_OUTPUT_T *pos)
+{
+  l_pos.fp = fp;
+
+  return (charts_pos_read_record (&l_pos, pos));
+}
+
+
+int32_t pos_read_record_num (FILE *fp, POS_OUTPUT_T *pos, int32_t recnum)
+{
+  l_pos.fp = fp;
+
+  return (charts_pos_read_record_num (&l_pos, pos, recnum));
+}
+
+
 void pos_dump_record (POS_OUTPUT_T pos)
 {
   fprintf (stderr, "GPS seconds of week : %f\n", pos.gps_time);
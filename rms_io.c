@@ -23,11 +23,28 @@
 
 #include "FileRMSOutput.h"
 
-static uint8_t swap = 1;
-static uint8_t midnight = 0.0;
-static double start_gps_time = 0.0;
-static int64_t start_timestamp, end_timestamp, start_week;
-static int32_t year, month, day, start_record, end_record;
+/*  Per file state for the handle based calls (charts_rms_*).  The FILE based calls are thin wrappers around
+    these that use "l_rms" so they behave the way they always have, one RMS file at a time.  */
+
+struct CHARTS_RMS
+{
+  FILE             *fp;
+  uint8_t          swap;
+  uint8_t          midnight;
+  double           start_gps_time;
+  int64_t          start_timestamp;
+  int64_t          end_timestamp;
+  int64_t          start_week;
+  int32_t          start_record;
+  int32_t          end_record;
+  CHARTS_IO_STATS_T stats;
+  int32_t          interp_mode;      /*  charts_rms_set_interp.  */
+  uint32_t         interp_mask;
+  int32_t          segment_record;   /*  Record "segment" ends at (0 if none).  */
+  CHARTS_INTERP_SEGMENT_T segment;
+};
+
+static CHARTS_RMS_T l_rms = {.fp = NULL, .swap = 1, .midnight = 0, .start_gps_time = 0.0};
 
 
 #ifdef NVWIN3X
@@ -37,7 +54,12 @@ static int32_t year, month, day, start_record, end_record;
 #endif
 
 
-#define WEEK_OFFSET  7.0L * 86400.0L * 1000000.0L
+#define WEEK_OFFSET  7.0L * 86400.0L
+
+
+/*  Number of doubles after gps_time in RMS_OUTPUT_T.  */
+
+#define RMS_NUM_FIELDS   9
 
 
 
@@ -341,33 +363,33 @@ uint8_t get_rms_file (char *htpi_file, char *rms_file)
 
 
 
-static void charts_swap_rms (RMS_OUTPUT_T *rms)
+/*  RMS_OUTPUT_T is nothing but doubles so "count" records are just one array of doubles.  */
+
+void charts_swap_rms_records (RMS_OUTPUT_T *records, size_t count)
 {
-  charts_swap_double (&rms->gps_time);
-  charts_swap_double (&rms->north_pos_rms);
-  charts_swap_double (&rms->south_pos_rms);
-  charts_swap_double (&rms->down_pos_rms);
-  charts_swap_double (&rms->north_vel_rms);
-  charts_swap_double (&rms->south_vel_rms);
-  charts_swap_double (&rms->down_vel_rms);
-  charts_swap_double (&rms->roll_rms);
-  charts_swap_double (&rms->pitch_rms);
-  charts_swap_double (&rms->heading_rms);
+  charts_swap_array_64 (records, count * (sizeof (RMS_OUTPUT_T) / sizeof (double)));
 }
 
 
-FILE *open_rms_file (char *path)
+/*  Opens the file and sets up "nav".  Returns the FILE pointer or NULL on failure.  */
+
+static FILE *rms_load (CHARTS_RMS_T *nav, char *path)
 {
   FILE                   *fp;
   RMS_OUTPUT_T           rms;
-  time_t                 tv_sec;
-  struct tm              tm;
-  static int32_t         tz_set = 0;
+  int64_t                tv_sec;
+  int32_t                year, month, day;
+  double                 start;
 
 
   int32_t big_endian ();
 
 
+  memset (&nav->stats, 0, sizeof (CHARTS_IO_STATS_T));
+  nav->segment_record = 0;
+  start = charts_io_stats_clock ();
+
+
   /*  Check the file name for following the naming convention as best we can.  */
 
   if (path[strlen (path) - 16] != '_' || path[strlen (path) - 9] != '_' || path[strlen (path) - 4] != '.')
@@ -382,140 +404,152 @@ FILE *open_rms_file (char *path)
   sscanf (&path[strlen (path) - 15], "%02d%02d%02d", &year, &month, &day);
 
 
-  /*  tm struct wants years since 1900!!!  */
-
-  tm.tm_year = year + 100;
-  tm.tm_mon = month - 1;
-  tm.tm_mday = day;
-  tm.tm_hour = 0.0;
-  tm.tm_min = 0.0;
-  tm.tm_sec = 0.0;
-  tm.tm_isdst = -1;
-
-  if (!tz_set)
-    {
-#ifdef NVWIN3X
-  #if defined (__MINGW64__) || defined (__MINGW32__)
-      putenv("TZ=GMT");
-      tzset();
-  #else
-      _putenv("TZ=GMT");
-      _tzset();
-  #endif
-#else
-      putenv("TZ=GMT");
-      tzset();
-#endif
-      tz_set = 1;
-    }
-
-
-  /*  Get seconds from the epoch (01-01-1970) for the date in the filename. 
-      This will also give us the day of the week for the GPS seconds of
-      week calculation.  */
+  /*  Get seconds from the epoch (01-01-1970) for the date in the filename.  */
 
-  tv_sec = mktime (&tm);
+  tv_sec = charts_utc_time (year + 2000, month, day);
 
 
-  /*  Subtract the number of days since Saturday midnight (Sunday morning) in seconds.  */
+  /*  Subtract the number of days since Saturday midnight (Sunday morning) in seconds.  01-01-1970 was a Thursday.  */
 
-  tv_sec = tv_sec - (tm.tm_wday * 86400);
-  start_week = tv_sec;
+  tv_sec = tv_sec - (((tv_sec / 86400) + 4) % 7) * 86400;
+  nav->start_week = tv_sec;
 
 
   /*  We have to assume that the file is little endian since there is no
       header and no field that we can use to deduce what it is.  */
 
-  swap = (uint8_t) big_endian ();
+  nav->swap = (uint8_t) big_endian ();
 
 
   if ((fp = fopen (path, "rb")) == NULL)
     {
+      nav->fp = NULL;
       return ((FILE *) NULL);
     }
   else
     {
       fread (&rms, sizeof (RMS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_rms (&rms);
-      start_timestamp = (int64_t) (((double) start_week + rms.gps_time) * 1000000.0);
-      start_record = 0;
-      start_gps_time = rms.gps_time;
+      if (nav->swap) charts_swap_rms_records (&rms, 1);
+      nav->start_timestamp = (int64_t) (((double) nav->start_week + rms.gps_time) * 1000000.0);
+      nav->start_record = 0;
+      nav->start_gps_time = rms.gps_time;
 
 
       fseek (fp, -(sizeof (RMS_OUTPUT_T)), SEEK_END);
 
       fread (&rms, sizeof (RMS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_rms (&rms);
-      end_timestamp = (int64_t) (((double) start_week + rms.gps_time) * 1000000.0);
+      if (nav->swap) charts_swap_rms_records (&rms, 1);
+      nav->end_timestamp = (int64_t) (((double) nav->start_week + rms.gps_time) * 1000000.0);
 
 
       /*  Check for crossing midnight at end of GPS week (stupid f***ing Applanix bozos).  */
 
-      if (end_timestamp < start_timestamp)
+      if (nav->end_timestamp < nav->start_timestamp)
         {
-          midnight = 1;
-          end_timestamp += WEEK_OFFSET;
+          nav->midnight = 1;
+          nav->end_timestamp += ((int64_t) WEEK_OFFSET * 1000000);
         }
 
 
-      end_record = ftell (fp) / sizeof (RMS_OUTPUT_T);
+      nav->end_record = ftell (fp) / sizeof (RMS_OUTPUT_T);
 
       fseek (fp, 0, SEEK_SET);
     }
 
+  nav->fp = fp;
+
+  CHARTS_IO_COUNT (&nav->stats, header_seconds, charts_io_stats_clock () - start);
+
   return (fp);
 }
 
 
-static double interp (double t0, double t1, double t2, double y0, double y2)
+/*  Reads record "record" for a Hermite neighbor.  Returns 1 or 0 if it isn't there.  */
+
+static int32_t rms_read_neighbor (CHARTS_RMS_T *nav, int32_t record, RMS_OUTPUT_T *rms)
 {
-  return (y0 + (y2 - y0) * ((t1 - t0) / (t2 - t0)));
+  if (record < 0 || record >= nav->end_record) return (0);
+
+  if (charts_io_seek (&nav->stats, nav->fp, (nav->start_record + record * sizeof (RMS_OUTPUT_T)), SEEK_SET)) return (0);
+  if (!charts_io_read (&nav->stats, rms, sizeof (RMS_OUTPUT_T), 1, nav->fp)) return (0);
+
+  if (nav->swap)
+    {
+      charts_swap_rms_records (rms, 1);
+      CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+    }
+
+  if (nav->midnight && rms->gps_time < nav->start_gps_time) rms->gps_time += WEEK_OFFSET;
+
+  return (1);
 }
 
 
-static RMS_OUTPUT_T rms_interp (RMS_OUTPUT_T rms, RMS_OUTPUT_T prev_rms, double t1)
+/*  Interpolates between records "record" - 1 ("prev") and "record" ("next") for gps_time "t1" into "rms" the way
+    charts_rms_set_interp set the handle up.  For Hermite the records on either side are read when the segment
+    changes, and the file is left where it was.  */
+
+static void rms_interp (CHARTS_RMS_T *nav, int32_t record, const RMS_OUTPUT_T *prev, const RMS_OUTPUT_T *next,
+                        double t1, RMS_OUTPUT_T *rms)
 {
-  RMS_OUTPUT_T new_rms;
+  RMS_OUTPUT_T      before, after;
+  uint32_t          mask;
+  int32_t           got_before, got_after;
+  int64_t           here;
 
 
-  new_rms.gps_time = t1;
+  mask = nav->interp_mask ? nav->interp_mask : RMS_FIELD_ALL;
 
-  new_rms.north_pos_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.north_pos_rms, prev_rms.north_pos_rms);
-  new_rms.south_pos_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.south_pos_rms, prev_rms.south_pos_rms);
-  new_rms.down_pos_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.down_pos_rms, prev_rms.down_pos_rms);
-  new_rms.north_vel_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.north_vel_rms, prev_rms.north_vel_rms);
-  new_rms.south_vel_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.south_vel_rms, prev_rms.south_vel_rms);
-  new_rms.down_vel_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.down_vel_rms, prev_rms.down_vel_rms);
-  new_rms.roll_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.roll_rms, prev_rms.roll_rms);
-  new_rms.pitch_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.pitch_rms, prev_rms.pitch_rms);
-  new_rms.heading_rms = interp (rms.gps_time, t1, prev_rms.gps_time, rms.heading_rms, prev_rms.heading_rms);
+  memset (rms, 0, sizeof (RMS_OUTPUT_T));
 
-  return (new_rms);
-}
+  if (nav->interp_mode != CHARTS_INTERP_HERMITE)
+    {
+      charts_interp_linear ((const double *) prev, (const double *) next, t1, mask, 0, RMS_NUM_FIELDS, (double *) rms);
+      return;
+    }
 
 
+  if (record != nav->segment_record)
+    {
+      here = ftello64 (nav->fp);
 
-int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
+      got_before = rms_read_neighbor (nav, record - 2, &before);
+      got_after = rms_read_neighbor (nav, record + 1, &after);
+
+      if (here >= 0) charts_io_seek (&nav->stats, nav->fp, here, SEEK_SET);
+
+      charts_interp_segment (&nav->segment, got_before ? (const double *) &before : NULL, (const double *) prev,
+                             (const double *) next, got_after ? (const double *) &after : NULL, mask, 0,
+                             RMS_NUM_FIELDS);
+      nav->segment_record = record;
+    }
+
+  charts_interp_eval (&nav->segment, t1, (double *) rms);
+}
+
+
+int64_t charts_rms_find_record (CHARTS_RMS_T *nav, RMS_OUTPUT_T *rms, int64_t timestamp)
 {
+  FILE              *fp = nav->fp;
   int64_t           x[3], time_found;
   int32_t           y[3], j;
   RMS_OUTPUT_T      prev_rms, new_rms;
   double            t1;
 
 
-  if (timestamp < start_timestamp || timestamp > end_timestamp) return (0);
+  if (timestamp < nav->start_timestamp || timestamp > nav->end_timestamp) return (0);
 
 
-  t1 = (double) timestamp / 1000000.0 - start_week;
+  t1 = (double) timestamp / 1000000.0 - nav->start_week;
 
 
   /*  Load the x and y values into the local arrays.  */
     
-  y[0] = start_record;
-  y[2] = end_record;
-  x[0] = start_timestamp;
+  y[0] = nav->start_record;
+  y[2] = nav->end_record;
+  x[0] = nav->start_timestamp;
   x[1] = timestamp;
-  x[2] = end_timestamp;
+  x[2] = nav->end_timestamp;
 
 
   /*  Give it three shots at finding the time.    */
@@ -527,17 +561,21 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
 
       /*  Get the time of the interpolated record.   */
 
-      fseek (fp, (start_record + y[1] * sizeof (RMS_OUTPUT_T)), SEEK_SET);
-      fread (rms, sizeof (RMS_OUTPUT_T), 1, fp);
-      if (swap) charts_swap_rms (rms);
+      charts_io_seek (&nav->stats, fp, (nav->start_record + y[1] * sizeof (RMS_OUTPUT_T)), SEEK_SET);
+      charts_io_read (&nav->stats, rms, sizeof (RMS_OUTPUT_T), 1, fp);
+      if (nav->swap)
+        {
+          charts_swap_rms_records (rms, 1);
+          CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+        }
 
 
       /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-      if (midnight && rms->gps_time < start_gps_time) rms->gps_time += WEEK_OFFSET;
+      if (nav->midnight && rms->gps_time < nav->start_gps_time) rms->gps_time += WEEK_OFFSET;
 
 
-      time_found = ((double) start_week + rms->gps_time) * 1000000.0;
+      time_found = ((double) nav->start_week + rms->gps_time) * 1000000.0;
 
 
       /*  If time found is less than the time searched for... */
@@ -570,17 +608,23 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
         {
           y[1]++;
 
-          fseek (fp, (start_record + y[1] * sizeof (RMS_OUTPUT_T)), SEEK_SET);
-          fread (rms, sizeof (RMS_OUTPUT_T), 1, fp);
-          if (swap) charts_swap_rms (rms);
+          if (y[1] >= nav->end_record) return (0);
+
+          charts_io_seek (&nav->stats, fp, (nav->start_record + y[1] * sizeof (RMS_OUTPUT_T)), SEEK_SET);
+          charts_io_read (&nav->stats, rms, sizeof (RMS_OUTPUT_T), 1, fp);
+          if (nav->swap)
+            {
+              charts_swap_rms_records (rms, 1);
+              CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+            }
 
 
           /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-          if (midnight && rms->gps_time < start_gps_time) rms->gps_time += WEEK_OFFSET;
+          if (nav->midnight && rms->gps_time < nav->start_gps_time) rms->gps_time += WEEK_OFFSET;
 
 
-          time_found = ((double) start_week + rms->gps_time) * 1000000.0;
+          time_found = ((double) nav->start_week + rms->gps_time) * 1000000.0;
 
 
           if (time_found >= x[1]) 
@@ -592,8 +636,8 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
 
               if (rms->gps_time - prev_rms.gps_time < 1000000.0)
                 {
-                  new_rms = rms_interp (prev_rms, *rms, t1);
-                  *rms = new_rms;
+                  new_rms = *rms;
+                  rms_interp (nav, y[1], &prev_rms, &new_rms, t1, rms);
 
                   /*
                     rms_dump_record (*rms);
@@ -606,6 +650,9 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
                   return (time_found);
                 }
             }
+
+
+          prev_rms = *rms;
         }
     }
 
@@ -618,17 +665,23 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
         {
           y[1]--;
 
-          fseek (fp, (start_record + y[1] * sizeof (RMS_OUTPUT_T)), SEEK_SET);
-          fread (rms, sizeof (RMS_OUTPUT_T), 1, fp);
-          if (swap) charts_swap_rms (rms);
+          if (y[1] < 0) return (0);
+
+          charts_io_seek (&nav->stats, fp, (nav->start_record + y[1] * sizeof (RMS_OUTPUT_T)), SEEK_SET);
+          charts_io_read (&nav->stats, rms, sizeof (RMS_OUTPUT_T), 1, fp);
+          if (nav->swap)
+            {
+              charts_swap_rms_records (rms, 1);
+              CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+            }
 
 
           /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-          if (midnight && rms->gps_time < start_gps_time) rms->gps_time += WEEK_OFFSET;
+          if (nav->midnight && rms->gps_time < nav->start_gps_time) rms->gps_time += WEEK_OFFSET;
 
 
-          time_found = ((double) start_week + rms->gps_time) * 1000000.0;
+          time_found = ((double) nav->start_week + rms->gps_time) * 1000000.0;
 
 
           if (time_found <= x[1])
@@ -640,8 +693,8 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
 
               if (rms->gps_time - prev_rms.gps_time < 1000000.0)
                 {
-                  new_rms = rms_interp (*rms, prev_rms, t1);
-                  *rms = new_rms;
+                  new_rms = *rms;
+                  rms_interp (nav, y[1] + 1, &new_rms, &prev_rms, t1, rms);
 
                   /*
                     rms_dump_record (*rms);
@@ -654,6 +707,9 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
                   return (time_found);
                 }
             }
+
+
+          prev_rms = *rms;
         }
     }
 
@@ -664,50 +720,180 @@ int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
 }
 
 
-int64_t rms_get_start_timestamp ()
+/*  Sets how charts_rms_find_record interpolates between records.  "mode" is CHARTS_INTERP_LINEAR (the default) or
+    CHARTS_INTERP_HERMITE and "mask" is an OR of the RMS_FIELD_* bits for the fields to interpolate (0 means all of
+    them).  Fields not in "mask" come back as zero.  Returns 0 or -1 if "mode" is bogus.  */
+
+int32_t charts_rms_set_interp (CHARTS_RMS_T *nav, int32_t mode, uint32_t mask)
 {
-  return (start_timestamp);
+  if (mode != CHARTS_INTERP_LINEAR && mode != CHARTS_INTERP_HERMITE)
+    {
+      fprintf (stderr, "Unknown RMS interpolation mode %d\n", mode);
+      fflush (stderr);
+      return (-1);
+    }
+
+  nav->interp_mode = mode;
+  nav->interp_mask = mask ? mask : RMS_FIELD_ALL;
+  nav->segment_record = 0;
+
+  return (0);
 }
 
 
-int64_t rms_get_end_timestamp ()
+int64_t charts_rms_get_start_timestamp (CHARTS_RMS_T *nav)
 {
-  return (end_timestamp);
+  return (nav->start_timestamp);
 }
 
 
-int32_t rms_read_record (FILE *fp, RMS_OUTPUT_T *rms)
+int64_t charts_rms_get_end_timestamp (CHARTS_RMS_T *nav)
 {
-  if (!fread (rms, sizeof (RMS_OUTPUT_T), 1, fp)) return (-1);
-  if (swap) charts_swap_rms (rms);
+  return (nav->end_timestamp);
+}
+
+
+int32_t charts_rms_read_record (CHARTS_RMS_T *nav, RMS_OUTPUT_T *rms)
+{
+  FILE              *fp = nav->fp;
+
+
+  if (!charts_io_read (&nav->stats, rms, sizeof (RMS_OUTPUT_T), 1, fp)) return (-1);
+  if (nav->swap)
+    {
+      charts_swap_rms_records (rms, 1);
+      CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+    }
 
 
   /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-  if (midnight && rms->gps_time < start_gps_time) rms->gps_time += WEEK_OFFSET;
+  if (nav->midnight && rms->gps_time < nav->start_gps_time) rms->gps_time += WEEK_OFFSET;
 
 
   return (0);
 }
 
 
-int32_t rms_read_record_num (FILE *fp, RMS_OUTPUT_T *rms, int32_t recnum)
+int32_t charts_rms_read_record_num (CHARTS_RMS_T *nav, RMS_OUTPUT_T *rms, int32_t recnum)
 {
-  if (fseek (fp, recnum * sizeof (RMS_OUTPUT_T), SEEK_SET)) return (-1);
+  FILE              *fp = nav->fp;
 
-  if (!fread (rms, sizeof (RMS_OUTPUT_T), 1, fp)) return (-1);
-  if (swap) charts_swap_rms (rms);
+
+  if (charts_io_seek (&nav->stats, fp, recnum * sizeof (RMS_OUTPUT_T), SEEK_SET)) return (-1);
+
+  if (!charts_io_read (&nav->stats, rms, sizeof (RMS_OUTPUT_T), 1, fp)) return (-1);
+  if (nav->swap)
+    {
+      charts_swap_rms_records (rms, 1);
+      CHARTS_IO_COUNT (&nav->stats, swaps, 1);
+    }
 
 
   /*  Dealing with end of week midnight *&^@$^#%*!  */
 
-  if (midnight && rms->gps_time < start_gps_time) rms->gps_time += WEEK_OFFSET;
+  if (nav->midnight && rms->gps_time < nav->start_gps_time) rms->gps_time += WEEK_OFFSET;
 
 
   return (0);
 }
 
 
+CHARTS_RMS_T *charts_rms_open (char *path)
+{
+  CHARTS_RMS_T    *nav;
+
+
+  if ((nav = (CHARTS_RMS_T *) calloc (1, sizeof (CHARTS_RMS_T))) == NULL)
+    {
+      perror ("Allocating RMS handle");
+      return (NULL);
+    }
+
+  if (rms_load (nav, path) == NULL)
+    {
+      free (nav);
+      return (NULL);
+    }
+
+  return (nav);
+}
+
+
+void charts_rms_close (CHARTS_RMS_T *nav)
+{
+  if (nav == NULL) return;
+
+  if (nav->fp != NULL) fclose (nav->fp);
+
+  free (nav);
+}
+
+
+FILE *charts_rms_fp (CHARTS_RMS_T *nav)
+{
+  return (nav->fp);
+}
+
+
+/*  I/O counters for "nav".  A NULL handle gets the counters for the FILE based calls.  */
+
+CHARTS_IO_STATS_T *charts_rms_stats (CHARTS_RMS_T *nav)
+{
+  return (nav ? &nav->stats : &l_rms.stats);
+}
+
+
+FILE *open_rms_file (char *path)
+{
+  return (rms_load (&l_rms, path));
+}
+
+
+int32_t rms_set_interp (FILE *fp, int32_t mode, uint32_t mask)
+{
+  l_rms.fp = fp;
+
+  return (charts_rms_set_interp (&l_rms, mode, mask));
+}
+
+
+int64_t rms_find_record (FILE *fp, RMS_OUTPUT_T *rms, int64_t timestamp)
+{
+  l_rms.fp = fp;
+
+  return (charts_rms_find_record (&l_rms, rms, timestamp));
+}
+
+
+int64_t rms_get_start_timestamp ()
+{
+  return (charts_rms_get_start_timestamp (&l_rms));
+}
+
+
+int64_t rms_get_end_timestamp ()
+{
+  return (charts_rms_get_end_timestamp (&l_rms));
+}
+
+
+int32_t rms_read_record (FILE *fp, RMS_OUTPUT_T *rms)
+{
+  l_rms.fp = fp;
+
+  return (charts_rms_read_record (&l_rms, rms));
+}
+
+
+int32_t rms_read_record_num (FILE *fp, RMS_OUTPUT_T *rms, int32_t recnum)
+{
+  l_rms.fp = fp;
+
+  return (charts_rms_read_record_num (&l_rms, rms, recnum));
+}
+
+
 void rms_dump_record (RMS_OUTPUT_T rms)
 {
   fprintf (stderr, "GPS seconds of week      : %f\n", rms.gps_time);
@@ -23,6 +23,50 @@
 
 #include "charts.h"
 
+
+/*  The SSSE3/AVX2 kernels are only built with compilers that support per-function target attributes.  The CPU is
+    checked at run time so the library still runs on machines without them.  */
+
+#if (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+#define CHARTS_SWAP_X86
+#include <immintrin.h>
+#endif
+
+
+/*  Records larger than this (in bytes) are swapped field run by field run instead of with a whole record shuffle.  */
+
+#define CHARTS_SWAP_MAX_RECORD   512
+
+
+static inline uint16_t charts_bswap16 (uint16_t x)
+{
+#if defined (__GNUC__) || defined (__clang__)
+  return (__builtin_bswap16 (x));
+#else
+  return ((uint16_t) ((x << 8) | (x >> 8)));
+#endif
+}
+
+
+static inline uint32_t charts_bswap32 (uint32_t x)
+{
+#if defined (__GNUC__) || defined (__clang__)
+  return (__builtin_bswap32 (x));
+#else
+  return ((x << 24) | ((x & 0x0000ff00) << 8) | ((x & 0x00ff0000) >> 8) | (x >> 24));
+#endif
+}
+
+
+static inline uint64_t charts_bswap64 (uint64_t x)
+{
+#if defined (__GNUC__) || defined (__clang__)
+  return (__builtin_bswap64 (x));
+#else
+  return (((uint64_t) charts_bswap32 ((uint32_t) x) << 32) | charts_bswap32 ((uint32_t) (x >> 32)));
+#endif
+}
+
 /***************************************************************************\
 *                                                                           *
 *   Module Name:        swap_int32_t                                        *
@@ -45,17 +89,7 @@
 
 void charts_swap_int32_t (int32_t *word)
 {
-    uint32_t    temp[4];
-
-    temp[0] = *word & 0x000000ff;
-
-    temp[1] = (*word & 0x0000ff00) >> 8;
-
-    temp[2] = (*word & 0x00ff0000) >> 16;
-
-    temp[3] = (*word & 0xff000000) >> 24;
-
-    *word = (temp[0] << 24) + (temp[1] << 16) + (temp[2] << 8) + temp[3];
+    *word = (int32_t) charts_bswap32 ((uint32_t) *word);
 }
 
 
@@ -82,8 +116,6 @@ void charts_swap_int32_t (int32_t *word)
 
 void charts_swap_float (float *word)
 {
-    uint32_t    temp[4];
-
     union
     {
         uint32_t    iword;
@@ -92,15 +124,7 @@ void charts_swap_float (float *word)
 
     eq.fword = *word;
 
-    temp[0] = eq.iword & 0x000000ff;
-
-    temp[1] = (eq.iword & 0x0000ff00) >> 8;
-
-    temp[2] = (eq.iword & 0x00ff0000) >> 16;
-
-    temp[3] = (eq.iword & 0xff000000) >> 24;
-
-    eq.iword = (temp[0] << 24) + (temp[1] << 16) + (temp[2] << 8) + temp[3];
+    eq.iword = charts_bswap32 (eq.iword);
 
     *word = eq.fword;
 
@@ -131,38 +155,22 @@ void charts_swap_float (float *word)
 
 void charts_swap_double (double *word)
 {
-    int32_t    i;
-    char     temp;
     union
     {
-        char     bytes[8];
+        uint64_t i;
         double  d;
     }eq;
-    
-    memcpy (&eq.bytes, word, 8);
 
-    for (i = 0 ; i < 4 ; i++)
-    {
-        temp = eq.bytes[i];
-        eq.bytes[i] = eq.bytes[7 - i];
-        eq.bytes[7 - i] = temp;
-    }
+    eq.d = *word;
+
+    eq.i = charts_bswap64 (eq.i);
 
     *word = eq.d;
 }
 
 void charts_swap_int64_t (int64_t *word)
 {
-    union
-    {
-      double d;
-      uint64_t i;
-    } eq;
-
-    eq.i = *word;
-    charts_swap_double (&eq.d);
-
-    *word = eq.i;
+    *word = (int64_t) charts_bswap64 ((uint64_t) *word);
 }
 
 
@@ -188,11 +196,308 @@ void charts_swap_int64_t (int64_t *word)
 
 void charts_swap_int16_t (int16_t *word)
 {
-    int16_t   temp;
+    *word = (int16_t) charts_bswap16 ((uint16_t) *word);
 
-    swab (word, &temp, 2);
+    return;
+}
 
-    *word = temp;
 
-    return;
+
+/*  pshufb masks that reverse the bytes of each 2, 4 or 8 byte value in a 32 byte block.  The 128 bit kernels only use
+    the first 16 bytes.  */
+
+static const uint8_t swap_mask_16[32] = {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                         1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+static const uint8_t swap_mask_32[32] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                         3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+static const uint8_t swap_mask_64[32] = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                         7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+
+#ifdef CHARTS_SWAP_X86
+
+/*  Returns 2 if the CPU has AVX2, 1 if it only has SSSE3, and 0 otherwise.  */
+
+static int32_t charts_swap_level (void)
+{
+    static int32_t level = -1;
+
+
+    if (level < 0)
+    {
+        __builtin_cpu_init ();
+
+        if (__builtin_cpu_supports ("avx2"))
+        {
+            level = 2;
+        }
+        else if (__builtin_cpu_supports ("ssse3"))
+        {
+            level = 1;
+        }
+        else
+        {
+            level = 0;
+        }
+    }
+
+    return (level);
+}
+
+
+/*  These shuffle whole 32 or 16 byte blocks of "data" and return the number of bytes they handled.  */
+
+__attribute__ ((target ("avx2"))) static size_t swap_bytes_avx2 (uint8_t *data, size_t bytes, const uint8_t *mask)
+{
+    size_t      i;
+    __m256i     m = _mm256_loadu_si256 ((const __m256i *) mask);
+
+
+    for (i = 0 ; i + 32 <= bytes ; i += 32)
+    {
+        _mm256_storeu_si256 ((__m256i *) (data + i), _mm256_shuffle_epi8 (_mm256_loadu_si256 ((const __m256i *) (data + i)), m));
+    }
+
+    return (i);
+}
+
+
+__attribute__ ((target ("ssse3"))) static size_t swap_bytes_ssse3 (uint8_t *data, size_t bytes, const uint8_t *mask)
+{
+    size_t      i;
+    __m128i     m = _mm_loadu_si128 ((const __m128i *) mask);
+
+
+    for (i = 0 ; i + 16 <= bytes ; i += 16)
+    {
+        _mm_storeu_si128 ((__m128i *) (data + i), _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + i)), m));
+    }
+
+    return (i);
+}
+
+
+/*  Whole record shuffles.  "mask" is "size" bytes long and "size" is a multiple of 16.  */
+
+__attribute__ ((target ("avx2"))) static void swap_records_avx2 (uint8_t *rec, size_t count, size_t size, const uint8_t *mask)
+{
+    size_t      i, j;
+
+
+    for (i = 0 ; i < count ; i++, rec += size)
+    {
+        for (j = 0 ; j + 32 <= size ; j += 32)
+        {
+            _mm256_storeu_si256 ((__m256i *) (rec + j), _mm256_shuffle_epi8 (_mm256_loadu_si256 ((const __m256i *) (rec + j)),
+                                                                            _mm256_loadu_si256 ((const __m256i *) (mask + j))));
+        }
+
+        if (j < size)
+        {
+            _mm_storeu_si128 ((__m128i *) (rec + j), _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (rec + j)),
+                                                                      _mm_loadu_si128 ((const __m128i *) (mask + j))));
+        }
+    }
+}
+
+
+__attribute__ ((target ("ssse3"))) static void swap_records_ssse3 (uint8_t *rec, size_t count, size_t size, const uint8_t *mask)
+{
+    size_t      i, j;
+
+
+    for (i = 0 ; i < count ; i++, rec += size)
+    {
+        for (j = 0 ; j < size ; j += 16)
+        {
+            _mm_storeu_si128 ((__m128i *) (rec + j), _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (rec + j)),
+                                                                      _mm_loadu_si128 ((const __m128i *) (mask + j))));
+        }
+    }
+}
+
+
+/*  Builds a "size" byte shuffle mask from the field runs.  Returns 0 if a field straddles a 16 byte boundary (pshufb
+    can't move bytes between lanes).  */
+
+static int32_t swap_build_mask (uint8_t *mask, size_t size, const CHARTS_SWAP_RUN_T *runs, int32_t num_runs)
+{
+    int32_t     i, j, k;
+    size_t      offset;
+
+
+    for (offset = 0 ; offset < size ; offset++) mask[offset] = offset & 15;
+
+    for (k = 0 ; k < num_runs ; k++)
+    {
+        for (i = 0 ; i < runs[k].count ; i++)
+        {
+            offset = runs[k].offset + i * runs[k].size;
+
+            if ((offset & 15) + runs[k].size > 16 || offset + runs[k].size > size) return (0);
+
+            for (j = 0 ; j < runs[k].size ; j++) mask[offset + j] = (offset & 15) + runs[k].size - 1 - j;
+        }
+    }
+
+    return (1);
+}
+
+#endif
+
+
+static void charts_swap_array (void *data, size_t count, int32_t width, const uint8_t *mask)
+{
+    uint8_t     *bytes = (uint8_t *) data;
+    size_t      i, done = 0;
+    uint16_t    v16;
+    uint32_t    v32;
+    uint64_t    v64;
+
+
+#ifdef CHARTS_SWAP_X86
+    int32_t     level = charts_swap_level ();
+
+    if (level == 2) done = swap_bytes_avx2 (bytes, count * width, mask);
+    if (level >= 1) done += swap_bytes_ssse3 (bytes + done, count * width - done, mask);
+#else
+    (void) mask;
+#endif
+
+
+    /*  Whatever is left (or everything, on other CPUs).  memcpy keeps this safe for unaligned data.  */
+
+    for (i = done ; i < count * width ; i += width)
+    {
+        switch (width)
+        {
+        case 2:
+            memcpy (&v16, bytes + i, 2);
+            v16 = charts_bswap16 (v16);
+            memcpy (bytes + i, &v16, 2);
+            break;
+
+        case 4:
+            memcpy (&v32, bytes + i, 4);
+            v32 = charts_bswap32 (v32);
+            memcpy (bytes + i, &v32, 4);
+            break;
+
+        case 8:
+            memcpy (&v64, bytes + i, 8);
+            v64 = charts_bswap64 (v64);
+            memcpy (bytes + i, &v64, 8);
+            break;
+        }
+    }
+}
+
+
+
+/***************************************************************************\
+*                                                                           *
+*   Module Name:        charts_swap_array_16, _32, _64                      *
+*                                                                           *
+*   Date Written:       October 2026                                        *
+*                                                                           *
+*   Purpose:            These functions swap bytes in "count" contiguous    *
+*                       two, four or eight byte values (ints, floats or     *
+*                       doubles).  SSSE3 or AVX2 byte shuffles are used     *
+*                       when the CPU has them.                              *
+*                                                                           *
+*   Arguments:          data                -   pointer to the values       *
+*                       count               -   number of values            *
+*                                                                           *
+\***************************************************************************/
+
+void charts_swap_array_16 (void *data, size_t count)
+{
+    charts_swap_array (data, count, 2, swap_mask_16);
+}
+
+
+void charts_swap_array_32 (void *data, size_t count)
+{
+    charts_swap_array (data, count, 4, swap_mask_32);
+}
+
+
+void charts_swap_array_64 (void *data, size_t count)
+{
+    charts_swap_array (data, count, 8, swap_mask_64);
+}
+
+
+
+/***************************************************************************\
+*                                                                           *
+*   Module Name:        charts_swap_records                                 *
+*                                                                           *
+*   Date Written:       October 2026                                        *
+*                                                                           *
+*   Purpose:            This function swaps "count" contiguous records of   *
+*                       "size" bytes.  The fields that need swapping are    *
+*                       described by "runs" (offset, size and count of      *
+*                       each run of same sized fields).  When the record    *
+*                       size is a multiple of 16 the whole record is        *
+*                       swapped with one shuffle per 16 or 32 bytes.        *
+*                                                                           *
+*   Arguments:          records             -   pointer to the records      *
+*                       count               -   number of records           *
+*                       size                -   record size in bytes        *
+*                       runs                -   field runs                  *
+*                       num_runs            -   number of runs              *
+*                                                                           *
+\***************************************************************************/
+
+void charts_swap_records (void *records, size_t count, size_t size, const CHARTS_SWAP_RUN_T *runs, int32_t num_runs)
+{
+    uint8_t     *rec = (uint8_t *) records;
+    size_t      i;
+    int32_t     k;
+
+
+#ifdef CHARTS_SWAP_X86
+    uint8_t     mask[CHARTS_SWAP_MAX_RECORD];
+    int32_t     level = charts_swap_level ();
+
+
+    /*  Building the mask isn't worth it for a record or two.  */
+
+    if (level && count > 2 && !(size & 15) && size <= CHARTS_SWAP_MAX_RECORD && swap_build_mask (mask, size, runs, num_runs))
+    {
+        if (level == 2)
+        {
+            swap_records_avx2 (rec, count, size, mask);
+        }
+        else
+        {
+            swap_records_ssse3 (rec, count, size, mask);
+        }
+
+        return;
+    }
+#endif
+
+
+    for (i = 0 ; i < count ; i++, rec += size)
+    {
+        for (k = 0 ; k < num_runs ; k++)
+        {
+            switch (runs[k].size)
+            {
+            case 2:
+                charts_swap_array_16 (rec + runs[k].offset, runs[k].count);
+                break;
+
+            case 4:
+                charts_swap_array_32 (rec + runs[k].offset, runs[k].count);
+                break;
+
+            case 8:
+                charts_swap_array_64 (rec + runs[k].offset, runs[k].count);
+                break;
+            }
+        }
+    }
 }
@@ -24,10 +24,24 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <stddef.h>
 
 #include "FileTopoOutput.h"
+#include "charts_edit.h"
 
-static uint8_t swap = 1;
+/*  Per file state for the handle based calls (charts_tof_*).  The FILE based calls are thin wrappers around
+    these that use "l_tof" so they behave the way they always have, one TOF file at a time.  */
+
+struct CHARTS_TOF
+{
+  FILE             *fp;
+  uint8_t          swap;
+  int32_t          num_records;
+  TOF_HEADER_T     head;
+  CHARTS_IO_STATS_T stats;
+};
+
+static CHARTS_TOF_T l_tof = {.fp = NULL, .swap = 1};
 
 
 static void charts_swap_tof_header (TOF_HEADER_T *head)
@@ -71,21 +85,22 @@ static void charts_swap_tof_header (TOF_HEADER_T *head)
 }
 
 
-static void charts_swap_tof_record (TOPO_OUTPUT_T *record)
+/*  The byte swapped fields of TOPO_OUTPUT_T.  */
+
+static const CHARTS_SWAP_RUN_T tof_swap_runs[] =
+{
+  {offsetof (TOPO_OUTPUT_T, timestamp), 8, 1},
+  {offsetof (TOPO_OUTPUT_T, latitude_first), 8, 4},
+  {offsetof (TOPO_OUTPUT_T, elevation_first), 4, 4},
+  {offsetof (TOPO_OUTPUT_T, result_elevation_first), 4, 4}
+};
+
+
+/*  Swaps "count" contiguous TOF records in place.  */
+
+void charts_swap_tof_records (TOPO_OUTPUT_T *records, size_t count)
 {
-  charts_swap_int64_t (&record->timestamp);
-  charts_swap_double (&record->latitude_first);
-  charts_swap_double (&record->longitude_first);
-  charts_swap_double (&record->latitude_last);
-  charts_swap_double (&record->longitude_last);
-  charts_swap_float (&record->elevation_first);
-  charts_swap_float (&record->elevation_last);
-  charts_swap_float (&record->scanner_azimuth);
-  charts_swap_float (&record->nadir_angle);
-  charts_swap_float (&record->result_elevation_first);
-  charts_swap_float (&record->result_elevation_last);
-  charts_swap_float (&record->altitude);
-  charts_swap_float (&record->tbdfloat);
+  charts_swap_records (records, count, sizeof (TOPO_OUTPUT_T), tof_swap_runs, sizeof (tof_swap_runs) / sizeof (CHARTS_SWAP_RUN_T));
 }
 
 
@@ -112,24 +127,58 @@ FILE *open_tof_file (char *path)
 }
 
 
-int32_t tof_read_header (FILE *fp, TOF_HEADER_T *head)
-{
-  int64_t     long_pos;
-  char        varin[1024], info[1024];
-  int16_t     tmpi16;
+/*  Keys of the ASCII header, in the order they're written.  */
 
-
-  char *ngets (char *s, int32_t size, FILE *stream);
+static const CHARTS_HEADER_FIELD_T tof_header_fields[] =
+{
+  CHARTS_HEADER_FIELD ("FileType",               CHARTS_HEADER_STRING, TOF_TEXT_T, file_type),
+  CHARTS_HEADER_FIELD ("EndianType",             CHARTS_HEADER_ENDIAN, TOF_TEXT_T, endian),
+  CHARTS_HEADER_FIELD ("SoftwareVersionNumber",  CHARTS_HEADER_FLOAT,  TOF_TEXT_T, software_version),
+  CHARTS_HEADER_FIELD ("FileVersionNumber",      CHARTS_HEADER_FLOAT,  TOF_TEXT_T, file_version),
+  CHARTS_HEADER_FIELD ("Processed By",           CHARTS_HEADER_STRING, TOF_TEXT_T, UserName),
+  CHARTS_HEADER_FIELD ("HeaderSize",             CHARTS_HEADER_INT32,  TOF_TEXT_T, header_size),
+  CHARTS_HEADER_FIELD ("TextBlockSize",          CHARTS_HEADER_INT32,  TOF_TEXT_T, text_block_size),
+  CHARTS_HEADER_FIELD ("BinaryBlockSize",        CHARTS_HEADER_INT32,  TOF_TEXT_T, bin_block_size),
+  CHARTS_HEADER_FIELD ("RecordSize",             CHARTS_HEADER_INT32,  TOF_TEXT_T, record_size),
+  CHARTS_HEADER_FIELD ("ABSystemType",           CHARTS_HEADER_INT8,   TOF_TEXT_T, ab_system_type),
+  CHARTS_HEADER_FIELD ("ABSystemNumber",         CHARTS_HEADER_INT8,   TOF_TEXT_T, ab_system_number),
+  CHARTS_HEADER_FIELD ("SystemRepRate",          CHARTS_HEADER_INT16,  TOF_TEXT_T, system_rep_rate),
+  CHARTS_HEADER_FIELD ("Project",                CHARTS_HEADER_STRING, TOF_TEXT_T, project),
+  CHARTS_HEADER_FIELD ("Mission",                CHARTS_HEADER_STRING, TOF_TEXT_T, mission),
+  CHARTS_HEADER_FIELD ("Dataset",                CHARTS_HEADER_STRING, TOF_TEXT_T, dataset),
+  CHARTS_HEADER_FIELD ("FlightlineNumber",       CHARTS_HEADER_STRING, TOF_TEXT_T, flightline_number),
+  CHARTS_HEADER_FIELD ("CodedFLNumber",          CHARTS_HEADER_INT16,  TOF_TEXT_T, coded_fl_number),
+  CHARTS_HEADER_FIELD ("FlightDate",             CHARTS_HEADER_STRING, TOF_TEXT_T, flight_date),
+  CHARTS_HEADER_FIELD ("StartTime",              CHARTS_HEADER_STRING, TOF_TEXT_T, start_time),
+  CHARTS_HEADER_FIELD ("EndTime",                CHARTS_HEADER_STRING, TOF_TEXT_T, end_time),
+  CHARTS_HEADER_FIELD ("StartTimestamp",         CHARTS_HEADER_INT64,  TOF_TEXT_T, start_timestamp),
+  CHARTS_HEADER_FIELD ("EndTimestamp",           CHARTS_HEADER_INT64,  TOF_TEXT_T, end_timestamp),
+  CHARTS_HEADER_FIELD ("NumberShots",            CHARTS_HEADER_INT32,  TOF_TEXT_T, number_shots),
+  CHARTS_HEADER_FIELD ("FileCreateDate",         CHARTS_HEADER_STRING, TOF_TEXT_T, dataset_create_date),
+  CHARTS_HEADER_FIELD ("FileCreateTime",         CHARTS_HEADER_STRING, TOF_TEXT_T, dataset_create_time),
+  CHARTS_HEADER_FIELD ("LineMinLat",             CHARTS_HEADER_DOUBLE, TOF_TEXT_T, line_min_lat),
+  CHARTS_HEADER_FIELD ("LineMaxLat",             CHARTS_HEADER_DOUBLE, TOF_TEXT_T, line_max_lat),
+  CHARTS_HEADER_FIELD ("LineMinLong",            CHARTS_HEADER_DOUBLE, TOF_TEXT_T, line_min_lon),
+  CHARTS_HEADER_FIELD ("LineMaxLong",            CHARTS_HEADER_DOUBLE, TOF_TEXT_T, line_max_lon)
+};
+
+CHARTS_HEADER_TABLE_T charts_tof_header_table = CHARTS_HEADER_TABLE (tof_header_fields);
+
+
+/*  Parses the ASCII header and sets "l_swap" from the EndianType entry.  This is shared by tof_read_header and
+    charts_tof_open so that each keeps its own swap state.  */
+
+static int32_t tof_parse_header (FILE *fp, TOF_HEADER_T *head, uint8_t *l_swap)
+{
   int32_t big_endian ();
 
 
-  swap = 0;
+  *l_swap = 0;
 
 
   fseeko64 (fp, 0LL, SEEK_SET);
 
 
-
   /*  Read each entry.    */
 
   head->text.header_size = 0;
@@ -137,111 +186,182 @@ int32_t tof_read_header (FILE *fp, TOF_HEADER_T *head)
   head->text.line_max_lat = 0.0;
   head->text.line_min_lon = 0.0;
   head->text.line_max_lon = 0.0;
-  while (ngets (varin, sizeof (varin), fp) != NULL)
+
+  if (charts_header_read (fp, &charts_tof_header_table, &head->text, &head->text.header_size))
+    *l_swap = (head->text.endian == big_endian ());
+
+
+  /*  Make sure we're past the header.  */
+
+  fseeko64 (fp, (int64_t) head->text.header_size, SEEK_SET);
+
+
+  return (0);
+}
+
+
+/*  Opens a TOF file (read/write if possible) and reads the header.  Returns NULL on failure.  */
+
+CHARTS_TOF_T *charts_tof_open (char *path)
+{
+  CHARTS_TOF_T    *tof;
+  int64_t         file_size;
+  double          start;
+
+
+  if ((tof = (CHARTS_TOF_T *) calloc (1, sizeof (CHARTS_TOF_T))) == NULL)
     {
-      if (!strcmp (varin, "EOF")) break;
+      perror ("Allocating TOF handle");
+      return (NULL);
+    }
 
+  start = charts_io_stats_clock ();
 
-      /*  Put everything to the right of the colon into 'info'.   */
-            
-      if (strchr (varin, ':') != NULL) strcpy (info, (char *) (strchr (varin, ':') + 1));
+  if ((tof->fp = open_tof_file (path)) == NULL)
+    {
+      free (tof);
+      return (NULL);
+    }
 
+  tof_parse_header (tof->fp, &tof->head, &tof->swap);
 
-      /*  Check input for matching strings and load values if found.  */
-            
-      if (strstr (varin, "FileType:") != NULL) lidar_get_string (varin, head->text.file_type);
 
-      if (strstr (varin, "EndianType:") != NULL)
-        {
-          if (strstr (info, "Little")) 
-            {
-              head->text.endian = 1;
-              if (big_endian ()) swap = 1;
-            }
-          else
-            {
-              head->text.endian = 1;
-              if (!big_endian ()) swap = 1;
-            }
-        }
+  fseeko64 (tof->fp, 0LL, SEEK_END);
+  file_size = ftello64 (tof->fp);
 
+  if (file_size > TOF_HEAD_SIZE) tof->num_records = (int32_t) ((file_size - TOF_HEAD_SIZE) / (int64_t) sizeof (TOPO_OUTPUT_T));
 
-      if (strstr (varin, "SoftwareVersionNumber:") != NULL) sscanf (info, "%f", &head->text.software_version);
+  fseeko64 (tof->fp, (int64_t) TOF_HEAD_SIZE, SEEK_SET);
 
-      if (strstr (varin, "FileVersionNumber:") != NULL) sscanf (info, "%f", &head->text.file_version);
+  CHARTS_IO_COUNT (&tof->stats, header_seconds, charts_io_stats_clock () - start);
 
 
-      if (strstr (varin, "Processed By:") != NULL) lidar_get_string (varin, head->text.UserName);
+  return (tof);
+}
 
 
-      if (strstr (varin, "HeaderSize:") != NULL) sscanf (info, "%d", &head->text.header_size);
+void charts_tof_close (CHARTS_TOF_T *tof)
+{
+  if (tof == NULL) return;
 
-      if (strstr (varin, "TextBlockSize:") != NULL) sscanf (info, "%d", &head->text.text_block_size);
+  if (tof->fp != NULL) fclose (tof->fp);
 
-      if (strstr (varin, "BinaryBlockSize:") != NULL) sscanf (info, "%d", &head->text.bin_block_size);
+  free (tof);
+}
 
-      if (strstr (varin, "RecordSize:") != NULL) sscanf (info, "%d", &head->text.record_size);
 
+FILE *charts_tof_fp (CHARTS_TOF_T *tof)
+{
+  return (tof->fp);
+}
 
-      if (strstr (varin, "ABSystemType:") != NULL)
-        {
-          sscanf (info, "%hd", &tmpi16);
-          head->text.ab_system_type = (int8_t) tmpi16;
-        }
 
-      if (strstr (varin, "ABSystemNumber:") != NULL)
-        {
-          sscanf (info, "%hd", &tmpi16);
-          head->text.ab_system_number = (int8_t) tmpi16;
-        }
+TOF_HEADER_T *charts_tof_header (CHARTS_TOF_T *tof)
+{
+  return (&tof->head);
+}
 
-      if (strstr (varin, "SystemRepRate:") != NULL) sscanf (info, "%hd", &head->text.system_rep_rate);
 
+int32_t charts_tof_num_records (CHARTS_TOF_T *tof)
+{
+  return (tof->num_records);
+}
 
-      if (strstr (varin, "Project:") != NULL) lidar_get_string (varin, head->text.project);
 
-      if (strstr (varin, "Mission:") != NULL) lidar_get_string (varin, head->text.mission);
+/*  I/O counters for "tof".  A NULL handle gets the counters for the FILE based calls.  */
 
-      if (strstr (varin, "Dataset:") != NULL) lidar_get_string (varin, head->text.dataset);
+CHARTS_IO_STATS_T *charts_tof_stats (CHARTS_TOF_T *tof)
+{
+  return (tof ? &tof->stats : &l_tof.stats);
+}
 
-      if (strstr (varin, "FlightlineNumber:") != NULL) lidar_get_string (varin, head->text.flightline_number);
 
-      if (strstr (varin, "CodedFLNumber:") != NULL) sscanf (info, "%hd", &head->text.coded_fl_number);
+/*  Note that we're counting from 1 not 0.  Not my idea!  */
 
-      if (strstr (varin, "FlightDate:") != NULL) lidar_get_string (varin, head->text.flight_date);
+int32_t charts_tof_read_record (CHARTS_TOF_T *tof, int32_t num, TOPO_OUTPUT_T *record)
+{
+  int32_t ret;
+  int64_t long_pos;
 
-      if (strstr (varin, "StartTime:") != NULL) lidar_get_string (varin, head->text.start_time);
 
-      if (strstr (varin, "EndTime:") != NULL) lidar_get_string (varin, head->text.end_time);
+  if (!num)
+    {
+      fprintf (stderr, "Zero is not a valid TOF record number\n");
+      fflush (stderr);
+      return (0);
+    }
 
-      if (strstr (varin, "StartTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->text.start_timestamp);
 
-      if (strstr (varin, "EndTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->text.end_timestamp);
+  if (num != TOF_NEXT_RECORD)
+    {
+      charts_io_seek (&tof->stats, tof->fp, (int64_t) TOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (TOPO_OUTPUT_T), SEEK_SET);
+    }
+  else
+    {
+      long_pos = ftello64 (tof->fp);
+      if (long_pos < TOF_HEAD_SIZE) charts_io_seek (&tof->stats, tof->fp, (int64_t) TOF_HEAD_SIZE, SEEK_SET);
+    }
+
+
+  ret = charts_io_read (&tof->stats, record, sizeof (TOPO_OUTPUT_T), 1, tof->fp);
 
-      if (strstr (varin, "NumberShots:") != NULL) sscanf (info, "%d", &head->text.number_shots);
 
-      if (strstr (varin, "FileCreateDate:") != NULL) lidar_get_string (varin, head->text.dataset_create_date);
+  if (tof->swap)
+    {
+      charts_swap_tof_records (record, 1);
+      CHARTS_IO_COUNT (&tof->stats, swaps, 1);
+    }
 
-      if (strstr (varin, "FileCreateTime:") != NULL) lidar_get_string (varin, head->text.dataset_create_time);
 
-      if (strstr (varin, "LineMinLat:") != NULL) sscanf (info, "%lf", &head->text.line_min_lat);
+  return (ret);
+}
 
-      if (strstr (varin, "LineMaxLat:") != NULL) sscanf (info, "%lf", &head->text.line_max_lat);
 
-      if (strstr (varin, "LineMinLong:") != NULL) sscanf (info, "%lf", &head->text.line_min_lon);
+/*  Reads "count" records starting at record "first" (counting from 1) into "buffer" with a single seek and read,
+    then swaps the whole batch if needed.  Returns the number of records actually read (less than "count" at the
+    end of the file).  */
 
-      if (strstr (varin, "LineMaxLong:") != NULL) sscanf (info, "%lf", &head->text.line_max_lon);
+int32_t charts_tof_read_records (CHARTS_TOF_T *tof, int32_t first, int32_t count, TOPO_OUTPUT_T *buffer)
+{
+  int32_t ret;
 
 
-      long_pos = ftello64 (fp);
-      if (head->text.header_size && long_pos >= head->text.header_size) break;
+  if (first < 1 || count < 1)
+    {
+      fprintf (stderr, "Invalid TOF record range %d, %d\n", first, count);
+      fflush (stderr);
+      return (0);
     }
 
 
-  /*  Make sure we're past the header.  */
+  charts_io_seek (&tof->stats, tof->fp, (int64_t) TOF_HEAD_SIZE + (int64_t) (first - 1) * (int64_t) sizeof (TOPO_OUTPUT_T), SEEK_SET);
+
+  ret = charts_io_read (&tof->stats, buffer, sizeof (TOPO_OUTPUT_T), count, tof->fp);
 
-  fseeko64 (fp, (int64_t) head->text.header_size, SEEK_SET);
 
+  if (tof->swap && ret > 0)
+    {
+      charts_swap_tof_records (buffer, ret);
+      CHARTS_IO_COUNT (&tof->stats, swaps, ret);
+    }
+
+
+  return (ret);
+}
+
+
+int32_t charts_tof_write_header (CHARTS_TOF_T *tof, TOF_HEADER_T *head)
+{
+  TOF_HEADER_T     l_head;
+
+
+  l_head = *head;
+
+  charts_io_seek (&tof->stats, tof->fp, 0LL, SEEK_SET);
+
+  if (tof->swap) charts_swap_tof_header (&l_head);
+
+  charts_io_write (&tof->stats, &l_head, sizeof (TOF_HEADER_T), 1, tof->fp);
 
   return (0);
 }
@@ -249,10 +369,10 @@ int32_t tof_read_header (FILE *fp, TOF_HEADER_T *head)
 
 /*  Note that we're counting from 1 not 0.  Not my idea!  */
 
-int32_t tof_read_record (FILE *fp, int32_t num, TOPO_OUTPUT_T *record)
+int32_t charts_tof_write_record (CHARTS_TOF_T *tof, int32_t num, TOPO_OUTPUT_T *record)
 {
-  int32_t ret;
-  int64_t long_pos;
+  int32_t ret, last;
+  TOPO_OUTPUT_T l_record;
 
 
   if (!num)
@@ -263,67 +383,345 @@ int32_t tof_read_record (FILE *fp, int32_t num, TOPO_OUTPUT_T *record)
     }
 
 
-  if (num != TOF_NEXT_RECORD)
-    {
-      fseeko64 (fp, (int64_t) TOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (TOPO_OUTPUT_T), SEEK_SET);
-    }
-  else
+  if (num != TOF_NEXT_RECORD) charts_io_seek (&tof->stats, tof->fp, (int64_t) TOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (TOPO_OUTPUT_T), SEEK_SET);
+
+
+  /*  Swap a copy, not the caller's record.  */
+
+  l_record = *record;
+  if (tof->swap)
     {
-      long_pos = ftello64 (fp);
-      if (long_pos < TOF_HEAD_SIZE) fseeko64 (fp, (int64_t) TOF_HEAD_SIZE, SEEK_SET);
+      charts_swap_tof_records (&l_record, 1);
+      CHARTS_IO_COUNT (&tof->stats, swaps, 1);
     }
 
 
-  ret = fread (record, sizeof (TOPO_OUTPUT_T), 1, fp);
+  ret = charts_io_write (&tof->stats, &l_record, sizeof (TOPO_OUTPUT_T), 1, tof->fp);
 
 
-  if (swap) charts_swap_tof_record (record);
+  /*  Keep track of the number of records if we're extending the file.  */
+
+  last = (int32_t) ((ftello64 (tof->fp) - TOF_HEAD_SIZE) / (int64_t) sizeof (TOPO_OUTPUT_T));
+  if (last > tof->num_records) tof->num_records = last;
 
 
   return (ret);
 }
 
 
-int32_t tof_write_header (FILE *fp, TOF_HEADER_T head)
+/*  Buffered writer for rewriting or extending a TOF file.  Records are copied into "buffer" (so the caller's
+    records are never touched) and written CHARTS_TOF_APPEND_BLOCK at a time starting at record "next".  */
+
+struct CHARTS_TOF_APPEND
 {
-  fseeko64 (fp, 0LL, SEEK_SET);
+  CHARTS_TOF_T     *tof;
+  TOPO_OUTPUT_T    *buffer;
+  int32_t          count;
+  int32_t          next;
+  int32_t          status;
+};
 
-  if (swap) charts_swap_tof_header (&head);
 
-  fwrite (&head, sizeof (TOF_HEADER_T), 1, fp);
+static void *tof_aligned_alloc (size_t size)
+{
+  void             *ptr;
 
-  return (0);
+
+#ifdef NVWIN3X
+  ptr = _aligned_malloc (size, 4096);
+#else
+  if (posix_memalign (&ptr, 4096, size)) ptr = NULL;
+#endif
+
+  return (ptr);
 }
 
 
-/*  Note that we're counting from 1 not 0.  Not my idea!  */
+static void tof_aligned_free (void *ptr)
+{
+#ifdef NVWIN3X
+  _aligned_free (ptr);
+#else
+  free (ptr);
+#endif
+}
 
-int32_t tof_write_record (FILE *fp, int32_t num, TOPO_OUTPUT_T *record)
+
+/*  Starts writing records to "tof" at record "first" (TOF_NEXT_RECORD to append after the last record).
+    Returns NULL on failure.  */
+
+CHARTS_TOF_APPEND_T *charts_tof_append_open (CHARTS_TOF_T *tof, int32_t first)
 {
-  int32_t ret;
+  CHARTS_TOF_APPEND_T   *app;
 
 
-  if (!num)
+  if (first == TOF_NEXT_RECORD) first = tof->num_records + 1;
+
+  if (first < 1 || first > tof->num_records + 1)
     {
-      fprintf (stderr, "Zero is not a valid TOF record number\n");
+      fprintf (stderr, "Invalid TOF append record %d\n", first);
       fflush (stderr);
-      return (0);
+      return (NULL);
     }
 
 
-  if (num != TOF_NEXT_RECORD) fseeko64 (fp, (int64_t) TOF_HEAD_SIZE + (int64_t) (num - 1) * (int64_t) sizeof (TOPO_OUTPUT_T), SEEK_SET);
+  if ((app = (CHARTS_TOF_APPEND_T *) calloc (1, sizeof (CHARTS_TOF_APPEND_T))) == NULL ||
+      (app->buffer = (TOPO_OUTPUT_T *) tof_aligned_alloc (CHARTS_TOF_APPEND_BLOCK * sizeof (TOPO_OUTPUT_T))) == NULL)
+    {
+      perror ("Allocating TOF appender");
+      free (app);
+      return (NULL);
+    }
 
+  app->tof = tof;
+  app->next = first;
 
-  if (swap) charts_swap_tof_record (record);
+  return (app);
+}
 
 
-  ret = fwrite (record, sizeof (TOPO_OUTPUT_T), 1, fp);
+/*  Writes out whatever is in the buffer.  Returns 0 on success or -1 if this (or an earlier) write failed.  */
 
+int32_t charts_tof_append_flush (CHARTS_TOF_APPEND_T *app)
+{
+  if (!app->count || app->status) return (app->status);
+
+
+  if (app->tof->swap)
+    {
+      charts_swap_tof_records (app->buffer, app->count);
+      CHARTS_IO_COUNT (&app->tof->stats, swaps, app->count);
+    }
+
+  if (charts_io_seek (&app->tof->stats, app->tof->fp, (int64_t) TOF_HEAD_SIZE + (int64_t) (app->next - 1) * (int64_t) sizeof (TOPO_OUTPUT_T), SEEK_SET) ||
+      charts_io_write (&app->tof->stats, app->buffer, sizeof (TOPO_OUTPUT_T), app->count, app->tof->fp) != (size_t) app->count)
+    {
+      perror ("Writing TOF records");
+      app->status = -1;
+      return (-1);
+    }
+
+  app->next += app->count;
+  app->count = 0;
+
+  if (app->next - 1 > app->tof->num_records) app->tof->num_records = app->next - 1;
+
+  return (0);
+}
+
+
+/*  Adds "count" records.  Returns 0 on success or -1 on a write error.  */
+
+int32_t charts_tof_append (CHARTS_TOF_APPEND_T *app, const TOPO_OUTPUT_T *records, int32_t count)
+{
+  int32_t          n;
+
+
+  while (count > 0 && !app->status)
+    {
+      n = MIN (count, CHARTS_TOF_APPEND_BLOCK - app->count);
+
+      memcpy (&app->buffer[app->count], records, n * sizeof (TOPO_OUTPUT_T));
+
+      app->count += n;
+      records += n;
+      count -= n;
+
+      if (app->count == CHARTS_TOF_APPEND_BLOCK) charts_tof_append_flush (app);
+    }
+
+  return (app->status);
+}
+
+
+static int32_t tof_patch_failed (const char *key)
+{
+  fprintf (stderr, "Unable to update %s in the TOF header (missing or no room in the text block)\n", key);
+  fflush (stderr);
+
+
+  /*  So the caller's perror doesn't say "Success".  */
+
+  errno = EINVAL;
+
+  return (-1);
+}
+
+
+/*  Sets NumberShots, StartTimestamp and EndTimestamp in the ASCII header and num_shots, start_time and stop_time in
+    the binary (info) header from the records now in the file.  Other header entries are left alone.  Returns 0 or
+    -1 on failure, in which case the header on disk isn't changed.  */
+
+static int32_t tof_patch_header (CHARTS_TOF_T *tof)
+{
+  TOF_HEADER_T     head;
+  TOPO_OUTPUT_T   first, last;
+  char             value[64];
+
+
+  memset (&first, 0, sizeof (TOPO_OUTPUT_T));
+  memset (&last, 0, sizeof (TOPO_OUTPUT_T));
+
+  if (tof->num_records > 0 && (charts_tof_read_records (tof, 1, 1, &first) != 1 ||
+                                  charts_tof_read_records (tof, tof->num_records, 1, &last) != 1)) return (-1);
+
+
+  charts_io_seek (&tof->stats, tof->fp, 0LL, SEEK_SET);
+  if (charts_io_read (&tof->stats, &head, sizeof (TOF_HEADER_T), 1, tof->fp) != 1) return (-1);
+
+
+  /*  If the ASCII header can't be made to match, don't touch the file at all.  */
+
+  sprintf (value, "%d", tof->num_records);
+  if (charts_header_patch ((char *) &head, TOF_HEAD_TEXT_BLK_SIZE, "NumberShots", value)) return (tof_patch_failed ("NumberShots"));
+
+  sprintf (value, "%"PRId64, first.timestamp);
+  if (charts_header_patch ((char *) &head, TOF_HEAD_TEXT_BLK_SIZE, "StartTimestamp", value)) return (tof_patch_failed ("StartTimestamp"));
+
+  sprintf (value, "%"PRId64, last.timestamp);
+  if (charts_header_patch ((char *) &head, TOF_HEAD_TEXT_BLK_SIZE, "EndTimestamp", value)) return (tof_patch_failed ("EndTimestamp"));
+
+
+  if (tof->swap) charts_swap_tof_header (&head);
+
+  head.info.num_shots = tof->num_records;
+  head.info.start_time = first.timestamp;
+  head.info.stop_time = last.timestamp;
+
+  tof->head.info = head.info;
+  tof->head.text.number_shots = tof->num_records;
+  tof->head.text.start_timestamp = first.timestamp;
+  tof->head.text.end_timestamp = last.timestamp;
+
+  if (tof->swap) charts_swap_tof_header (&head);
+
+
+  charts_io_seek (&tof->stats, tof->fp, 0LL, SEEK_SET);
+  if (charts_io_write (&tof->stats, &head, sizeof (TOF_HEADER_T), 1, tof->fp) != 1) return (-1);
+
+  return (fflush (tof->fp) ? -1 : 0);
+}
+
+
+/*  Flushes the buffer, updates the header to match the records in the file (see tof_patch_header) and frees the
+    appender.  The TOF handle stays open.  Returns 0 on success or -1 if anything failed.  */
+
+int32_t charts_tof_append_close (CHARTS_TOF_APPEND_T *app)
+{
+  int32_t          status;
+
+
+  if (app == NULL) return (-1);
+
+  status = charts_tof_append_flush (app);
+
+  if (!status && tof_patch_header (app->tof))
+    {
+      perror ("Updating TOF header");
+      status = -1;
+    }
+
+  tof_aligned_free (app->buffer);
+  free (app);
+
+  return (status);
+}
+
+
+/*  In place editing of the classification_status field of a TOF file (see charts_edit.c).  Only the pages holding
+    changed records are written back.  */
+
+CHARTS_TOF_EDIT_T *charts_tof_edit_open (char *path)
+{
+  return (charts_edit_open (path, (int64_t) TOF_HEAD_SIZE, sizeof (TOPO_OUTPUT_T)));
+}
+
+
+int32_t charts_tof_edit_num_records (CHARTS_TOF_EDIT_T *edit)
+{
+  return (charts_edit_num_records (edit));
+}
+
+
+/*  Gets the classification_status of record "num" (counting from 1).  Returns 0 on success or -1 if "num" is out
+    of range.  */
+
+int32_t charts_tof_edit_get (CHARTS_TOF_EDIT_T *edit, int32_t num, uint8_t *classification_status)
+{
+  return (charts_edit_get (edit, num, offsetof (TOPO_OUTPUT_T, classification_status), classification_status));
+}
+
+
+/*  Sets the classification_status of record "num".  Nothing is written to the file until charts_tof_edit_flush or
+    charts_tof_edit_close.  Returns 0 on success or -1 if "num" is out of range.  */
+
+int32_t charts_tof_edit_set (CHARTS_TOF_EDIT_T *edit, int32_t num, uint8_t classification_status)
+{
+  return (charts_edit_put (edit, num, offsetof (TOPO_OUTPUT_T, classification_status), classification_status));
+}
+
+
+int32_t charts_tof_edit_flush (CHARTS_TOF_EDIT_T *edit)
+{
+  return (charts_edit_flush (edit));
+}
+
+
+int32_t charts_tof_edit_close (CHARTS_TOF_EDIT_T *edit)
+{
+  return (charts_edit_close (edit));
+}
+
+
+int32_t tof_read_header (FILE *fp, TOF_HEADER_T *head)
+{
+  int32_t         ret;
+  double          start;
+
+
+  l_tof.fp = fp;
+  memset (&l_tof.stats, 0, sizeof (CHARTS_IO_STATS_T));
+
+  start = charts_io_stats_clock ();
+  ret = tof_parse_header (fp, head, &l_tof.swap);
+  CHARTS_IO_COUNT (&l_tof.stats, header_seconds, charts_io_stats_clock () - start);
 
   return (ret);
 }
 
 
+int32_t tof_read_record (FILE *fp, int32_t num, TOPO_OUTPUT_T *record)
+{
+  l_tof.fp = fp;
+
+  return (charts_tof_read_record (&l_tof, num, record));
+}
+
+
+int32_t tof_read_records (FILE *fp, int32_t first, int32_t count, TOPO_OUTPUT_T *buffer)
+{
+  l_tof.fp = fp;
+
+  return (charts_tof_read_records (&l_tof, first, count, buffer));
+}
+
+
+int32_t tof_write_header (FILE *fp, TOF_HEADER_T head)
+{
+  l_tof.fp = fp;
+
+  return (charts_tof_write_header (&l_tof, &head));
+}
+
+
+int32_t tof_write_record (FILE *fp, int32_t num, TOPO_OUTPUT_T *record)
+{
+  l_tof.fp = fp;
+
+  return (charts_tof_write_record (&l_tof, num, record));
+}
+
+
 void tof_dump_record (TOPO_OUTPUT_T *record)
 {
   int32_t         year, day, hour, minute, month, mday;
@@ -28,8 +28,27 @@
 
 #include "FileWave.h"
 
-static uint8_t             swap, first = 1;
-static WAVE_HEADER_T       l_head;
+/*  Per file state for the handle based calls (charts_wave_*).  The FILE based calls are thin wrappers around
+    these that use "l_wave" so they behave the way they always have, one INH file at a time.  The "data" buffers
+    belong to the handle and are only used by charts_wave_read_record.  "block" holds "block_count" raw records
+    starting at record "block_first" for charts_wave_view and charts_wave_read_block.  */
+
+struct CHARTS_WAVE
+{
+  FILE             *fp;
+  uint8_t          swap;
+  uint8_t          first;
+  WAVE_HEADER_T    head;
+  WAVE_DATA_T      data;
+  uint8_t          *block;
+  int32_t          block_size;
+  int32_t          block_first;
+  int32_t          block_count;
+  int32_t          next_view;
+  CHARTS_IO_STATS_T stats;
+};
+
+static CHARTS_WAVE_T l_wave = {.fp = NULL, .swap = 0, .first = 1};
 
 /***************************************************************************\
 *                                                                           *
@@ -88,20 +107,57 @@ void lidar_get_string (char *in, char *out)
         }
     }
 
-  strncpy (out, &out[start], length);
+  memmove (out, &out[start], length);
   out[length] = 0;
 }
 
 
 
-int32_t wave_read_header (FILE *fp, WAVE_HEADER_T *head)
+/*  Keys of the ASCII header, in the order they're written.  */
+
+static const CHARTS_HEADER_FIELD_T wave_header_fields[] =
 {
-  int64_t     long_pos;
-  char        varin[1024], info[1024];
-  int16_t     tmpi16;
+  CHARTS_HEADER_FIELD ("FileType",               CHARTS_HEADER_STRING, WAVE_HEADER_T, file_type),
+  CHARTS_HEADER_FIELD ("EndianType",             CHARTS_HEADER_ENDIAN, WAVE_HEADER_T, endian),
+  CHARTS_HEADER_FIELD ("SoftwareVersionNumber",  CHARTS_HEADER_FLOAT,  WAVE_HEADER_T, software_version),
+  CHARTS_HEADER_FIELD ("FileVersionNumber",      CHARTS_HEADER_FLOAT,  WAVE_HEADER_T, file_version),
+  CHARTS_HEADER_FIELD ("HeaderSize",             CHARTS_HEADER_INT32,  WAVE_HEADER_T, header_size),
+  CHARTS_HEADER_FIELD ("TextBlockSize",          CHARTS_HEADER_INT32,  WAVE_HEADER_T, text_block_size),
+  CHARTS_HEADER_FIELD ("BinaryBlockSize",        CHARTS_HEADER_INT32,  WAVE_HEADER_T, bin_block_size),
+  CHARTS_HEADER_FIELD ("HardwareBlockSize",      CHARTS_HEADER_INT32,  WAVE_HEADER_T, hardware_block_size),
+  CHARTS_HEADER_FIELD ("HapsBlockSize",          CHARTS_HEADER_INT32,  WAVE_HEADER_T, haps_block_size),
+  CHARTS_HEADER_FIELD ("OtherBlockSize",         CHARTS_HEADER_INT32,  WAVE_HEADER_T, other_block_size),
+  CHARTS_HEADER_FIELD ("RecordSize",             CHARTS_HEADER_INT16,  WAVE_HEADER_T, record_size),
+  CHARTS_HEADER_FIELD ("ShotDataSize",           CHARTS_HEADER_INT16,  WAVE_HEADER_T, shot_data_size),
+  CHARTS_HEADER_FIELD ("WaveformSize",           CHARTS_HEADER_INT16,  WAVE_HEADER_T, wave_form_size),
+  CHARTS_HEADER_FIELD ("DeepWaveSize",           CHARTS_HEADER_INT16,  WAVE_HEADER_T, pmt_size),
+  CHARTS_HEADER_FIELD ("ShallowWaveSize",        CHARTS_HEADER_INT16,  WAVE_HEADER_T, apd_size),
+  CHARTS_HEADER_FIELD ("IRWaveSize",             CHARTS_HEADER_INT16,  WAVE_HEADER_T, ir_size),
+  CHARTS_HEADER_FIELD ("RamanWaveSize",          CHARTS_HEADER_INT16,  WAVE_HEADER_T, raman_size),
+  CHARTS_HEADER_FIELD ("ABSystemType",           CHARTS_HEADER_INT8,   WAVE_HEADER_T, ab_system_type),
+  CHARTS_HEADER_FIELD ("ABSystemNumber",         CHARTS_HEADER_INT8,   WAVE_HEADER_T, ab_system_number),
+  CHARTS_HEADER_FIELD ("SystemRepRate",          CHARTS_HEADER_INT16,  WAVE_HEADER_T, system_rep_rate),
+  CHARTS_HEADER_FIELD ("Project",                CHARTS_HEADER_STRING, WAVE_HEADER_T, project),
+  CHARTS_HEADER_FIELD ("Mission",                CHARTS_HEADER_STRING, WAVE_HEADER_T, mission),
+  CHARTS_HEADER_FIELD ("Dataset",                CHARTS_HEADER_STRING, WAVE_HEADER_T, dataset),
+  CHARTS_HEADER_FIELD ("FlightlineNumber",       CHARTS_HEADER_STRING, WAVE_HEADER_T, flightline_number),
+  CHARTS_HEADER_FIELD ("CodedFLNumber",          CHARTS_HEADER_INT16,  WAVE_HEADER_T, coded_fl_number),
+  CHARTS_HEADER_FIELD ("FlightDate",             CHARTS_HEADER_STRING, WAVE_HEADER_T, flight_date),
+  CHARTS_HEADER_FIELD ("StartTime",              CHARTS_HEADER_STRING, WAVE_HEADER_T, start_time),
+  CHARTS_HEADER_FIELD ("EndTime",                CHARTS_HEADER_STRING, WAVE_HEADER_T, end_time),
+  CHARTS_HEADER_FIELD ("StartTimestamp",         CHARTS_HEADER_INT64,  WAVE_HEADER_T, start_timestamp),
+  CHARTS_HEADER_FIELD ("EndTimestamp",           CHARTS_HEADER_INT64,  WAVE_HEADER_T, end_timestamp),
+  CHARTS_HEADER_FIELD ("NumberShots",            CHARTS_HEADER_INT32,  WAVE_HEADER_T, number_shots),
+  CHARTS_HEADER_FIELD ("DatasetCreateDate",      CHARTS_HEADER_STRING, WAVE_HEADER_T, dataset_create_date),
+  CHARTS_HEADER_FIELD ("DatasetCreateTime",      CHARTS_HEADER_STRING, WAVE_HEADER_T, dataset_create_time)
+};
+
+CHARTS_HEADER_TABLE_T charts_wave_header_table = CHARTS_HEADER_TABLE (wave_header_fields);
 
 
-  char *ngets (char *s, int32_t size, FILE *stream);
+int32_t wave_read_header (FILE *fp, WAVE_HEADER_T *head)
+{
+  int64_t     long_pos;
 
 
   fseeko64 (fp, 0LL, SEEK_SET);
@@ -110,110 +166,131 @@ int32_t wave_read_header (FILE *fp, WAVE_HEADER_T *head)
   /*  Read each entry.    */
 
   head->header_size = 0;
-  while (ngets (varin, sizeof (varin), fp) != NULL)
-    {
-      if (!strcmp (varin, "EOF")) break;
 
+  charts_header_read (fp, &charts_wave_header_table, head, &head->header_size);
 
-      /*  Put everything to the right of the colon into 'info'.   */
-            
-      if (strchr (varin, ':') != NULL) strcpy (info, (char *) (strchr (varin, ':') + 1));
 
+  /*  Get the ac_zero_offset data.  */
 
-      /*  Check input for matching strings and load values if found.  */
-            
-      if (strstr (varin, "FileType:") != NULL) lidar_get_string (varin, head->file_type);
+  long_pos = head->text_block_size + head->bin_block_size + 572;
+  fseeko64 (fp, long_pos, SEEK_SET);
 
-      if (strstr (varin, "EndianType:") != NULL) if (strstr (info, "Little")) head->endian = 1;
+  fread (&head->ac_zero_offset, sizeof (uint16_t), 4, fp);
 
-      if (strstr (varin, "SoftwareVersionNumber:") != NULL) sscanf (info, "%f", &head->software_version);
 
-      if (strstr (varin, "FileVersionNumber:") != NULL) sscanf (info, "%f", &head->file_version);
+  /*  Move past the entire header block.  */
 
+  fseeko64 (fp, head->header_size, SEEK_SET);
 
-      if (strstr (varin, "HeaderSize:") != NULL) sscanf (info, "%d", &head->header_size);
+  return (0);
+}
 
-      if (strstr (varin, "TextBlockSize:") != NULL) sscanf (info, "%d", &head->text_block_size);
 
-      if (strstr (varin, "BinaryBlockSize:") != NULL) sscanf (info, "%d", &head->bin_block_size);
+/*  Opens the file and reads the header into "wave".  Returns the FILE pointer or NULL on failure.  */
 
-      if (strstr (varin, "HardwareBlockSize:") != NULL) sscanf (info, "%d", &head->hardware_block_size);
+static FILE *wave_load (CHARTS_WAVE_T *wave, char *path)
+{
+  FILE *fp;
+  double start;
 
-      if (strstr (varin, "HapsBlockSize:") != NULL) sscanf (info, "%d", &head->haps_block_size);
+  int32_t big_endian ();
 
-      if (strstr (varin, "OtherBlockSize:") != NULL) sscanf (info, "%d", &head->other_block_size);
 
-      if (strstr (varin, "RecordSize:") != NULL) sscanf (info, "%hd", &head->record_size);
+  memset (&wave->stats, 0, sizeof (CHARTS_IO_STATS_T));
+  start = charts_io_stats_clock ();
 
-      if (strstr (varin, "ShotDataSize:") != NULL) sscanf (info, "%hd", &head->shot_data_size);
+  wave->swap = (uint8_t) big_endian ();
+  wave->first = 1;
 
-      if (strstr (varin, "WaveformSize:") != NULL) sscanf (info, "%hd", &head->wave_form_size);
+  if ((fp = fopen64 (path, "rb")) == NULL)
+    {
+      perror (path);
+    }
+  else
+    {
+      wave_read_header (fp, &wave->head);
 
-      if (strstr (varin, "DeepWaveSize:") != NULL) sscanf (info, "%hd", &head->pmt_size);
 
-      if (strstr (varin, "ShallowWaveSize:") != NULL) sscanf (info, "%hd", &head->apd_size);
+      /*  Subtract the timestamp size from the shot data size since we're actually going to read the timestamp.  */
 
-      if (strstr (varin, "IRWaveSize:") != NULL) sscanf (info, "%hd", &head->ir_size);
+      wave->head.shot_data_size -= sizeof (int64_t);
 
-      if (strstr (varin, "RamanWaveSize:") != NULL) sscanf (info, "%hd", &head->raman_size);
 
-      if (strstr (varin, "ABSystemType:") != NULL)
-        {
-          sscanf (info, "%hd", &tmpi16);
-          head->ab_system_type = (int8_t) tmpi16;
-        }
+      /*  As of GCS file FileVersion 1.5 the shot data size is misreported in the ASCII header.  It may be right in the 
+          binary portion of the header but I don't have that format info.  The record size is correct but there are 8 
+          empty bytes on the end of the record NOT in the shot data.  DOH!  */
 
-      if (strstr (varin, "ABSystemNumber:") != NULL)
-        {
-          sscanf (info, "%hd", &tmpi16);
-          head->ab_system_number = (int8_t) tmpi16;
-        }
+      if (wave->head.file_version > 1.4) wave->head.shot_data_size -= 8;
+    }
 
-      if (strstr (varin, "SystemRepRate:") != NULL) sscanf (info, "%hd", &head->system_rep_rate);
+  wave->fp = fp;
 
+  CHARTS_IO_COUNT (&wave->stats, header_seconds, charts_io_stats_clock () - start);
 
-      if (strstr (varin, "Project:") != NULL) lidar_get_string (varin, head->project);
+  return (fp);
+}
 
-      if (strstr (varin, "Mission:") != NULL) lidar_get_string (varin, head->mission);
 
-      if (strstr (varin, "Dataset:") != NULL) lidar_get_string (varin, head->dataset);
+/*  Reads one record into "record" whose waveform buffers must already be allocated.  */
 
-      if (strstr (varin, "FlightlineNumber:") != NULL) lidar_get_string (varin, head->flightline_number);
+static int32_t wave_read (CHARTS_WAVE_T *wave, int32_t num, WAVE_DATA_T *record)
+{
+  int32_t ret;
+  int64_t long_pos;
 
-      if (strstr (varin, "CodedFLNumber:") != NULL) sscanf (info, "%hd", &head->coded_fl_number);
 
-      if (strstr (varin, "FlightDate:") != NULL) lidar_get_string (varin, head->flight_date);
+  if (num != WAVE_NEXT_RECORD)
+    {
+      charts_io_seek (&wave->stats, wave->fp, (int64_t) wave->head.header_size + (int64_t) (num - 1) * (int64_t) wave->head.record_size, SEEK_SET);
+    }
+  else
+    {
+      long_pos = ftello64 (wave->fp);
+      if (long_pos < wave->head.header_size) charts_io_seek (&wave->stats, wave->fp, (int64_t) wave->head.header_size, SEEK_SET);
+    }
 
-      if (strstr (varin, "StartTime:") != NULL) lidar_get_string (varin, head->start_time);
 
-      if (strstr (varin, "EndTime:") != NULL) lidar_get_string (varin, head->end_time);
+  /*  Read the timestamp.  */
 
-      if (strstr (varin, "StartTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->start_timestamp);
+  charts_io_read (&wave->stats, &record->timestamp, sizeof (int64_t), 1, wave->fp);
 
-      if (strstr (varin, "EndTimestamp:") != NULL) sscanf (info, "%"PRIu64, &head->end_timestamp);
+  if (wave->swap)
+    {
+      charts_swap_int64_t (&record->timestamp);
+      CHARTS_IO_COUNT (&wave->stats, swaps, 1);
+    }
 
-      if (strstr (varin, "NumberShots:") != NULL) sscanf (info, "%d", &head->number_shots);
 
-      if (strstr (varin, "DatasetCreateDate:") != NULL) lidar_get_string (varin, head->dataset_create_date);
+  /*  Read the shot data (Optech proprietary info that we don't care about).  */
 
-      if (strstr (varin, "DatasetCreateTime:") != NULL) lidar_get_string (varin, head->dataset_create_time);
+  ret = charts_io_read (&wave->stats, record->shot_data, wave->head.shot_data_size, 1, wave->fp);
 
-      long_pos = ftello64 (fp);
-      if (head->header_size && long_pos >= head->header_size) break;
-    }
 
+  /*  Read the waveform data.  */
 
-  /*  Get the ac_zero_offset data.  */
+  ret = charts_io_read (&wave->stats, record->pmt, wave->head.pmt_size, 1, wave->fp);
+  ret = charts_io_read (&wave->stats, record->apd, wave->head.apd_size, 1, wave->fp);
+  ret = charts_io_read (&wave->stats, record->ir, wave->head.ir_size, 1, wave->fp);
+  ret = charts_io_read (&wave->stats, record->raman, wave->head.raman_size, 1, wave->fp);
 
-  long_pos = head->text_block_size + head->bin_block_size + 572;
-  fseeko64 (fp, long_pos, SEEK_SET);
 
-  fread (&head->ac_zero_offset, sizeof (uint16_t), 4, fp);
+  return (ret);
+}
 
 
-  /*  Move past the entire header block.  */
+static int32_t wave_alloc (CHARTS_WAVE_T *wave, WAVE_DATA_T *record)
+{
+  record->shot_data = (uint8_t *) calloc (wave->head.shot_data_size, sizeof (uint8_t));
+  record->pmt = (uint8_t *) calloc (wave->head.pmt_size, sizeof (uint8_t));
+  record->apd = (uint8_t *) calloc (wave->head.apd_size, sizeof (uint8_t));
+  record->ir = (uint8_t *) calloc (wave->head.ir_size, sizeof (uint8_t));
+  record->raman = (uint8_t *) calloc (wave->head.raman_size, sizeof (uint8_t));
 
-  fseeko64 (fp, head->header_size, SEEK_SET);
+  if (record->raman == NULL)
+    {
+      perror ("Allocating wave memory");
+      exit (-1);
+    }
 
   return (0);
 }
@@ -221,49 +298,107 @@ int32_t wave_read_header (FILE *fp, WAVE_HEADER_T *head)
 
 FILE *open_wave_file (char *path)
 {
-  FILE *fp;
+  return (wave_load (&l_wave, path));
+}
 
-  int32_t big_endian ();
 
+/*  Note that we're counting from 1 not 0.  Not my idea!  */
 
-  swap = (uint8_t) big_endian ();
-  first = 1;
+/*  RIDICULOUSLY IMPORTANT NOTE:  Make sure that you static "record" in the calling routine since we are allocating the
+    memory for the waveforms here!  DOH!!!  Use charts_wave_open/charts_wave_read_record if you don't want to deal with
+    this.  */
 
-  if ((fp = fopen64 (path, "rb")) == NULL)
+int32_t wave_read_record (FILE *fp, int32_t num, WAVE_DATA_T *record)
+{
+  if (!num)
     {
-      perror (path);
+      fprintf (stderr, "Zero is not a valid INH record number\n");
+      fflush (stderr);
+      return (0);
     }
-  else
+
+
+  l_wave.fp = fp;
+
+  if (l_wave.first)
     {
-      wave_read_header (fp, &l_head);
+      wave_alloc (&l_wave, record);
+      l_wave.first = 0;
+    }
 
+  return (wave_read (&l_wave, num, record));
+}
 
-      /*  Subtract the timestamp size from the shot data size since we're actually going to read the timestamp.  */
 
-      l_head.shot_data_size -= sizeof (int64_t);
+/*  Opens an INH file and reads the header.  Returns NULL on failure.  */
 
+CHARTS_WAVE_T *charts_wave_open (char *path)
+{
+  CHARTS_WAVE_T    *wave;
 
-      /*  As of GCS file FileVersion 1.5 the shot data size is misreported in the ASCII header.  It may be right in the 
-          binary portion of the header but I don't have that format info.  The record size is correct but there are 8 
-          empty bytes on the end of the record NOT in the shot data.  DOH!  */
 
-      if (l_head.file_version > 1.4) l_head.shot_data_size -= 8;
+  if ((wave = (CHARTS_WAVE_T *) calloc (1, sizeof (CHARTS_WAVE_T))) == NULL)
+    {
+      perror ("Allocating wave handle");
+      return (NULL);
     }
 
+  if (wave_load (wave, path) == NULL)
+    {
+      free (wave);
+      return (NULL);
+    }
 
-  return (fp);
+  wave_alloc (wave, &wave->data);
+
+  return (wave);
 }
 
 
-/*  Note that we're counting from 1 not 0.  Not my idea!  */
+void charts_wave_close (CHARTS_WAVE_T *wave)
+{
+  if (wave == NULL) return;
 
-/*  RIDICULOUSLY IMPORTANT NOTE:  Make sure that you static "record" in the calling routine since we are allocating the
-    memory for the waveforms here!  DOH!!!  */
+  if (wave->fp != NULL) fclose (wave->fp);
 
-int32_t wave_read_record (FILE *fp, int32_t num, WAVE_DATA_T *record)
+  free (wave->data.shot_data);
+  free (wave->data.pmt);
+  free (wave->data.apd);
+  free (wave->data.ir);
+  free (wave->data.raman);
+
+  if (wave->block) free (wave->block);
+
+  free (wave);
+}
+
+
+FILE *charts_wave_fp (CHARTS_WAVE_T *wave)
+{
+  return (wave->fp);
+}
+
+
+WAVE_HEADER_T *charts_wave_header (CHARTS_WAVE_T *wave)
+{
+  return (&wave->head);
+}
+
+
+/*  I/O counters for "wave".  A NULL handle gets the counters for the FILE based calls.  */
+
+CHARTS_IO_STATS_T *charts_wave_stats (CHARTS_WAVE_T *wave)
+{
+  return (wave ? &wave->stats : &l_wave.stats);
+}
+
+
+/*  Reads record "num" (counting from 1) into the handle's buffers and points the members of "record" at them.  The
+    waveforms are overwritten by the next read on the same handle.  */
+
+int32_t charts_wave_read_record (CHARTS_WAVE_T *wave, int32_t num, WAVE_DATA_T *record)
 {
   int32_t ret;
-  int64_t long_pos;
 
 
   if (!num)
@@ -273,60 +408,136 @@ int32_t wave_read_record (FILE *fp, int32_t num, WAVE_DATA_T *record)
       return (0);
     }
 
+  ret = wave_read (wave, num, &wave->data);
 
-  if (num != WAVE_NEXT_RECORD)
+  *record = wave->data;
+
+  return (ret);
+}
+
+
+/*  Reads records "first" through "first" + "count" - 1 (counting from 1) into the handle's block buffer with a single
+    read, growing the buffer if needed.  Returns the number of records read.  */
+
+static int32_t wave_fill_block (CHARTS_WAVE_T *wave, int32_t first, int32_t count)
+{
+  uint8_t          *block;
+
+
+  wave->block_count = 0;
+
+  if (count > wave->block_size)
     {
-      fseeko64 (fp, (int64_t) l_head.header_size + (int64_t) (num - 1) * (int64_t) l_head.record_size, SEEK_SET);
+      if ((block = (uint8_t *) realloc (wave->block, (size_t) count * wave->head.record_size)) == NULL)
+        {
+          perror ("Allocating wave block");
+          return (0);
+        }
+
+      wave->block = block;
+      wave->block_size = count;
     }
-  else
+
+  if (charts_io_seek (&wave->stats, wave->fp, (int64_t) wave->head.header_size + (int64_t) (first - 1) * (int64_t) wave->head.record_size, SEEK_SET))
+    return (0);
+
+  wave->block_first = first;
+  wave->block_count = charts_io_read (&wave->stats, wave->block, wave->head.record_size, count, wave->fp);
+
+  return (wave->block_count);
+}
+
+
+/*  Points "view" at record "num" in the block buffer, which must be there.  Only the timestamp is copied (and
+    swapped), the waveform pointers point straight into the buffer.  */
+
+static void wave_set_view (CHARTS_WAVE_T *wave, int32_t num, WAVE_DATA_T *view)
+{
+  uint8_t          *rec;
+
+
+  rec = wave->block + (size_t) (num - wave->block_first) * wave->head.record_size;
+
+  memcpy (&view->timestamp, rec, sizeof (int64_t));
+  if (wave->swap)
     {
-      long_pos = ftello64 (fp);
-      if (long_pos < l_head.header_size) fseeko64 (fp, (int64_t) l_head.header_size, SEEK_SET);
+      charts_swap_int64_t (&view->timestamp);
+      CHARTS_IO_COUNT (&wave->stats, swaps, 1);
     }
 
+  view->shot_data = rec + sizeof (int64_t);
+  view->pmt = view->shot_data + wave->head.shot_data_size;
+  view->apd = view->pmt + wave->head.pmt_size;
+  view->ir = view->apd + wave->head.apd_size;
+  view->raman = view->ir + wave->head.ir_size;
+}
+
 
-  if (first)
+/*  Zero copy access to record "num" (counting from 1, or WAVE_NEXT_RECORD for the one after the last view).  Records
+    are read CHARTS_WAVE_BLOCK at a time so walking through the file costs one read per block instead of six per
+    record.  The pointers in "view" point into the handle's block buffer and are only good until the next
+    charts_wave_view or charts_wave_read_block call on the handle that has to read more data, so copy anything you
+    want to keep.  Returns 1 on success or 0 if the record isn't there.  */
+
+int32_t charts_wave_view (CHARTS_WAVE_T *wave, int32_t num, WAVE_DATA_T *view)
+{
+  if (num == WAVE_NEXT_RECORD) num = wave->next_view ? wave->next_view : 1;
+
+  if (num < 1)
     {
-      record->shot_data = (uint8_t *) calloc (l_head.shot_data_size, sizeof (uint8_t));
-      record->pmt = (uint8_t *) calloc (l_head.pmt_size, sizeof (uint8_t));
-      record->apd = (uint8_t *) calloc (l_head.apd_size, sizeof (uint8_t));
-      record->ir = (uint8_t *) calloc (l_head.ir_size, sizeof (uint8_t));
-      record->raman = (uint8_t *) calloc (l_head.raman_size, sizeof (uint8_t));
+      fprintf (stderr, "Invalid INH record number %d\n", num);
+      fflush (stderr);
+      return (0);
+    }
 
-      if (record->raman == NULL)
-        {
-          perror ("Allocating wave memory");
-          exit (-1);
-        }
-      first = 1;
+  if (num < wave->block_first || num >= wave->block_first + wave->block_count)
+    {
+      CHARTS_IO_COUNT (&wave->stats, cache_misses, 1);
+
+      if (wave_fill_block (wave, num, CHARTS_WAVE_BLOCK) < 1) return (0);
+    }
+  else
+    {
+      CHARTS_IO_COUNT (&wave->stats, cache_hits, 1);
     }
 
+  wave_set_view (wave, num, view);
 
-  /*  Read the timestamp.  */
+  wave->next_view = num + 1;
 
-  fread (&record->timestamp, sizeof (int64_t), 1, fp);
+  return (1);
+}
 
-  if (swap) charts_swap_int64_t (&record->timestamp);
 
+/*  Reads records "first" through "first" + "count" - 1 (counting from 1) with a single read and fills "views" (which
+    must have room for "count") with zero copy views of them.  The same lifetime rules as charts_wave_view apply.
+    Returns the number of records read, which is less than "count" at the end of the file.  */
 
-  /*  Read the shot data (Optech proprietary info that we don't care about).  */
+int32_t charts_wave_read_block (CHARTS_WAVE_T *wave, int32_t first, int32_t count, WAVE_DATA_T *views)
+{
+  int32_t          i, ret;
 
-  ret = fread (record->shot_data, l_head.shot_data_size, 1, fp);
 
+  if (first < 1 || count < 1)
+    {
+      fprintf (stderr, "Invalid INH record range %d, %d\n", first, count);
+      fflush (stderr);
+      return (0);
+    }
 
-  /*  Read the waveform data.  */
+  ret = wave_fill_block (wave, first, count);
 
-  ret = fread (record->pmt, l_head.pmt_size, 1, fp);
-  ret = fread (record->apd, l_head.apd_size, 1, fp);
-  ret = fread (record->ir, l_head.ir_size, 1, fp);
-  ret = fread (record->raman, l_head.raman_size, 1, fp);
+  for (i = 0 ; i < ret ; i++) wave_set_view (wave, first + i, &views[i]);
 
+  wave->next_view = first + ret;
 
   return (ret);
 }
 
 
-void wave_dump_record (WAVE_DATA_T record)
+/*  Dumps "record" using the waveform sizes in "head".  */
+
+static void wave_dump (WAVE_HEADER_T *head, WAVE_DATA_T record)
 {
   int32_t         i, j, start, end, year, day, hour, minute, month, mday;
   float           second;
@@ -344,12 +555,12 @@ void wave_dump_record (WAVE_DATA_T record)
 
   printf ("\n*****************  PMT waveform values  *****************\n");
 
-  for (i = 0 ; i < l_head.pmt_size ; i += 10)
+  for (i = 0 ; i < head->pmt_size ; i += 10)
     {
-      if (i >= l_head.pmt_size) break;
+      if (i >= head->pmt_size) break;
 
       start = i;
-      end = MIN (i + 10, l_head.pmt_size);
+      end = MIN (i + 10, head->pmt_size);
 
       printf ("%04d-%04d : ", start, end - 1);
 
@@ -362,12 +573,12 @@ void wave_dump_record (WAVE_DATA_T record)
 
   printf ("\n*****************  APD waveform values  *****************\n");
 
-  for (i = 0 ; i < l_head.apd_size ; i += 10)
+  for (i = 0 ; i < head->apd_size ; i += 10)
     {
-      if (i >= l_head.apd_size) break;
+      if (i >= head->apd_size) break;
 
       start = i;
-      end = MIN (i + 10, l_head.apd_size);
+      end = MIN (i + 10, head->apd_size);
 
       printf ("%04d-%04d : ", start, end - 1);
 
@@ -380,12 +591,12 @@ void wave_dump_record (WAVE_DATA_T record)
 
   printf ("\n*****************  IR waveform values  *****************\n");
 
-  for (i = 0 ; i < l_head.ir_size ; i += 10)
+  for (i = 0 ; i < head->ir_size ; i += 10)
     {
-      if (i >= l_head.ir_size) break;
+      if (i >= head->ir_size) break;
 
       start = i;
-      end = MIN (i + 10, l_head.ir_size);
+      end = MIN (i + 10, head->ir_size);
 
       printf ("%04d-%04d : ", start, end - 1);
 
@@ -398,12 +609,12 @@ void wave_dump_record (WAVE_DATA_T record)
 
   printf ("\n*****************  RAMAN waveform values  *****************\n");
 
-  for (i = 0 ; i < l_head.raman_size ; i += 10)
+  for (i = 0 ; i < head->raman_size ; i += 10)
     {
-      if (i >= l_head.raman_size) break;
+      if (i >= head->raman_size) break;
 
       start = i;
-      end = MIN (i + 10, l_head.raman_size);
+      end = MIN (i + 10, head->raman_size);
 
       printf ("%04d-%04d : ", start, end - 1);
 
@@ -416,3 +627,15 @@ void wave_dump_record (WAVE_DATA_T record)
 
   fflush (stdout);
 }
+
+
+void charts_wave_dump_record (CHARTS_WAVE_T *wave, WAVE_DATA_T record)
+{
+  wave_dump (&wave->head, record);
+}
+
+
+void wave_dump_record (WAVE_DATA_T record)
+{
+  wave_dump (&l_wave.head, record);
+}